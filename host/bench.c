@@ -0,0 +1,583 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       BENCH - card accesses of FAT32 operations on card image
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        bench.c
+ * @version     1.0
+ * @test        gcc, Linux
+ *
+ * @depend      sd_image.h, fsck_spill.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   command line: bench test image, image from mkimage
+ * @pins
+ *
+ * @sources
+ */
+
+// INCLUDE libraries
+// ------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "sd_image.h"
+#include "fsck_spill.h"
+
+// Test
+// ------------------------------------------------------------------
+typedef struct BENCH_Test_t {
+  const char * name;
+  const char * brief;
+  int (* run) (FAT32_t *, const char *);
+} BENCH_Test_t;
+
+// Reads Of Group Of Operations
+// ------------------------------------------------------------------
+typedef struct BENCH_Reads_t {
+  uint32_t count;
+  uint32_t total;
+  uint32_t min;
+  uint32_t max;
+} BENCH_Reads_t;
+
+/**
+ * @brief   Add Card Reads Of One Operation
+ *
+ * @param   BENCH_Reads_t * Reads
+ * @param   uint32_t reads
+ *
+ * @return  void
+ */
+static void BENCH_Reads_Add (BENCH_Reads_t * Reads, uint32_t reads)
+{
+  if ((Reads->count == 0) || (reads < Reads->min)) {
+    Reads->min = reads;
+  }
+  if (reads > Reads->max) {
+    Reads->max = reads;
+  }
+  Reads->total += reads;
+  Reads->count++;
+}
+
+/**
+ * @brief   Print Card Reads Of Group
+ *
+ * @param   const char * label
+ * @param   BENCH_Reads_t * Reads
+ *
+ * @return  void
+ */
+static void BENCH_Reads_Print (const char * label, BENCH_Reads_t * Reads)
+{
+  printf ("%-24s %6lu lookups, reads min %lu avg %.1f max %lu\n", label, (unsigned long) Reads->count,
+          (unsigned long) Reads->min, Reads->count ? (double) Reads->total / Reads->count : 0.0, (unsigned long) Reads->max);
+}
+
+/**
+ * @brief   Lookup Of Every Root Directory Name
+ * @note    FAT32_Find by the name FAT32_Get_Name returns; names cut to
+ *          the index record length are skipped
+ *
+ * @param   FAT32_t * FAT32
+ * @param   const char * image
+ *
+ * @return  int
+ */
+static int BENCH_Lookup (FAT32_t * FAT32, const char * image)
+{
+  uint8_t name[FAT32_SDINDEX_NAME_LENGTH + 1];
+  uint16_t i;
+  uint16_t found;
+  uint32_t missed = 0;
+  FAT32_Index_t Entry;
+  BENCH_Reads_t Short;
+  BENCH_Reads_t Long;
+
+  (void) image;
+  memset (&Short, 0, sizeof (Short));
+  memset (&Long, 0, sizeof (Long));
+  for (i = 1; i <= FAT32->files; i++) {
+    if ((FAT32_ERROR == FAT32_Get_Index (FAT32, i, &Entry)) ||
+        (FAT32_ERROR == FAT32_Get_Name (FAT32, i, name, sizeof (name))) ||
+        (strlen ((char *) name) >= (FAT32_SDINDEX_NAME_LENGTH - 1))) {
+      continue;
+    }
+    SD_Image_Stats.reads = 0;
+    found = FAT32_Find (FAT32, (char *) name);
+    if (found != i) {
+      printf ("not found                %6u %s\n", i, (char *) name);
+      missed++;
+      continue;
+    }
+    BENCH_Reads_Add (Entry.lfn ? &Long : &Short, SD_Image_Stats.reads);
+  }
+  BENCH_Reads_Print ("8.3 names", &Short);
+  BENCH_Reads_Print ("long names", &Long);
+  printf ("not found                %6lu\n", (unsigned long) missed);
+
+  return missed ? 1 : 0;
+}
+
+/**
+ * @brief   Pattern Content At File Offset
+ *
+ * @param   uint8_t * buffer
+ * @param   uint32_t offset
+ * @param   uint16_t bytes
+ *
+ * @return  void
+ */
+static void BENCH_Pattern (uint8_t * buffer, uint32_t offset, uint16_t bytes)
+{
+  while (bytes--) {
+    *buffer++ = (uint8_t) (offset * 13 + offset / 251);
+    offset++;
+  }
+}
+
+/**
+ * @brief   Create File And Append Pattern In Chunks
+ *
+ * @param   FAT32_t * FAT32
+ * @param   char * name
+ * @param   uint32_t bytes
+ * @param   uint16_t chunk (512 at most)
+ *
+ * @return  uint8_t
+ */
+static uint8_t BENCH_Append (FAT32_t * FAT32, char * name, uint32_t bytes, uint16_t chunk)
+{
+  uint8_t buffer[512];
+  uint32_t offset;
+  FAT32_File_t File;
+
+  if (FAT32_ERROR == FAT32_Create (FAT32, &File, name)) {
+    return FAT32_ERROR;
+  }
+  for (offset = 0; offset < bytes; offset += chunk) {
+    if (chunk > (bytes - offset)) {
+      chunk = bytes - offset;
+    }
+    BENCH_Pattern (buffer, offset, chunk);
+    if (chunk != FAT32_Write (FAT32, &File, buffer, chunk)) {
+      FAT32_Close (FAT32, &File);
+      return FAT32_ERROR;
+    }
+  }
+
+  return FAT32_Close (FAT32, &File);
+}
+
+/**
+ * @brief   Read File Back And Compare With Pattern
+ *
+ * @param   FAT32_t * FAT32
+ * @param   char * path
+ * @param   uint32_t bytes
+ *
+ * @return  uint8_t
+ */
+static uint8_t BENCH_Verify (FAT32_t * FAT32, char * path, uint32_t bytes)
+{
+  uint8_t buffer[512];
+  uint8_t expect[512];
+  uint16_t n;
+  uint32_t offset = 0;
+  FAT32_File_t File;
+
+  if ((FAT32_ERROR == FAT32_Open_Path (FAT32, &File, path)) || (File.size != bytes)) {
+    return FAT32_ERROR;
+  }
+  while (0 != (n = FAT32_Read (FAT32, &File, buffer, sizeof (buffer)))) {
+    BENCH_Pattern (expect, offset, n);
+    if (memcmp (buffer, expect, n) != 0) {
+      return FAT32_ERROR;
+    }
+    offset += n;
+  }
+
+  return (offset == bytes) ? FAT32_SUCCESS : FAT32_ERROR;
+}
+
+/**
+ * @brief   Append 1 MB In Whole Sectors And In 100 Byte Records
+ * @note    run on images with and without journal (mkimage -j)
+ *
+ * @param   FAT32_t * FAT32
+ * @param   const char * image
+ *
+ * @return  int
+ */
+static int BENCH_Write (FAT32_t * FAT32, const char * image)
+{
+  uint8_t i;
+  static const uint16_t chunk[2] = { 512, 100 };
+  static char * name[2] = { "APPEND1.BIN", "APPEND2.BIN" };
+  static char * path[2] = { "/APPEND1.BIN", "/APPEND2.BIN" };
+
+  (void) image;
+  for (i = 0; i < 2; i++) {
+    SD_Image_Stats.reads = 0;
+    SD_Image_Stats.writes = 0;
+    if (FAT32_ERROR == BENCH_Append (FAT32, name[i], 1048576, chunk[i])) {
+      printf ("%s: write failed\n", name[i]);
+      return 1;
+    }
+    printf ("1 MB in %3u byte writes  reads %lu writes %lu\n", chunk[i],
+            (unsigned long) SD_Image_Stats.reads, (unsigned long) SD_Image_Stats.writes);
+    if (FAT32_ERROR == BENCH_Verify (FAT32, path[i], 1048576)) {
+      printf ("%s: content differs\n", name[i]);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief   Copy Image, Holes Kept
+ *
+ * @param   const char * from
+ * @param   const char * to
+ *
+ * @return  uint8_t
+ */
+static uint8_t BENCH_Copy (const char * from, const char * to)
+{
+  static uint8_t block[65536];
+  static const uint8_t zero[sizeof (block)];
+  size_t n;
+  long size = 0;
+  FILE * in = fopen (from, "rb");
+  FILE * out = fopen (to, "wb");
+
+  while ((in != NULL) && (out != NULL) && (0 != (n = fread (block, 1, sizeof (block), in)))) {
+    if ((n == sizeof (block)) && (memcmp (block, zero, n) == 0)) {
+      fseek (out, n, SEEK_CUR);
+    } else {
+      fwrite (block, 1, n, out);
+    }
+    size += n;
+  }
+  if (out != NULL) {
+    fflush (out);
+    n = ftruncate (fileno (out), size);
+    fclose (out);
+  }
+  if (in == NULL) {
+    return FAT32_ERROR;
+  }
+  fclose (in);
+
+  return (out == NULL) ? FAT32_ERROR : FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Compare Both FAT Copies
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint32_t sectors that differ
+ */
+static uint32_t BENCH_Fat_Differ (FAT32_t * FAT32)
+{
+  uint8_t first[512];
+  uint8_t second[512];
+  uint32_t i;
+  uint32_t differ = 0;
+
+  for (i = 0; i < FAT32->sectors_per_fat; i++) {
+    if ((SD_START_TOKEN != SD_Read_Block (FAT32->fat_area_begin + i, first)) ||
+        (SD_START_TOKEN != SD_Read_Block (FAT32->fat_area_begin + FAT32->sectors_per_fat + i, second)) ||
+        (memcmp (first, second, sizeof (first)) != 0)) {
+      differ++;
+    }
+  }
+
+  return differ;
+}
+
+/**
+ * @brief   Power Cut At Evenly Spaced Writes Of Append, Volume Checked After Remount
+ * @note    each cut runs on fresh copy (image.cut) of image with spill file
+ *          of FSCK_Check (image.base); at most 400 cut points; clusters of
+ *          append not flushed before cut are left as lost chains
+ *
+ * @param   FAT32_t * FAT32
+ * @param   const char * image
+ *
+ * @return  int
+ */
+static int BENCH_Cut (FAT32_t * FAT32, const char * image)
+{
+  char base[256];
+  char copy[256];
+  uint32_t writes;
+  uint32_t points;
+  uint32_t k;
+  uint32_t cut;
+  uint32_t differ = 0;
+  uint32_t failed = 0;
+  uint32_t size = 0;
+  uint32_t lost = 0;
+  uint32_t clusters = 0;
+  uint32_t cross = 0;
+  FSCK_t Result;
+
+  snprintf (base, sizeof (base), "%s.base", image);
+  snprintf (copy, sizeof (copy), "%s.cut", image);
+  SD_Image_Close ();
+
+  // Spill File Of Check - created once, before any cut
+  // ----------------------------------------------------------------
+  if ((FAT32_ERROR == BENCH_Copy (image, base)) || (SD_ERROR == SD_Image_Open (base)) ||
+      (FAT32_ERROR == FAT32_Init (FAT32)) || (FAT32_ERROR == FSCK_Image_Spill (FAT32))) {
+    perror (base);
+    return 2;
+  }
+  SD_Image_Close ();
+
+  // Writes Of Append Without Power Cut
+  // ----------------------------------------------------------------
+  if ((FAT32_ERROR == BENCH_Copy (base, copy)) || (SD_ERROR == SD_Image_Open (copy)) ||
+      (FAT32_ERROR == FAT32_Init (FAT32))) {
+    perror (copy);
+    return 2;
+  }
+  SD_Image_Stats.writes = 0;
+  if (FAT32_ERROR == BENCH_Append (FAT32, "CUT.BIN", 32768, 100)) {
+    printf ("CUT.BIN: write failed\n");
+    return 1;
+  }
+  writes = SD_Image_Stats.writes;
+  points = (writes < 400) ? writes : 400;
+  printf ("32 kB in 100 byte writes  writes %lu, power cut at %lu points\n", (unsigned long) writes, (unsigned long) points);
+
+  // Cut, Remount, Compare FAT Copies, Check Volume
+  // ----------------------------------------------------------------
+  for (k = 1; k <= points; k++) {
+    cut = (k * writes) / points;
+    SD_Image_Close ();
+    if ((FAT32_ERROR == BENCH_Copy (base, copy)) || (SD_ERROR == SD_Image_Open (copy)) ||
+        (FAT32_ERROR == FAT32_Init (FAT32))) {
+      perror (copy);
+      return 2;
+    }
+    SD_Image_Power (cut);
+    BENCH_Append (FAT32, "CUT.BIN", 32768, 100);
+    SD_Image_Close ();
+    if ((SD_ERROR == SD_Image_Open (copy)) || (FAT32_ERROR == FAT32_Init (FAT32))) {
+      failed++;                                                               // volume not mountable
+      continue;
+    }
+    if (BENCH_Fat_Differ (FAT32)) {
+      differ++;
+    }
+    if (FSCK_ERROR == FSCK_Check (FAT32, &Result)) {
+      failed++;                                                               // check not finished
+      continue;
+    }
+    size += (Result.size_mismatch != 0);
+    lost += (Result.lost_chains != 0);
+    clusters += Result.lost_clusters;
+    cross += (Result.cross_linked != 0);
+  }
+  printf ("FAT copies differ        %lu of %lu\n", (unsigned long) differ, (unsigned long) points);
+  printf ("size mismatch            %lu of %lu\n", (unsigned long) size, (unsigned long) points);
+  printf ("lost chains              %lu of %lu (%lu clusters)\n", (unsigned long) lost, (unsigned long) points, (unsigned long) clusters);
+  printf ("cross linked             %lu of %lu\n", (unsigned long) cross, (unsigned long) points);
+  printf ("mount or check failed    %lu of %lu\n", (unsigned long) failed, (unsigned long) points);
+  unlink (copy);
+  unlink (base);
+
+  return (differ || size || cross || failed) ? 1 : 0;                        // lost chains of unflushed append expected
+}
+
+/**
+ * @brief   Mount Again With Volume Of Last Mount Known
+ * @note    first mount of process (printed by main) is cold, host EEPROM
+ *          is not kept; index rebuilt by it makes a second run fair
+ *
+ * @param   FAT32_t * FAT32
+ * @param   const char * image
+ *
+ * @return  int
+ */
+static int BENCH_Mount (FAT32_t * FAT32, const char * image)
+{
+  (void) image;
+  SD_Image_Stats.reads = 0;
+  SD_Image_Stats.writes = 0;
+  if (FAT32_ERROR == FAT32_Init (FAT32)) {
+    printf ("remount failed\n");
+    return 1;
+  }
+  printf ("remount                  %6u files, reads %lu writes %lu\n", FAT32->files,
+          (unsigned long) SD_Image_Stats.reads, (unsigned long) SD_Image_Stats.writes);
+
+  return 0;
+}
+
+/**
+ * @brief   Read Sector Of File At Offset
+ * @note    restart - backward seek begins at first cluster, as handle
+ *          without checkpoints
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * File
+ * @param   FAT32_File_t * Fresh handle just opened
+ * @param   uint32_t sector of file
+ * @param   uint8_t restart
+ *
+ * @return  uint8_t
+ */
+static uint8_t BENCH_Seek_Read (FAT32_t * FAT32, FAT32_File_t * File, FAT32_File_t * Fresh, uint32_t sector, uint8_t restart)
+{
+  uint8_t buffer[512];
+  uint8_t expect[512];
+
+  if (restart && ((sector >> FAT32->cluster_shift) < File->cluster_index)) {
+    *File = *Fresh;
+  }
+  if ((FAT32_ERROR == FAT32_Seek (FAT32, File, sector << 9)) ||
+      (sizeof (buffer) != FAT32_Read (FAT32, File, buffer, sizeof (buffer)))) {
+    return FAT32_ERROR;
+  }
+  BENCH_Pattern (expect, sector << 9, sizeof (expect));
+
+  return (memcmp (buffer, expect, sizeof (buffer)) == 0) ? FAT32_SUCCESS : FAT32_ERROR;
+}
+
+/**
+ * @brief   Seeks In Fragmented File, With Checkpoints And Restarting From First Cluster
+ * @note    A.BIN and B.BIN of 400 clusters written interleaved when missing
+ *
+ * @param   FAT32_t * FAT32
+ * @param   const char * image
+ *
+ * @return  int
+ */
+static int BENCH_Seek (FAT32_t * FAT32, const char * image)
+{
+  uint8_t buffer[512];
+  uint8_t restart;
+  uint8_t test;
+  uint8_t bad = 0;
+  uint32_t i;
+  uint32_t sectors;
+  uint32_t seed;
+  uint32_t reads[4][2];
+  FAT32_File_t A;
+  FAT32_File_t B;
+  FAT32_File_t Fresh;
+  static const char * label[4] = { "forward", "backward", "1000 random", "200 short back near end" };
+
+  (void) image;
+  if (FAT32_ERROR == FAT32_Open_Path (FAT32, &A, "/A.BIN")) {
+    if ((FAT32_ERROR == FAT32_Create (FAT32, &A, "A.BIN")) || (FAT32_ERROR == FAT32_Create (FAT32, &B, "B.BIN"))) {
+      printf ("A.BIN: create failed\n");
+      return 1;
+    }
+    for (i = 0; i < (400UL << FAT32->cluster_shift); i++) {
+      BENCH_Pattern (buffer, i << 9, sizeof (buffer));
+      if ((sizeof (buffer) != FAT32_Write (FAT32, &A, buffer, sizeof (buffer))) ||
+          (sizeof (buffer) != FAT32_Write (FAT32, &B, buffer, sizeof (buffer)))) {
+        printf ("A.BIN: write failed\n");
+        return 1;
+      }
+    }
+    if ((FAT32_ERROR == FAT32_Close (FAT32, &A)) || (FAT32_ERROR == FAT32_Close (FAT32, &B)) ||
+        (FAT32_ERROR == FAT32_Open_Path (FAT32, &A, "/A.BIN"))) {
+      printf ("A.BIN: close failed\n");
+      return 1;
+    }
+  }
+  Fresh = A;
+  sectors = A.size >> 9;
+
+  for (restart = 0; restart < 2; restart++) {
+    for (test = 0; test < 4; test++) {
+      A = Fresh;
+      SD_Image_Stats.reads = 0;
+      seed = 1;
+      for (i = 0; i < ((test < 2) ? sectors : ((test == 2) ? 1000 : 200)); i++) {
+        switch (test) {
+          case 0: bad |= BENCH_Seek_Read (FAT32, &A, &Fresh, i, restart); break;
+          case 1: bad |= BENCH_Seek_Read (FAT32, &A, &Fresh, sectors - 1 - i, restart); break;
+          case 2: seed = seed * 1103515245 + 12345;
+                  bad |= BENCH_Seek_Read (FAT32, &A, &Fresh, (seed >> 8) % sectors, restart); break;
+          default: bad |= BENCH_Seek_Read (FAT32, &A, &Fresh, sectors - 5 - (i % 7) * 3, restart);
+                   bad |= BENCH_Seek_Read (FAT32, &A, &Fresh, sectors - 1 - (i % 7) * 3, restart); break;
+        }
+      }
+      reads[test][restart] = SD_Image_Stats.reads;
+    }
+  }
+  for (test = 0; test < 4; test++) {
+    printf ("%-24s reads %6lu, restarting from first cluster %6lu\n", label[test],
+            (unsigned long) reads[test][0], (unsigned long) reads[test][1]);
+  }
+  if (bad) {
+    printf ("content differs\n");
+  }
+
+  return bad ? 1 : 0;
+}
+
+// Tests
+// ------------------------------------------------------------------
+static const BENCH_Test_t BENCH_Tests[] = {
+  { "lookup", "FAT32_Find of every root directory name", BENCH_Lookup },
+  { "write", "append 1 MB in sectors and in 100 byte records", BENCH_Write },
+  { "cut", "power cut during append, FAT copies and check after remount", BENCH_Cut },
+  { "mount", "mount again, volume of last mount cached", BENCH_Mount },
+  { "seek", "seeks in fragmented file, checkpoints against restart", BENCH_Seek },
+};
+
+/**
+ * @brief   Main
+ * @note    image is modified by tests that write
+ *
+ * @param   int argc
+ * @param   char * argv[]
+ *
+ * @return  int
+ */
+int main (int argc, char * argv[])
+{
+  uint8_t i;
+  FAT32_t FAT32;
+
+  for (i = 0; (argc == 3) && (i < (sizeof (BENCH_Tests) / sizeof (BENCH_Tests[0]))); i++) {
+    if (strcmp (argv[1], BENCH_Tests[i].name) == 0) {
+      break;
+    }
+  }
+  if ((argc != 3) || (i == (sizeof (BENCH_Tests) / sizeof (BENCH_Tests[0])))) {
+    fprintf (stderr, "usage: %s test image\n", argv[0]);
+    for (i = 0; i < (sizeof (BENCH_Tests) / sizeof (BENCH_Tests[0])); i++) {
+      fprintf (stderr, "  %-8s %s\n", BENCH_Tests[i].name, BENCH_Tests[i].brief);
+    }
+    return 2;
+  }
+  if (SD_ERROR == SD_Image_Open (argv[2])) {
+    perror (argv[2]);
+    return 2;
+  }
+  if (FAT32_ERROR == FAT32_Init (&FAT32)) {
+    fprintf (stderr, "%s: no FAT16 / FAT32 volume\n", argv[2]);
+    SD_Image_Close ();
+    return 2;
+  }
+  printf ("mount                    %6u files, reads %lu writes %lu\n", FAT32.files,
+          (unsigned long) SD_Image_Stats.reads, (unsigned long) SD_Image_Stats.writes);
+  i = BENCH_Tests[i].run (&FAT32, argv[2]);
+  SD_Image_Close ();
+
+  return i;
+}
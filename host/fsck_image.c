@@ -0,0 +1,87 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       FSCK IMAGE - consistency check of card image on host
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        fsck_image.c
+ * @version     1.0
+ * @test        gcc, Linux
+ *
+ * @depend      sd_image.h, fsck_spill.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   command line: fsck image
+ * @pins
+ *
+ * @sources
+ */
+
+// INCLUDE libraries
+// ------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include "sd_image.h"
+#include "fsck_spill.h"
+
+/**
+ * @brief   Main
+ * @note    exit status 0 - consistent, 1 - damaged, 2 - check not finished;
+ *          spill file of large volume created when missing
+ *
+ * @param   int argc
+ * @param   char * argv[]
+ *
+ * @return  int
+ */
+int main (int argc, char * argv[])
+{
+  uint8_t response;
+  FAT32_t FAT32;
+  FSCK_t Result;
+
+  if (argc != 2) {
+    fprintf (stderr, "usage: %s image\n", argv[0]);
+    return 2;
+  }
+  if (SD_ERROR == SD_Image_Open (argv[1])) {
+    perror (argv[1]);
+    return 2;
+  }
+  if (FAT32_ERROR == FAT32_Init (&FAT32)) {
+    fprintf (stderr, "%s: no FAT16 / FAT32 volume\n", argv[1]);
+    SD_Image_Close ();
+    return 2;
+  }
+
+  if (FAT32_ERROR == FSCK_Image_Spill (&FAT32)) {
+    fprintf (stderr, "%s: no room for %s\n", argv[1], FSCK_SPILL_PATH);
+    SD_Image_Close ();
+    return 2;
+  }
+  response = FSCK_Check (&FAT32, &Result);
+
+  printf ("used           %lu\n", (unsigned long) Result.used);
+  printf ("free           %lu\n", (unsigned long) Result.free);
+  printf ("bad            %lu\n", (unsigned long) Result.bad);
+  printf ("fat mismatch   %lu\n", (unsigned long) Result.fat_mismatch);
+  printf ("invalid        %lu\n", (unsigned long) Result.invalid);
+  printf ("cross linked   %lu\n", (unsigned long) Result.cross_linked);
+  printf ("broken         %lu\n", (unsigned long) Result.broken);
+  printf ("lost chains    %lu (%lu clusters)\n", (unsigned long) Result.lost_chains, (unsigned long) Result.lost_clusters);
+  printf ("size mismatch  %u\n", Result.size_mismatch);
+  printf ("files          %u\n", Result.files);
+  printf ("dirs           %u\n", Result.dirs);
+  printf ("too deep       %u\n", Result.too_deep);
+  printf ("card reads     %lu\n", (unsigned long) SD_Image_Stats.reads);
+  SD_Image_Close ();
+
+  if (response == FSCK_ERROR) {
+    fprintf (stderr, "%s: check not finished\n", argv[1]);
+    return 2;
+  }
+
+  return (response == FSCK_DAMAGED) ? 1 : 0;
+}
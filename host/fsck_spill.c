@@ -0,0 +1,69 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       FSCK SPILL - spill file for bitmap of FSCK_Check on card image
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        fsck_spill.c
+ * @version     1.0
+ * @test        gcc, Linux
+ *
+ * @depend      fsck_spill.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   mounted card image
+ * @pins
+ *
+ * @sources
+ */
+
+// INCLUDE libraries
+// ------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include "fsck_spill.h"
+
+/**
+ * @brief   Create Zeroed Spill File For Bitmap Of Large Volume
+ * @note    contiguous run preallocated, as FSCK_Check requires
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint8_t
+ */
+uint8_t FSCK_Image_Spill (FAT32_t * FAT32)
+{
+  uint8_t buffer[BYTES_PER_SECTOR];
+  uint16_t chunk;
+  uint32_t length = (FAT32->clusters + 7) >> 3;
+  FAT32_File_t File;
+  FAT32_Index_t Entry;
+
+  if ((FAT32->clusters <= (FSCK_WINDOW_BYTES << 3)) ||
+      (FAT32_SUCCESS == FAT32_Get_Path (FAT32, FSCK_SPILL_PATH, &Entry))) {
+    return FAT32_SUCCESS;                                                     // bitmap in RAM or file present
+  }
+  if (FAT32_ERROR == FAT32_Create (FAT32, &File, FSCK_SPILL_PATH + 1)) {
+    return FAT32_ERROR;
+  }
+  if (FAT32_ERROR == FAT32_Allocate (FAT32, &File, ((length - 1) >> (BYTES_PER_SECTOR_SHIFT + FAT32->cluster_shift)) + 1, 0)) {
+    FAT32_Close (FAT32, &File);
+    return FAT32_ERROR;
+  }
+  memset (buffer, 0, sizeof (buffer));
+  while (length) {
+    chunk = (length < sizeof (buffer)) ? length : sizeof (buffer);
+    if (chunk != FAT32_Write (FAT32, &File, buffer, chunk)) {
+      break;
+    }
+    length -= chunk;
+  }
+  if ((FAT32_ERROR == FAT32_Close (FAT32, &File)) || length) {
+    return FAT32_ERROR;
+  }
+  printf ("created        %s\n", FSCK_SPILL_PATH);
+
+  return FAT32_SUCCESS;
+}
@@ -0,0 +1,37 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       FSCK SPILL - spill file for bitmap of FSCK_Check on card image
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        fsck_spill.h
+ * @version     1.0
+ * @test        gcc, Linux
+ *
+ * @depend      fsck.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   mounted card image
+ * @pins
+ *
+ * @sources
+ */
+
+#ifndef __FSCK_SPILL_H__
+#define __FSCK_SPILL_H__
+
+  #include "../src/fsck/fsck.h"                         // FSCK_SPILL_PATH, FSCK_WINDOW_BYTES
+
+  /**
+   * @brief   Create Zeroed Spill File For Bitmap Of Large Volume
+   * @note    contiguous run preallocated, as FSCK_Check requires
+   *
+   * @param   FAT32_t * FAT32
+   *
+   * @return  uint8_t
+   */
+  uint8_t FSCK_Image_Spill (FAT32_t *);
+
+#endif
@@ -0,0 +1,22 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       Host stand-in for <avr/eeprom.h>, EEPROM kept in RAM, lost at exit
+ * --------------------------------------------------------------------------------------+
+ */
+
+#ifndef __HOST_AVR_EEPROM_H__
+#define __HOST_AVR_EEPROM_H__
+
+  #include <stdint.h>
+  #include <string.h>
+
+  #define EEMEM
+
+  static inline void eeprom_read_block (void * dst, const void * src, size_t n) { memcpy (dst, src, n); }
+  static inline void eeprom_update_block (const void * src, void * dst, size_t n) { memcpy (dst, src, n); }
+  static inline uint8_t eeprom_read_byte (const uint8_t * address) { return *address; }
+  static inline void eeprom_update_byte (uint8_t * address, uint8_t value) { *address = value; }
+  static inline uint32_t eeprom_read_dword (const uint32_t * address) { return *address; }
+  static inline void eeprom_update_dword (uint32_t * address, uint32_t value) { *address = value; }
+
+#endif
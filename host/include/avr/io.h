@@ -0,0 +1,12 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       Host stand-in for <avr/io.h>, registers not used by host build
+ * --------------------------------------------------------------------------------------+
+ */
+
+#ifndef __HOST_AVR_IO_H__
+#define __HOST_AVR_IO_H__
+
+  #include <stdint.h>
+
+#endif
@@ -0,0 +1,15 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       Host stand-in for <avr/pgmspace.h>, flash data kept in RAM
+ * --------------------------------------------------------------------------------------+
+ */
+
+#ifndef __HOST_AVR_PGMSPACE_H__
+#define __HOST_AVR_PGMSPACE_H__
+
+  #include <stdint.h>
+
+  #define PROGMEM
+  #define pgm_read_byte(address)        (*(const uint8_t *) (address))
+
+#endif
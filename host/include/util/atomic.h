@@ -0,0 +1,16 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       Host stand-in for <util/atomic.h>, no interrupts on host
+ * --------------------------------------------------------------------------------------+
+ */
+
+#ifndef __HOST_UTIL_ATOMIC_H__
+#define __HOST_UTIL_ATOMIC_H__
+
+  #include <stdint.h>
+
+  #define ATOMIC_RESTORESTATE
+  #define ATOMIC_FORCEON
+  #define ATOMIC_BLOCK(type)            for (uint8_t __atomic_once = 1; __atomic_once; __atomic_once = 0)
+
+#endif
@@ -0,0 +1,13 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       Host stand-in for <util/delay.h>, no delays
+ * --------------------------------------------------------------------------------------+
+ */
+
+#ifndef __HOST_UTIL_DELAY_H__
+#define __HOST_UTIL_DELAY_H__
+
+  #define _delay_ms(ms)
+  #define _delay_us(us)
+
+#endif
@@ -0,0 +1,381 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       MKIMAGE - FAT32 test card image for host tools
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        mkimage.c
+ * @version     1.0
+ * @test        gcc, Linux
+ *
+ * @depend      stdio.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   command line: mkimage [-c sectors] [-n files] [-i kB] [-j clusters] [-e] image
+ * @pins
+ *
+ * @sources
+ */
+
+// INCLUDE libraries
+// ------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+// Layout
+// ------------------------------------------------------------------
+#define MKIMAGE_SECTOR          512
+#define MKIMAGE_LBA             2048                                          // first sector of partition / of EBR
+#define MKIMAGE_RESERVED        32                                            // reserved sectors of volume
+#define MKIMAGE_CLUSTERS        70000                                         // above 65524 => FAT32
+#define MKIMAGE_EOC             0x0FFFFFFF
+
+// Image
+// ------------------------------------------------------------------
+typedef struct MKIMAGE_t {
+  FILE * file;
+  uint32_t volume;                                                            // first sector of volume
+  uint32_t data;                                                              // first sector of cluster 2
+  uint32_t fat_sectors;                                                       // sectors of one FAT copy
+  uint32_t next;                                                              // next free cluster
+  uint32_t * fat;
+  uint8_t * dir;                                                              // entries of directory being formed
+  uint32_t entries;
+  uint8_t spc;                                                                // sectors per cluster
+} MKIMAGE_t;
+
+/**
+ * @brief   Put Little Endian Value
+ *
+ * @param   uint8_t * destination
+ * @param   uint32_t value
+ * @param   uint8_t bytes
+ *
+ * @return  void
+ */
+static void MKIMAGE_Put (uint8_t * dst, uint32_t value, uint8_t bytes)
+{
+  while (bytes--) {
+    *dst++ = (uint8_t) value;
+    value >>= 8;
+  }
+}
+
+/**
+ * @brief   Write Bytes At Sector
+ *
+ * @param   MKIMAGE_t * Image
+ * @param   uint32_t sector
+ * @param   const uint8_t * buffer
+ * @param   uint32_t bytes
+ *
+ * @return  void
+ */
+static void MKIMAGE_Write (MKIMAGE_t * Image, uint32_t sector, const uint8_t * buffer, uint32_t bytes)
+{
+  if ((fseek (Image->file, (long) sector * MKIMAGE_SECTOR, SEEK_SET) != 0) ||
+      (fwrite (buffer, 1, bytes, Image->file) != bytes)) {
+    perror ("mkimage");
+    exit (2);
+  }
+}
+
+/**
+ * @brief   Allocate Contiguous Chain
+ *
+ * @param   MKIMAGE_t * Image
+ * @param   uint32_t clusters
+ *
+ * @return  uint32_t first cluster
+ */
+static uint32_t MKIMAGE_Alloc (MKIMAGE_t * Image, uint32_t clusters)
+{
+  uint32_t first = Image->next;
+
+  if ((first + clusters) > (MKIMAGE_CLUSTERS + 2)) {
+    fprintf (stderr, "mkimage: volume full\n");
+    exit (2);
+  }
+  while (--clusters) {
+    Image->fat[Image->next] = Image->next + 1;
+    Image->next++;
+  }
+  Image->fat[Image->next++] = MKIMAGE_EOC;
+
+  return first;
+}
+
+/**
+ * @brief   Append Directory Entry, Long Name Slots In Front
+ *
+ * @param   MKIMAGE_t * Image
+ * @param   const char * 8.3 name, 11 characters
+ * @param   const char * long name or NULL
+ * @param   uint8_t attribute
+ * @param   uint32_t first cluster
+ * @param   uint32_t size
+ *
+ * @return  void
+ */
+static void MKIMAGE_Entry (MKIMAGE_t * Image, const char * name83, const char * name, uint8_t attribute, uint32_t cluster, uint32_t size)
+{
+  uint8_t * DE;
+  uint8_t sum = 0;
+  uint8_t slots = 0;
+  uint8_t i;
+  uint8_t k;
+  uint16_t c;
+  uint32_t length = name ? strlen (name) : 0;
+  static const uint8_t offset[13] = { 1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30 };
+
+  if (name) {
+    slots = (length + 13) / 13;                                               // with terminating zero
+  }
+  Image->dir = realloc (Image->dir, (Image->entries + slots + 1) * 32);
+  for (i = 0; i < 11; i++) {
+    sum = (uint8_t) (((sum & 1) << 7) + (sum >> 1) + (uint8_t) name83[i]);
+  }
+  for (i = slots; i > 0; i--) {
+    DE = &Image->dir[Image->entries++ * 32];
+    memset (DE, 0, 32);
+    DE[0] = (i == slots) ? (0x40 | i) : i;
+    DE[11] = 0x0F;
+    DE[13] = sum;
+    for (k = 0; k < 13; k++) {
+      c = 0xFFFF;
+      if (((i - 1) * 13 + k) < length) {
+        c = (uint8_t) name[(i - 1) * 13 + k];
+      } else if (((i - 1) * 13 + k) == length) {
+        c = 0;
+      }
+      MKIMAGE_Put (&DE[offset[k]], c, 2);
+    }
+  }
+  DE = &Image->dir[Image->entries++ * 32];
+  memset (DE, 0, 32);
+  memcpy (DE, name83, 11);
+  DE[11] = attribute;
+  MKIMAGE_Put (&DE[16], 0x0021, 2);                                           // 1.1.1980
+  MKIMAGE_Put (&DE[24], 0x0021, 2);
+  MKIMAGE_Put (&DE[20], cluster >> 16, 2);
+  MKIMAGE_Put (&DE[26], cluster, 2);
+  MKIMAGE_Put (&DE[28], size, 4);
+}
+
+/**
+ * @brief   Write File With Pattern Content And Append Its Entry
+ *
+ * @param   MKIMAGE_t * Image
+ * @param   const char * 8.3 name, 11 characters
+ * @param   const char * long name or NULL
+ * @param   uint32_t size
+ *
+ * @return  void
+ */
+static void MKIMAGE_File (MKIMAGE_t * Image, const char * name83, const char * name, uint32_t size)
+{
+  uint8_t * data;
+  uint32_t i;
+  uint32_t bytes = Image->spc * MKIMAGE_SECTOR;
+  uint32_t clusters = (size + bytes - 1) / bytes;
+  uint32_t cluster = 0;
+
+  if (clusters) {
+    cluster = MKIMAGE_Alloc (Image, clusters);
+    data = malloc (size);
+    for (i = 0; i < size; i++) {
+      data[i] = (uint8_t) (i * 7 + name83[0] + name83[5] + name83[6] + name83[7]);
+    }
+    MKIMAGE_Write (Image, Image->data + (cluster - 2) * Image->spc, data, size);
+    free (data);
+  }
+  MKIMAGE_Entry (Image, name83, name, 0x20, cluster, size);
+}
+
+/**
+ * @brief   Write Directory Collected In Image->dir As Contiguous Chain
+ *
+ * @param   MKIMAGE_t * Image
+ *
+ * @return  uint32_t first cluster
+ */
+static uint32_t MKIMAGE_Dir (MKIMAGE_t * Image)
+{
+  uint32_t bytes = Image->spc * MKIMAGE_SECTOR;
+  uint32_t clusters = ((Image->entries + 1) * 32 + bytes - 1) / bytes;        // end marker included
+  uint32_t cluster = MKIMAGE_Alloc (Image, clusters);
+  uint8_t * raw = calloc (clusters, bytes);
+
+  memcpy (raw, Image->dir, Image->entries * 32);
+  MKIMAGE_Write (Image, Image->data + (cluster - 2) * Image->spc, raw, clusters * bytes);
+  free (raw);
+  Image->entries = 0;
+
+  return cluster;
+}
+
+/**
+ * @brief   Main
+ * @note    -c sectors per cluster (1), -n filler files (40), -i kB of index file SDINDEX,
+ *          -j clusters of journal SDJOURNL, -e volume in logical partition
+ *
+ * @param   int argc
+ * @param   char * argv[]
+ *
+ * @return  int
+ */
+int main (int argc, char * argv[])
+{
+  int opt;
+  char name83[12];
+  char name[32];
+  uint8_t sector[MKIMAGE_SECTOR];
+  uint8_t logical = 0;
+  uint32_t i;
+  uint32_t files = 40;
+  uint32_t index = 0;
+  uint32_t journal = 0;
+  uint32_t total;
+  uint32_t album;
+  uint32_t root;
+  uint32_t used;
+  MKIMAGE_t Image;
+
+  memset (&Image, 0, sizeof (Image));
+  Image.spc = 1;
+  while ((opt = getopt (argc, argv, "c:n:i:j:e")) != -1) {
+    switch (opt) {
+      case 'c': Image.spc = (uint8_t) atoi (optarg); break;
+      case 'n': files = atoi (optarg); break;
+      case 'i': index = atoi (optarg); break;
+      case 'j': journal = atoi (optarg); break;
+      case 'e': logical = 1; break;
+      default: optind = argc + 1; break;
+    }
+  }
+  if ((optind != (argc - 1)) || (Image.spc == 0) || (Image.spc & (Image.spc - 1)) || (Image.spc > 64)) {
+    fprintf (stderr, "usage: %s [-c sectors] [-n files] [-i kB] [-j clusters] [-e] image\n", argv[0]);
+    return 2;
+  }
+  if (NULL == (Image.file = fopen (argv[optind], "w+b"))) {
+    perror (argv[optind]);
+    return 2;
+  }
+
+  // Geometry
+  // ----------------------------------------------------------------
+  Image.volume = MKIMAGE_LBA << logical;
+  Image.fat_sectors = ((MKIMAGE_CLUSTERS + 2) * 4 + MKIMAGE_SECTOR - 1) / MKIMAGE_SECTOR;
+  Image.data = Image.volume + MKIMAGE_RESERVED + 2 * Image.fat_sectors;
+  total = MKIMAGE_RESERVED + 2 * Image.fat_sectors + MKIMAGE_CLUSTERS * Image.spc;
+  Image.fat = calloc (MKIMAGE_CLUSTERS + 2, sizeof (uint32_t));
+  Image.fat[0] = 0x0FFFFFF8;
+  Image.fat[1] = MKIMAGE_EOC;
+  Image.next = 2;
+  memset (sector, 0, sizeof (sector));
+  MKIMAGE_Write (&Image, Image.volume + total - 1, sector, MKIMAGE_SECTOR);  // image size, sparse
+
+  // Subdirectory ALBUM
+  // ----------------------------------------------------------------
+  MKIMAGE_Entry (&Image, ".          ", NULL, 0x10, 0, 0);
+  MKIMAGE_Entry (&Image, "..         ", NULL, 0x10, 0, 0);                  // parent is root
+  MKIMAGE_File (&Image, "01      MP3", NULL, 3000);
+  MKIMAGE_File (&Image, "02      MP3", "Second Song In Album.mp3", 700);
+  MKIMAGE_Put (&Image.dir[20], Image.next >> 16, 2);                          // "." - cluster taken by MKIMAGE_Dir
+  MKIMAGE_Put (&Image.dir[26], Image.next, 2);
+  album = MKIMAGE_Dir (&Image);
+
+  // Root Directory - index and journal among first entries
+  // ----------------------------------------------------------------
+  MKIMAGE_Entry (&Image, "TESTVOL    ", NULL, 0x08, 0, 0);
+  if (index) {
+    i = (index * 1024 + Image.spc * MKIMAGE_SECTOR - 1) / (Image.spc * MKIMAGE_SECTOR);
+    MKIMAGE_Entry (&Image, "SDINDEX    ", NULL, 0x06, MKIMAGE_Alloc (&Image, i), index * 1024);
+  }
+  if (journal) {
+    MKIMAGE_Entry (&Image, "SDJOURNL   ", NULL, 0x06, MKIMAGE_Alloc (&Image, journal), journal * Image.spc * MKIMAGE_SECTOR);
+  }
+  MKIMAGE_File (&Image, "TRACK1  MP3", NULL, 5000);
+  MKIMAGE_File (&Image, "TRACK2  MP3", "A very long track name number two.mp3", 12345);
+  MKIMAGE_File (&Image, "README  TXT", NULL, 100);
+  MKIMAGE_File (&Image, "EMPTY   TXT", NULL, 0);
+  for (i = 0; i < files; i++) {
+    snprintf (name83, sizeof (name83), "F%05u  MP3", (unsigned) (i % 100000));
+    snprintf (name, sizeof (name), "Filler track %u.mp3", (unsigned) i);
+    MKIMAGE_File (&Image, name83, (i % 3) ? NULL : name, 600 + (i % 1000));
+  }
+  MKIMAGE_Entry (&Image, "ALBUM      ", NULL, 0x10, album, 0);
+  root = MKIMAGE_Dir (&Image);
+
+  // FAT Copies
+  // ----------------------------------------------------------------
+  for (i = 0; i < (MKIMAGE_CLUSTERS + 2); i++) {
+    MKIMAGE_Put ((uint8_t *) &Image.fat[i], Image.fat[i], 4);                 // little endian in place
+  }
+  MKIMAGE_Write (&Image, Image.volume + MKIMAGE_RESERVED, (uint8_t *) Image.fat, (MKIMAGE_CLUSTERS + 2) * 4);
+  MKIMAGE_Write (&Image, Image.volume + MKIMAGE_RESERVED + Image.fat_sectors, (uint8_t *) Image.fat, (MKIMAGE_CLUSTERS + 2) * 4);
+  used = Image.next - 2;
+
+  // Boot Sector, Backup At Sector 6
+  // ----------------------------------------------------------------
+  memset (sector, 0, sizeof (sector));
+  memcpy (sector, "\xEB\x58\x90" "MKIMAGE ", 11);
+  MKIMAGE_Put (&sector[11], MKIMAGE_SECTOR, 2);
+  sector[13] = Image.spc;
+  MKIMAGE_Put (&sector[14], MKIMAGE_RESERVED, 2);
+  sector[16] = 2;                                                             // FAT copies
+  sector[21] = 0xF8;
+  MKIMAGE_Put (&sector[24], 32, 2);
+  MKIMAGE_Put (&sector[26], 64, 2);
+  MKIMAGE_Put (&sector[28], Image.volume, 4);
+  MKIMAGE_Put (&sector[32], total, 4);
+  MKIMAGE_Put (&sector[36], Image.fat_sectors, 4);
+  MKIMAGE_Put (&sector[44], root, 4);
+  MKIMAGE_Put (&sector[48], 1, 2);                                            // FSInfo
+  MKIMAGE_Put (&sector[50], 6, 2);                                            // backup boot sector
+  sector[64] = 0x80;
+  sector[66] = 0x29;
+  MKIMAGE_Put (&sector[67], 0x12345678, 4);                                   // serial number
+  memcpy (&sector[71], "TESTVOL    FAT32   ", 19);
+  MKIMAGE_Put (&sector[510], 0xAA55, 2);
+  MKIMAGE_Write (&Image, Image.volume, sector, MKIMAGE_SECTOR);
+  MKIMAGE_Write (&Image, Image.volume + 6, sector, MKIMAGE_SECTOR);
+
+  // FSInfo
+  // ----------------------------------------------------------------
+  memset (sector, 0, sizeof (sector));
+  MKIMAGE_Put (&sector[0], 0x41615252, 4);
+  MKIMAGE_Put (&sector[484], 0x61417272, 4);
+  MKIMAGE_Put (&sector[488], MKIMAGE_CLUSTERS - used, 4);
+  MKIMAGE_Put (&sector[492], Image.next, 4);
+  MKIMAGE_Put (&sector[508], 0xAA550000, 4);
+  MKIMAGE_Write (&Image, Image.volume + 1, sector, MKIMAGE_SECTOR);
+
+  // MBR, EBR Of Logical Partition
+  // ----------------------------------------------------------------
+  memset (sector, 0, sizeof (sector));
+  sector[446 + 4] = logical ? 0x0F : 0x0C;
+  MKIMAGE_Put (&sector[446 + 8], MKIMAGE_LBA, 4);
+  MKIMAGE_Put (&sector[446 + 12], total + (logical ? MKIMAGE_LBA : 0), 4);
+  MKIMAGE_Put (&sector[510], 0xAA55, 2);
+  MKIMAGE_Write (&Image, 0, sector, MKIMAGE_SECTOR);
+  if (logical) {
+    sector[446 + 4] = 0x0C;
+    MKIMAGE_Put (&sector[446 + 8], MKIMAGE_LBA, 4);                           // relative to EBR
+    MKIMAGE_Put (&sector[446 + 12], total, 4);
+    MKIMAGE_Write (&Image, MKIMAGE_LBA, sector, MKIMAGE_SECTOR);
+  }
+
+  fclose (Image.file);
+  free (Image.fat);
+  free (Image.dir);
+  printf ("%s: %u clusters of %u sectors, %u used, %u files in root\n", argv[optind],
+          MKIMAGE_CLUSTERS, Image.spc, (unsigned) used, (unsigned) (files + 5 + (index != 0) + (journal != 0)));
+
+  return 0;
+}
@@ -0,0 +1,327 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       SD IMAGE - SD block functions served from card image file (host build)
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        sd_image.c
+ * @version     1.0
+ * @test        gcc, Linux
+ *
+ * @depend      sd_image.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   image file (dd of card, 512 bytes per sector)
+ * @pins
+ *
+ * @sources
+ */
+
+// INCLUDE libraries
+// ------------------------------------------------------------------
+#include <string.h>
+#include "sd_image.h"
+
+// Image
+// ------------------------------------------------------------------
+static FILE * SD_Image = NULL;
+static uint32_t SD_Image_Sector;                                              // next sector of multiple block transfer
+static uint8_t SD_Image_Stream = 0;                                           // 1 - read, 2 - write transfer open
+static uint32_t SD_Image_Cut = 0;                                             // writes counter at power cut, 0 - never
+SD_Image_Stats_t SD_Image_Stats;
+
+/**
+ * @brief   Seek To Sector, Outside Of Transfer Only For Single Block Commands
+ *
+ * @param   uint32_t sector
+ *
+ * @return  uint8_t
+ */
+static uint8_t SD_Image_Seek (uint32_t sector)
+{
+  if ((SD_Image == NULL) || (fseek (SD_Image, (long) sector * SD_SDHC_BLOCKLEN, SEEK_SET) != 0)) {
+    return SD_ERROR;
+  }
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   Card Still Powered
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+static uint8_t SD_Image_Powered (void)
+{
+  return (SD_Image_Cut == 0) || (SD_Image_Stats.writes < SD_Image_Cut);
+}
+
+/**
+ * @brief   Open Card Image
+ * @note    image is read and written in place
+ *
+ * @param   const char * path
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Image_Open (const char * path)
+{
+  SD_Image_Close ();
+  if (NULL == (SD_Image = fopen (path, "r+b"))) {
+    return SD_ERROR;
+  }
+  memset (&SD_Image_Stats, 0, sizeof (SD_Image_Stats));
+  SD_Image_Cut = 0;
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   Cut Power After Number Of Sector Writes
+ * @note    later writes and erases fail like on card without power;
+ *          0 - power kept, image reopened to continue
+ *
+ * @param   uint32_t writes
+ *
+ * @return  void
+ */
+void SD_Image_Power (uint32_t writes)
+{
+  SD_Image_Cut = writes ? (SD_Image_Stats.writes + writes) : 0;
+}
+
+/**
+ * @brief   Close Card Image
+ *
+ * @param   void
+ *
+ * @return  void
+ */
+void SD_Image_Close (void)
+{
+  if (SD_Image != NULL) {
+    fclose (SD_Image);
+    SD_Image = NULL;
+  }
+  SD_Image_Stream = 0;
+}
+
+/**
+ * @brief   SD Card Init
+ * @note    image opened before by SD_Image_Open
+ *
+ * @param   SD * sd
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Init (SD * sd)
+{
+  sd->voltage = 1;
+  sd->sdhc = 2;                                                               // block addressed like SDHC
+  sd->version = 1;
+
+  return (SD_Image == NULL) ? SD_ERROR : SD_SUCCESS;
+}
+
+/**
+ * @brief   Read Block
+ * @note    sectors behind end of image read as zeros
+ *
+ * @param   uint32_t sector
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t SD_START_TOKEN / SD_ERROR
+ */
+uint8_t SD_Read_Block (uint32_t sector, uint8_t * buffer)
+{
+  if (SD_Image_Stream || (SD_ERROR == SD_Image_Seek (sector))) {
+    return SD_ERROR;
+  }
+  if (fread (buffer, 1, SD_SDHC_BLOCKLEN, SD_Image) != SD_SDHC_BLOCKLEN) {
+    memset (buffer, 0, SD_SDHC_BLOCKLEN);
+  }
+  SD_Image_Stats.reads++;
+
+  return SD_START_TOKEN;
+}
+
+/**
+ * @brief   Start Multiple Block Read
+ *
+ * @param   uint32_t sector
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Read_Start (uint32_t sector)
+{
+  if (SD_Image_Stream || (SD_ERROR == SD_Image_Seek (sector))) {
+    return SD_ERROR;
+  }
+  SD_Image_Sector = sector;
+  SD_Image_Stream = 1;
+  SD_Image_Stats.streams++;
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   Read Next Block Of Multiple Block Read
+ *
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t SD_START_TOKEN / SD_ERROR
+ */
+uint8_t SD_Read_Next (uint8_t * buffer)
+{
+  if ((SD_Image_Stream != 1) || (SD_ERROR == SD_Image_Seek (SD_Image_Sector))) {
+    return SD_ERROR;
+  }
+  if (fread (buffer, 1, SD_SDHC_BLOCKLEN, SD_Image) != SD_SDHC_BLOCKLEN) {
+    memset (buffer, 0, SD_SDHC_BLOCKLEN);
+  }
+  SD_Image_Sector++;
+  SD_Image_Stats.reads++;
+
+  return SD_START_TOKEN;
+}
+
+/**
+ * @brief   Stop Multiple Block Read
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Read_Stop (void)
+{
+  if (SD_Image_Stream != 1) {
+    return SD_ERROR;
+  }
+  SD_Image_Stream = 0;
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   Write Block
+ *
+ * @param   uint32_t sector
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Write_Block (uint32_t sector, uint8_t * buffer)
+{
+  if (SD_Image_Stream || !SD_Image_Powered () || (SD_ERROR == SD_Image_Seek (sector)) ||
+      (fwrite (buffer, 1, SD_SDHC_BLOCKLEN, SD_Image) != SD_SDHC_BLOCKLEN)) {
+    return SD_ERROR;
+  }
+  SD_Image_Stats.writes++;
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   Write Part Of Block, Rest Of Block Zero
+ *
+ * @param   uint32_t sector
+ * @param   uint8_t * buffer
+ * @param   uint16_t bytes
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Write_Part (uint32_t sector, uint8_t * buffer, uint16_t length)
+{
+  uint8_t block[SD_SDHC_BLOCKLEN];
+
+  memset (block, 0, sizeof (block));
+  memcpy (block, buffer, (length < sizeof (block)) ? length : sizeof (block));
+
+  return SD_Write_Block (sector, block);
+}
+
+/**
+ * @brief   Start Multiple Block Write
+ *
+ * @param   uint32_t sector
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Write_Start (uint32_t sector)
+{
+  if (SD_Image_Stream || (SD_ERROR == SD_Image_Seek (sector))) {
+    return SD_ERROR;
+  }
+  SD_Image_Sector = sector;
+  SD_Image_Stream = 2;
+  SD_Image_Stats.streams++;
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   Write Next Block Of Multiple Block Write
+ *
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Write_Next (uint8_t * buffer)
+{
+  if ((SD_Image_Stream != 2) || !SD_Image_Powered () || (SD_ERROR == SD_Image_Seek (SD_Image_Sector)) ||
+      (fwrite (buffer, 1, SD_SDHC_BLOCKLEN, SD_Image) != SD_SDHC_BLOCKLEN)) {
+    return SD_ERROR;
+  }
+  SD_Image_Sector++;
+  SD_Image_Stats.writes++;
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   Stop Multiple Block Write
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Write_Stop (void)
+{
+  if (SD_Image_Stream != 2) {
+    return SD_ERROR;
+  }
+  SD_Image_Stream = 0;
+  fflush (SD_Image);
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   Erase Sectors
+ * @note    erased sectors read as zeros
+ *
+ * @param   uint32_t first sector
+ * @param   uint32_t last sector
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Erase (uint32_t first, uint32_t last)
+{
+  uint8_t block[SD_SDHC_BLOCKLEN];
+
+  if (SD_Image_Stream || !SD_Image_Powered () || (SD_ERROR == SD_Image_Seek (first))) {
+    return SD_ERROR;
+  }
+  memset (block, 0, sizeof (block));
+  for (; first <= last; first++) {
+    if (fwrite (block, 1, SD_SDHC_BLOCKLEN, SD_Image) != SD_SDHC_BLOCKLEN) {
+      return SD_ERROR;
+    }
+  }
+
+  return SD_SUCCESS;
+}
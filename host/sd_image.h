@@ -0,0 +1,67 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       SD IMAGE - SD block functions served from card image file (host build)
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        sd_image.h
+ * @version     1.0
+ * @test        gcc, Linux
+ *
+ * @depend      sd.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   image file (dd of card, 512 bytes per sector)
+ * @pins
+ *
+ * @sources
+ */
+
+#ifndef __SD_IMAGE_H__
+#define __SD_IMAGE_H__
+
+  #include "../src/sd/sd.h"                             // SD_* prototypes served by image
+
+  // Card Access Counters
+  // --------------------------------------------------------------------------------------
+  typedef struct SD_Image_Stats_t {
+    uint32_t reads;                                      // sectors read, single and multiple block
+    uint32_t writes;                                     // sectors written, single and multiple block
+    uint32_t streams;                                    // multiple block transfers started (CMD18 / CMD25)
+  } SD_Image_Stats_t;
+
+  extern SD_Image_Stats_t SD_Image_Stats;
+
+  /**
+   * @brief   Open Card Image
+   * @note    image is read and written in place
+   *
+   * @param   const char * path
+   *
+   * @return  uint8_t
+   */
+  uint8_t SD_Image_Open (const char *);
+
+  /**
+   * @brief   Cut Power After Number Of Sector Writes
+   * @note    later writes and erases fail like on card without power;
+   *          0 - power kept, image reopened to continue
+   *
+   * @param   uint32_t writes
+   *
+   * @return  void
+   */
+  void SD_Image_Power (uint32_t);
+
+  /**
+   * @brief   Close Card Image
+   *
+   * @param   void
+   *
+   * @return  void
+   */
+  void SD_Image_Close (void);
+
+#endif
@@ -46,6 +46,9 @@ int main (void)
     return UI_ERROR;
   }
 
+  UI_Files.Count = UI_Get_Mp3Files(&FAT32, &UI_Files);
+  UI_Files.Pages = (UI_Files.Count + UI_Files.Group - 1) / UI_Files.Group;
+
   UI_Clear_Screen();
   UI_Print_Frame();
   UI_Show_Song(&FAT32, 9, &UI_Files);
@@ -0,0 +1,716 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       exFAT Interface (read only)
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        exfat.c
+ * @version     1.0
+ * @test        AVR Atmega328p
+ *
+ * @depend      sd.h, fat32.h, exfat.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   SPI 4-wire
+ * @pins        MOSI, MISO, CLK, SS, UCC, USS
+ *
+ * @sources     https://learn.microsoft.com/en-us/windows/win32/fileio/exfat-specification
+ */
+
+// INCLUDE libraries
+// ------------------------------------------------------------------
+#include <string.h>
+#include "exfat.h"
+
+/**
+ * @brief   First Sector Of Cluster
+ *
+ * @param   EXFAT_t * volume
+ * @param   uint32_t cluster
+ *
+ * @return  uint32_t
+ */
+static inline uint32_t EXFAT_Sector (EXFAT_t * EXFAT, uint32_t cluster)
+{
+  return EXFAT->data_area_begin + ((cluster - FAT32_CLUSTER_FIRST) << EXFAT->cluster_shift);
+}
+
+/**
+ * @brief   Next Cluster Of Chain Inside Cluster Heap
+ * @note    exFAT entries are full 32 bits, not masked as in FAT32
+ *
+ * @param   EXFAT_t * volume
+ * @param   uint32_t cluster
+ *
+ * @return  uint32_t next cluster, 0 = end of chain, bad or unreadable
+ */
+static uint32_t EXFAT_Chain_Next (EXFAT_t * EXFAT, uint32_t cluster)
+{
+  uint32_t next = EXFAT_Next_Cluster (EXFAT, cluster);
+
+  if ((next < FAT32_CLUSTER_FIRST) || (next >= (EXFAT->clusters + FAT32_CLUSTER_FIRST))) {
+    return 0;
+  }
+
+  return next;
+}
+
+/**
+ * @brief   Check Sector Is exFAT Boot Sector
+ *
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t 1 - exFAT boot sector, 0 - not
+ */
+static uint8_t EXFAT_Boot_Sector_Valid (uint8_t * buffer)
+{
+  EXFAT_BS_t * BS = (EXFAT_BS_t *) buffer;
+
+  if (memcmp (BS->FileSystemName, EXFAT_NAME, 8) != 0) {
+    return 0;
+  }
+
+  return FAT32_Get_2Bytes_LE (BS->Signature) == FAT32_SIGNATURE;
+}
+
+/**
+ * @brief   Read Directory Entry And Move Iterator
+ * @note    entry is copied, next cluster lookup may evict cache
+ *
+ * @param   EXFAT_t * volume
+ * @param   EXFAT_Dir_t * iterator
+ * @param   uint8_t * 32 bytes entry
+ *
+ * @return  uint8_t EXFAT_ERROR at end of directory
+ */
+static uint8_t EXFAT_Dir_Read (EXFAT_t * EXFAT, EXFAT_Dir_t * Dir, uint8_t * entry)
+{
+  uint8_t * buffer;
+
+  if (Dir->cluster == 0) {
+    return EXFAT_ERROR;
+  }
+  if (NULL == (buffer = FAT32_Read_Sector (EXFAT_Sector (EXFAT, Dir->cluster) + Dir->sector))) {
+    return EXFAT_ERROR;                                                       // cursor kept, may be resumed
+  }
+  memcpy (entry, &buffer[Dir->slot << 5], 32);
+  if (entry[0] == EXFAT_ENTRY_END) {
+    Dir->cluster = 0;
+    return EXFAT_ERROR;
+  }
+
+  // Move Cursor To Next Entry
+  // ----------------------------------------------------------------
+  if (++Dir->slot == (BYTES_PER_SECTOR >> 5)) {
+    Dir->slot = 0;
+    if (++Dir->sector == (1U << EXFAT->cluster_shift)) {
+      Dir->sector = 0;
+      if (Dir->last) {                                                        // contiguous, no FAT read
+        Dir->cluster = (Dir->cluster == Dir->last) ? 0 : (Dir->cluster + 1);
+      } else {
+        Dir->cluster = EXFAT_Chain_Next (EXFAT, Dir->cluster);              // 0 - last cluster of directory
+      }
+    }
+  }
+
+  return EXFAT_SUCCESS;
+}
+
+/**
+ * @brief   Hash Of Up-cased Name As In Stream Extension
+ *
+ * @param   EXFAT_t * volume
+ * @param   char * name
+ * @param   uint8_t length
+ *
+ * @return  uint16_t
+ */
+static uint16_t EXFAT_Name_Hash (EXFAT_t * EXFAT, char * name, uint8_t length)
+{
+  uint16_t c;
+  uint16_t hash = 0;
+
+  while (length--) {
+    c = EXFAT_Upcase (EXFAT, (uint8_t) *name++);
+    hash = ((hash & 1) ? 0x8000 : 0) + (hash >> 1) + (c & 0xFF);
+    hash = ((hash & 1) ? 0x8000 : 0) + (hash >> 1) + (c >> 8);
+  }
+
+  return hash;
+}
+
+/**
+ * @brief   Next Entry Set, Optionally Matching Name
+ * @note    name hash and length reject most sets before name entries are compared
+ *
+ * @param   EXFAT_t * volume
+ * @param   EXFAT_Dir_t * iterator
+ * @param   EXFAT_Entry_t * entry
+ * @param   char * name buffer, NULL = not needed
+ * @param   uint8_t size of name buffer
+ * @param   char * name searched, NULL = any
+ * @param   uint8_t length of name searched
+ *
+ * @return  uint8_t EXFAT_ERROR at end of directory
+ */
+static uint8_t EXFAT_Dir_Set (EXFAT_t * EXFAT, EXFAT_Dir_t * Dir, EXFAT_Entry_t * Entry,
+                              char * name, uint8_t size, char * match, uint8_t length)
+{
+  uint8_t i;
+  uint8_t pos;
+  uint8_t count;
+  uint8_t differ;
+  uint8_t entry[32];
+  uint16_t c;
+  uint16_t hash = 0;
+  uint16_t attribute;
+  EXFAT_Stream_DE_t * Stream = (EXFAT_Stream_DE_t *) entry;
+
+  if (match != NULL) {
+    hash = EXFAT_Name_Hash (EXFAT, match, length);
+  }
+  while (EXFAT_SUCCESS == EXFAT_Dir_Read (EXFAT, Dir, entry)) {
+    if (entry[0] != EXFAT_ENTRY_FILE) {                                       // deleted, label, tables
+      continue;
+    }
+    count = ((EXFAT_File_DE_t *) entry)->SecondaryCount;
+    attribute = FAT32_Get_2Bytes_LE (((EXFAT_File_DE_t *) entry)->FileAttributes);
+    if ((count < 2) || (EXFAT_SUCCESS != EXFAT_Dir_Read (EXFAT, Dir, entry))) {
+      continue;
+    }
+    if (entry[0] != EXFAT_ENTRY_STREAM) {
+      continue;                                                               // broken set
+    }
+
+    // Stream Extension
+    // --------------------------------------------------------------
+    Entry->attribute = attribute;
+    Entry->flags = Stream->GeneralSecondaryFlags;
+    Entry->cluster = FAT32_Get_4Bytes_LE (Stream->FirstCluster);
+    Entry->size = FAT32_Get_4Bytes_LE (&Stream->ValidDataLength[4]) ? 0xFFFFFFFF : FAT32_Get_4Bytes_LE (Stream->ValidDataLength);
+    Entry->length = FAT32_Get_4Bytes_LE (&Stream->DataLength[4]) ? 0xFFFFFFFF : FAT32_Get_4Bytes_LE (Stream->DataLength);
+    differ = (match != NULL) && ((Stream->NameLength != length) ||
+                                 (FAT32_Get_2Bytes_LE (Stream->NameHash) != hash));
+    length = (match != NULL) ? length : Stream->NameLength;
+
+    // Name Entries - compared only when hash matched
+    // --------------------------------------------------------------
+    pos = 0;
+    while (--count) {
+      if (EXFAT_SUCCESS != EXFAT_Dir_Read (EXFAT, Dir, entry)) {
+        return EXFAT_ERROR;
+      }
+      if (entry[0] != EXFAT_ENTRY_NAME) {                                     // vendor extension
+        continue;
+      }
+      for (i = 0; (i < EXFAT_NAME_CHARS) && (pos < length); i++, pos++) {
+        c = FAT32_Get_2Bytes_LE (&entry[2 + (i << 1)]);
+        if ((match != NULL) && !differ &&
+            (EXFAT_Upcase (EXFAT, c) != EXFAT_Upcase (EXFAT, (uint8_t) match[pos]))) {
+          differ = 1;
+        }
+        if ((name != NULL) && (pos < (size - 1))) {
+          name[pos] = (c > 0xFF) ? '?' : (char) c;
+        }
+      }
+    }
+    if (name != NULL) {
+      name[(pos < (size - 1)) ? pos : (size - 1)] = 0;
+    }
+    if (!differ) {
+      return EXFAT_SUCCESS;
+    }
+  }
+
+  return EXFAT_ERROR;
+}
+
+/**
+ * @brief   Up-case Character From Up-case Table On Card
+ * @note    table is compressed, 0xFFFF + count stands for run of identity mappings
+ *
+ * @param   EXFAT_t * volume
+ * @param   uint16_t character
+ *
+ * @return  uint16_t
+ */
+static uint16_t EXFAT_Upcase_Table (EXFAT_t * EXFAT, uint16_t c)
+{
+  uint8_t run = 0;
+  uint8_t * buffer = NULL;
+  uint16_t value;
+  uint32_t index = 0;                                                         // character mapped by value
+  uint32_t offset = 0;
+  uint32_t cluster = EXFAT->upcase_cluster;
+
+  while ((offset < EXFAT->upcase_length) && (index <= c)) {
+    if ((offset % BYTES_PER_SECTOR) == 0) {
+      if (offset && ((offset >> (9 + EXFAT->cluster_shift)) != ((offset - 2) >> (9 + EXFAT->cluster_shift)))) {
+        if (0 == (cluster = EXFAT_Chain_Next (EXFAT, cluster))) {
+          break;
+        }
+      }
+      buffer = FAT32_Read_Sector (EXFAT_Sector (EXFAT, cluster) +
+                                  ((offset >> 9) & ((1UL << EXFAT->cluster_shift) - 1)));
+      if (buffer == NULL) {
+        break;
+      }
+    }
+    value = FAT32_Get_2Bytes_LE (&buffer[offset % BYTES_PER_SECTOR]);
+    offset += 2;
+    if (run) {                                                                // identity run
+      index += value;
+      run = 0;
+    } else if (value == 0xFFFF) {
+      run = 1;
+    } else if (index++ == c) {
+      return value;
+    }
+  }
+
+  return c;                                                                   // identity
+}
+
+/**
+ * @brief   Find Allocation Bitmap And Up-case Table In Root Directory
+ *
+ * @param   EXFAT_t * volume
+ *
+ * @return  uint8_t
+ */
+static uint8_t EXFAT_Tables (EXFAT_t * EXFAT)
+{
+  uint8_t entry[32];
+  uint16_t c;
+  EXFAT_Dir_t Dir;
+  EXFAT_Table_DE_t * Table = (EXFAT_Table_DE_t *) entry;
+
+  EXFAT->bitmap_cluster = 0;
+  EXFAT->upcase_cluster = 0;
+  EXFAT_Dir_Open (EXFAT, &Dir, NULL);
+  while ((!EXFAT->bitmap_cluster || !EXFAT->upcase_cluster) &&
+         (EXFAT_SUCCESS == EXFAT_Dir_Read (EXFAT, &Dir, entry))) {
+    if ((entry[0] == EXFAT_ENTRY_BITMAP) && !(Table->Flags & 0x01)) {         // bitmap of first FAT
+      EXFAT->bitmap_cluster = FAT32_Get_4Bytes_LE (Table->FirstCluster);
+    } else if (entry[0] == EXFAT_ENTRY_UPCASE) {
+      EXFAT->upcase_cluster = FAT32_Get_4Bytes_LE (Table->FirstCluster);
+      EXFAT->upcase_length = FAT32_Get_4Bytes_LE (Table->DataLength);
+    }
+  }
+  if (!EXFAT->bitmap_cluster || !EXFAT->upcase_cluster) {
+    return EXFAT_ERROR;
+  }
+
+  // ASCII Mapped As Usual - no table lookups for plain names
+  // ----------------------------------------------------------------
+  EXFAT->upcase_ascii = 1;
+  for (c = 0; c < 0x80; c++) {
+    if (EXFAT_Upcase_Table (EXFAT, c) != (((c >= 'a') && (c <= 'z')) ? (c - 'a' + 'A') : c)) {
+      EXFAT->upcase_ascii = 0;
+      break;
+    }
+  }
+
+  return EXFAT_SUCCESS;
+}
+
+/**
+ * @brief   Sector Holding File Position
+ * @note    contiguous file computes cluster, chained file walks FAT forward
+ *
+ * @param   EXFAT_t * volume
+ * @param   EXFAT_File_t * file handle
+ *
+ * @return  uint32_t sector, 0 if cluster chain is broken
+ */
+static uint32_t EXFAT_File_Sector (EXFAT_t * EXFAT, EXFAT_File_t * File)
+{
+  uint32_t next;
+  uint32_t index = File->position >> (9 + EXFAT->cluster_shift);
+
+  if (File->contiguous) {
+    File->cluster = File->first_cluster + index;
+    File->cluster_index = index;
+  } else {
+    if (index < File->cluster_index) {                                        // backward seek
+      File->cluster = File->first_cluster;
+      File->cluster_index = 0;
+    }
+    while (File->cluster_index < index) {
+      if (0 == (next = EXFAT_Chain_Next (EXFAT, File->cluster))) {
+        return 0;
+      }
+      File->cluster = next;
+      File->cluster_index++;
+    }
+  }
+
+  return EXFAT_Sector (EXFAT, File->cluster) + ((File->position >> 9) & ((1UL << EXFAT->cluster_shift) - 1));
+}
+
+/**
+ * @brief   exFAT Init - card, volume, allocation bitmap and up-case table
+ * @note    volume at LBA 0 or in primary partition of type 0x07
+ *
+ * @param   EXFAT_t * volume
+ *
+ * @return  uint8_t
+ */
+uint8_t EXFAT_Init (EXFAT_t * EXFAT)
+{
+  uint8_t i;
+  uint8_t * buffer;
+  uint32_t lba = 0;
+  EXFAT_BS_t * BS;
+  PE_t * PE;
+
+  // SD Card Init
+  // ----------------------------------------------------------------
+  SD sd = { .voltage = 0, .sdhc = 0, .version = 0 };
+  if (SD_Init (&sd) == SD_ERROR) {
+    return EXFAT_ERROR;
+  }
+  FAT32_Cache_Invalidate ();
+
+  // Volume - boot sector at LBA 0 or partition of type 0x07
+  // ----------------------------------------------------------------
+  if (NULL == (buffer = FAT32_Read_Sector (0))) {
+    return EXFAT_ERROR;
+  }
+  if (!EXFAT_Boot_Sector_Valid (buffer)) {
+    if (FAT32_Get_2Bytes_LE (((MBR_t *) buffer)->Signature) != FAT32_SIGNATURE) {
+      return EXFAT_ERROR;
+    }
+    PE = &((MBR_t *) buffer)->Partition1;
+    for (i = 0; (i < 4) && !lba; i++, PE++) {
+      if ((PE->TypeCode == PE_TYPECODE_EXFAT) && !(PE->Status & PE_STATUS_ACTIVE_FLAG)) {
+        lba = FAT32_Get_4Bytes_LE (PE->LBA_Begin);
+      }
+    }
+    if ((lba == 0) || (NULL == (buffer = FAT32_Read_Sector (lba))) || !EXFAT_Boot_Sector_Valid (buffer)) {
+      return EXFAT_ERROR;
+    }
+  }
+
+  // Geometry
+  // ----------------------------------------------------------------
+  BS = (EXFAT_BS_t *) buffer;
+  if ((BS->BytesPerSectorShift != EXFAT_BYTES_PER_SECTOR_SHIFT) ||
+      (BS->SectorsPerClusterShift > 15) ||                                    // sector of iterator is 16 bit
+      (BS->NumberOfFats == 0)) {
+    return EXFAT_ERROR;
+  }
+  EXFAT->lba_begin = lba;
+  EXFAT->cluster_shift = BS->SectorsPerClusterShift;
+  EXFAT->fat_area_begin = lba + FAT32_Get_4Bytes_LE (BS->FatOffset);
+  if ((BS->NumberOfFats == 2) && (FAT32_Get_2Bytes_LE (BS->VolumeFlags) & 0x01)) {
+    EXFAT->fat_area_begin += FAT32_Get_4Bytes_LE (BS->FatLength);             // second FAT active
+  }
+  EXFAT->data_area_begin = lba + FAT32_Get_4Bytes_LE (BS->ClusterHeapOffset);
+  EXFAT->clusters = FAT32_Get_4Bytes_LE (BS->ClusterCount);
+  EXFAT->root_dir_clus_num = FAT32_Get_4Bytes_LE (BS->FirstClusterOfRootDirectory);
+  EXFAT->serial = FAT32_Get_4Bytes_LE (BS->VolumeSerialNumber);
+  EXFAT->free_count = 0xFFFFFFFF;
+
+  // Allocation Bitmap, Up-case Table
+  // ----------------------------------------------------------------
+  return EXFAT_Tables (EXFAT);
+}
+
+/**
+ * @brief   Open Directory Iterator
+ *
+ * @param   EXFAT_t * volume
+ * @param   EXFAT_Dir_t * iterator
+ * @param   EXFAT_Entry_t * directory entry, NULL = root directory
+ *
+ * @return  void
+ */
+void EXFAT_Dir_Open (EXFAT_t * EXFAT, EXFAT_Dir_t * Dir, EXFAT_Entry_t * Entry)
+{
+  Dir->sector = 0;
+  Dir->slot = 0;
+  Dir->last = 0;
+  if (Entry == NULL) {
+    Dir->cluster = EXFAT->root_dir_clus_num;
+    return;
+  }
+  Dir->cluster = Entry->cluster;
+  if (Entry->cluster && (Entry->flags & EXFAT_FLAG_NO_FAT_CHAIN)) {
+    Dir->last = Entry->cluster + ((Entry->length - 1) >> (9 + EXFAT->cluster_shift));
+  }
+}
+
+/**
+ * @brief   Next File Or Directory
+ *
+ * @param   EXFAT_t * volume
+ * @param   EXFAT_Dir_t * iterator
+ * @param   EXFAT_Entry_t * entry
+ * @param   char * name buffer, characters above 0xFF as '?', NULL = not needed
+ * @param   uint8_t size of name buffer including terminator
+ *
+ * @return  uint8_t EXFAT_ERROR at end of directory
+ */
+uint8_t EXFAT_Dir_Next (EXFAT_t * EXFAT, EXFAT_Dir_t * Dir, EXFAT_Entry_t * Entry, char * name, uint8_t size)
+{
+  return EXFAT_Dir_Set (EXFAT, Dir, Entry, name, size, NULL, 0);
+}
+
+/**
+ * @brief   Find Entry By Path
+ * @note    names compared through up-case table, stream hash checked first;
+ *          exFAT directories have no "." and ".." entries
+ *
+ * @param   EXFAT_t * volume
+ * @param   char * path
+ * @param   EXFAT_Entry_t * entry
+ *
+ * @return  uint8_t
+ */
+uint8_t EXFAT_Get_Path (EXFAT_t * EXFAT, char * path, EXFAT_Entry_t * Entry)
+{
+  uint8_t root = 1;
+  uint16_t length;
+  EXFAT_Dir_t Dir;
+
+  Entry->attribute = EXFAT_ATTR_DIRECTORY;
+  Entry->flags = 0;
+  Entry->cluster = EXFAT->root_dir_clus_num;
+  Entry->size = 0;
+  Entry->length = 0;
+
+  while (1) {
+    while (*path == FAT32_PATH_SEPARATOR) {
+      path++;
+    }
+    if (*path == 0) {
+      return EXFAT_SUCCESS;
+    }
+    if (!(Entry->attribute & EXFAT_ATTR_DIRECTORY)) {                         // file in the middle of path
+      return EXFAT_ERROR;
+    }
+    for (length = 0; path[length] && (path[length] != FAT32_PATH_SEPARATOR); length++) {
+      ;
+    }
+    if ((length == 1) && (path[0] == '.')) {
+      path++;
+      continue;
+    }
+    if (length > EXFAT_NAME_LENGTH) {
+      return EXFAT_ERROR;
+    }
+    EXFAT_Dir_Open (EXFAT, &Dir, root ? NULL : Entry);
+    if (EXFAT_SUCCESS != EXFAT_Dir_Set (EXFAT, &Dir, Entry, NULL, 0, path, (uint8_t) length)) {
+      return EXFAT_ERROR;
+    }
+    root = 0;
+    path += length;
+  }
+}
+
+/**
+ * @brief   Open File By Path
+ *
+ * @param   EXFAT_t * volume
+ * @param   EXFAT_File_t * file handle
+ * @param   char * path
+ *
+ * @return  uint8_t
+ */
+uint8_t EXFAT_Open_Path (EXFAT_t * EXFAT, EXFAT_File_t * File, char * path)
+{
+  EXFAT_Entry_t Entry;
+
+  if (EXFAT_SUCCESS != EXFAT_Get_Path (EXFAT, path, &Entry)) {
+    return EXFAT_ERROR;
+  }
+  if (Entry.attribute & EXFAT_ATTR_DIRECTORY) {
+    return EXFAT_ERROR;
+  }
+  File->first_cluster = Entry.cluster;
+  File->size = Entry.size;
+  File->position = 0;
+  File->cluster = Entry.cluster;
+  File->cluster_index = 0;
+  File->contiguous = (Entry.flags & EXFAT_FLAG_NO_FAT_CHAIN) ? 1 : 0;
+  File->open = 1;
+
+  return EXFAT_SUCCESS;
+}
+
+/**
+ * @brief   Read Data From File
+ * @note    contiguous file (no FAT chain) never reads FAT, whole sectors
+ *          go straight into caller buffer
+ *
+ * @param   EXFAT_t * volume
+ * @param   EXFAT_File_t * file handle
+ * @param   uint8_t * buffer
+ * @param   uint16_t number of bytes
+ *
+ * @return  uint16_t number of bytes read
+ */
+uint16_t EXFAT_Read (EXFAT_t * EXFAT, EXFAT_File_t * File, uint8_t * buffer, uint16_t length)
+{
+  uint8_t * cache;
+  uint16_t done = 0;
+  uint16_t chunk;
+  uint16_t offset;
+  uint32_t sector;
+
+  if ((!File->open) || (File->position >= File->size)) {
+    return 0;
+  }
+  if (length > (File->size - File->position)) {                              // clip to end of file
+    length = File->size - File->position;
+  }
+
+  while (done < length) {
+    if (0 == (sector = EXFAT_File_Sector (EXFAT, File))) {
+      break;
+    }
+    offset = File->position % BYTES_PER_SECTOR;
+    chunk = BYTES_PER_SECTOR - offset;
+    if (chunk > (length - done)) {
+      chunk = length - done;
+    }
+    if (chunk == BYTES_PER_SECTOR) {
+      if (SD_START_TOKEN != SD_Read_Block (sector, &buffer[done])) {
+        break;
+      }
+    } else {
+      if (NULL == (cache = FAT32_Read_Sector (sector))) {
+        break;
+      }
+      memcpy (&buffer[done], &cache[offset], chunk);
+    }
+    done += chunk;
+    File->position += chunk;
+  }
+
+  return done;
+}
+
+/**
+ * @brief   Set File Position
+ *
+ * @param   EXFAT_t * volume
+ * @param   EXFAT_File_t * file handle
+ * @param   uint32_t byte offset from beginning of file
+ *
+ * @return  uint8_t
+ */
+uint8_t EXFAT_Seek (EXFAT_t * EXFAT, EXFAT_File_t * File, uint32_t position)
+{
+  if ((!File->open) || (position > File->size)) {
+    return EXFAT_ERROR;
+  }
+  File->position = position;
+
+  return EXFAT_SUCCESS;
+}
+
+/**
+ * @brief   Close File
+ *
+ * @param   EXFAT_t * volume
+ * @param   EXFAT_File_t * file handle
+ *
+ * @return  uint8_t
+ */
+uint8_t EXFAT_Close (EXFAT_t * EXFAT, EXFAT_File_t * File)
+{
+  if (!File->open) {
+    return EXFAT_ERROR;
+  }
+  File->open = 0;
+
+  return EXFAT_SUCCESS;
+}
+
+/**
+ * @brief   Free Clusters From Allocation Bitmap
+ * @note    counted once, then kept in EXFAT_t
+ *
+ * @param   EXFAT_t * volume
+ *
+ * @return  uint32_t free clusters, 0xFFFFFFFF = bitmap unreadable
+ */
+uint32_t EXFAT_Free_Clusters (EXFAT_t * EXFAT)
+{
+  uint8_t bits;
+  uint8_t * buffer;
+  uint16_t i;
+  uint32_t sector = 0;
+  uint32_t used = 0;
+  uint32_t cluster = EXFAT->bitmap_cluster;
+  uint32_t left = EXFAT->clusters;                                            // bits not yet examined
+
+  if (EXFAT->free_count != 0xFFFFFFFF) {
+    return EXFAT->free_count;
+  }
+  while (left) {
+    if (NULL == (buffer = FAT32_Read_Sector (EXFAT_Sector (EXFAT, cluster) + sector))) {
+      return 0xFFFFFFFF;
+    }
+    for (i = 0; (i < BYTES_PER_SECTOR) && left; i++) {
+      bits = buffer[i];
+      if (left < 8) {
+        bits &= (1 << left) - 1;                                              // bits behind last cluster
+      }
+      left -= (left < 8) ? left : 8;
+      for (; bits; bits &= bits - 1) {
+        used++;
+      }
+    }
+    if (++sector == (1UL << EXFAT->cluster_shift)) {
+      sector = 0;
+      cluster = EXFAT_Chain_Next (EXFAT, cluster);
+      if (left && (cluster == 0)) {
+        return 0xFFFFFFFF;
+      }
+    }
+  }
+  EXFAT->free_count = EXFAT->clusters - used;
+
+  return EXFAT->free_count;
+}
+
+/**
+ * @brief   Up-case Character Through Up-case Table
+ *
+ * @param   EXFAT_t * volume
+ * @param   uint16_t character
+ *
+ * @return  uint16_t
+ */
+uint16_t EXFAT_Upcase (EXFAT_t * EXFAT, uint16_t c)
+{
+  if ((c < 0x80) && EXFAT->upcase_ascii) {
+    return ((c >= 'a') && (c <= 'z')) ? (c - 'a' + 'A') : c;
+  }
+
+  return EXFAT_Upcase_Table (EXFAT, c);
+}
+
+/**
+ * @brief   Next Cluster Of FAT Chain
+ *
+ * @param   EXFAT_t * volume
+ * @param   uint32_t cluster
+ *
+ * @return  uint32_t next cluster, EXFAT_CLUSTER_EOC if unreadable
+ */
+uint32_t EXFAT_Next_Cluster (EXFAT_t * EXFAT, uint32_t cluster)
+{
+  uint8_t * buffer;
+
+  if (NULL == (buffer = FAT32_Read_Sector (EXFAT->fat_area_begin + (cluster >> 7)))) {
+    return EXFAT_CLUSTER_EOC;
+  }
+
+  return FAT32_Get_4Bytes_LE (&buffer[(cluster << 2) % BYTES_PER_SECTOR]);
+}
\ No newline at end of file
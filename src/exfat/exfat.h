@@ -0,0 +1,314 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       exFAT (read only)
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        exfat.h
+ * @version     1.0
+ * @test        AVR Atmega328p
+ *
+ * @depend      sd.h, fat32.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   SPI 4-wire
+ * @pins
+ *
+ * @sources     https://learn.microsoft.com/en-us/windows/win32/fileio/exfat-specification
+ */
+
+#ifndef __EXFAT_H__
+#define __EXFAT_H__
+
+  #include "../fat32/fat32.h"                           // sector cache, little endian access
+
+  // RETURN
+  // --------------------------------------------------------------------------------------
+  #define EXFAT_ERROR                   0xff
+  #define EXFAT_SUCCESS                 0x00
+
+  // Boot Sector
+  // --------------------------------------------------------------------------------------
+  #define EXFAT_NAME                    "EXFAT   "      // file system name at offset 3
+  #define EXFAT_BYTES_PER_SECTOR_SHIFT  9               // only 512 bytes per sector accepted
+  #define PE_TYPECODE_EXFAT             0x07            // shared with NTFS
+
+  // Directory Entry Types
+  // --------------------------------------------------------------------------------------
+  #define EXFAT_ENTRY_END               0x00            // end of directory
+  #define EXFAT_ENTRY_IN_USE            0x80            // clear = deleted entry
+  #define EXFAT_ENTRY_BITMAP            0x81            // allocation bitmap
+  #define EXFAT_ENTRY_UPCASE            0x82            // up-case table
+  #define EXFAT_ENTRY_LABEL             0x83            // volume label
+  #define EXFAT_ENTRY_FILE              0x85            // file / directory, primary
+  #define EXFAT_ENTRY_STREAM            0xC0            // stream extension, secondary
+  #define EXFAT_ENTRY_NAME              0xC1            // 15 characters of name, secondary
+
+  // Stream Extension Flags
+  // --------------------------------------------------------------------------------------
+  #define EXFAT_FLAG_ALLOCATION         0x01            // clusters allocated
+  #define EXFAT_FLAG_NO_FAT_CHAIN       0x02            // clusters contiguous, FAT not valid
+
+  // FAT Entries
+  // --------------------------------------------------------------------------------------
+  #define EXFAT_CLUSTER_EOC             0xFFFFFFFF      // end of chain, entries use all 32 bits
+
+  // File Attributes
+  // --------------------------------------------------------------------------------------
+  #define EXFAT_ATTR_READ_ONLY          0x01
+  #define EXFAT_ATTR_HIDDEN             0x02
+  #define EXFAT_ATTR_SYSTEM             0x04
+  #define EXFAT_ATTR_DIRECTORY          0x10
+  #define EXFAT_ATTR_ARCHIVE            0x20
+
+  #define EXFAT_NAME_CHARS              15              // characters of one name entry
+  #define EXFAT_NAME_LENGTH             255             // max characters of name
+
+  // Boot Sector
+  // --------------------------------------------------------------------------------------
+  // 512 Bytes
+  typedef struct EXFAT_BS_t {
+    uint8_t Jump[3];                                    // 0xEB 0x76 0x90
+    uint8_t FileSystemName[8];                          // "EXFAT   "
+    uint8_t MustBeZero[53];                             // area of FAT BPB
+    uint8_t PartitionOffset[8];                         // sectors before volume
+    uint8_t VolumeLength[8];                            // sectors of volume
+    uint8_t FatOffset[4];                               // first sector of FAT, relative to volume
+    uint8_t FatLength[4];                               // sectors of FAT
+    uint8_t ClusterHeapOffset[4];                       // first sector of cluster 2, relative to volume
+    uint8_t ClusterCount[4];                            // clusters in heap
+    uint8_t FirstClusterOfRootDirectory[4];             // first cluster of root directory
+    uint8_t VolumeSerialNumber[4];                      // serial number
+    uint8_t FileSystemRevision[2];                      // 1.00
+    uint8_t VolumeFlags[2];                             // active FAT, volume dirty, media failure
+    uint8_t BytesPerSectorShift;                        // log2 bytes per sector
+    uint8_t SectorsPerClusterShift;                     // log2 sectors per cluster
+    uint8_t NumberOfFats;                               // 1 or 2 (TexFAT)
+    uint8_t DriveSelect;                                // INT 13h drive number
+    uint8_t PercentInUse;                               // 0..100, 0xFF = unknown
+    uint8_t Reserved[7];
+    uint8_t BootCode[390];
+    uint8_t Signature[2];                               // signature => must be 0xAA55
+  } __attribute__((packed)) EXFAT_BS_t;
+
+  // Directory Entry - File
+  // --------------------------------------------------------------------------------------
+  // 32 Bytes
+  typedef struct EXFAT_File_DE_t {
+    uint8_t EntryType;                                  // 0x85
+    uint8_t SecondaryCount;                             // stream extension + name entries
+    uint8_t SetChecksum[2];                             // checksum of entry set
+    uint8_t FileAttributes[2];                          // attributes
+    uint8_t Reserved1[2];
+    uint8_t CreateTimestamp[4];
+    uint8_t LastModifiedTimestamp[4];
+    uint8_t LastAccessedTimestamp[4];
+    uint8_t Create10msIncrement;
+    uint8_t LastModified10msIncrement;
+    uint8_t CreateUtcOffset;
+    uint8_t LastModifiedUtcOffset;
+    uint8_t LastAccessedUtcOffset;
+    uint8_t Reserved2[7];
+  } __attribute__((packed)) EXFAT_File_DE_t;
+
+  // Directory Entry - Stream Extension
+  // --------------------------------------------------------------------------------------
+  // 32 Bytes
+  typedef struct EXFAT_Stream_DE_t {
+    uint8_t EntryType;                                  // 0xC0
+    uint8_t GeneralSecondaryFlags;                      // allocation possible, no FAT chain
+    uint8_t Reserved1;
+    uint8_t NameLength;                                 // characters of name
+    uint8_t NameHash[2];                                // hash of up-cased name
+    uint8_t Reserved2[2];
+    uint8_t ValidDataLength[8];                         // bytes written
+    uint8_t Reserved3[4];
+    uint8_t FirstCluster[4];                            // first cluster of data
+    uint8_t DataLength[8];                              // bytes allocated
+  } __attribute__((packed)) EXFAT_Stream_DE_t;
+
+  // Directory Entry - Allocation Bitmap, Up-case Table (same layout)
+  // --------------------------------------------------------------------------------------
+  // 32 Bytes
+  typedef struct EXFAT_Table_DE_t {
+    uint8_t EntryType;                                  // 0x81 / 0x82
+    uint8_t Flags;                                      // bitmap: 0 = first, 1 = second FAT
+    uint8_t Reserved1[2];
+    uint8_t TableChecksum[4];                           // up-case table only
+    uint8_t Reserved2[12];
+    uint8_t FirstCluster[4];                            // first cluster of table
+    uint8_t DataLength[8];                              // bytes of table
+  } __attribute__((packed)) EXFAT_Table_DE_t;
+
+  // Volume
+  // --------------------------------------------------------------------------------------
+  typedef struct EXFAT_t {
+    uint8_t cluster_shift;                               // log2 sectors per cluster
+    uint8_t upcase_ascii;                                // 1 - up-case table maps ASCII as usual
+    uint32_t lba_begin;                                  // boot sector
+    uint32_t fat_area_begin;                             // first sector of FAT
+    uint32_t data_area_begin;                            // first sector of cluster 2
+    uint32_t clusters;                                   // clusters in heap
+    uint32_t root_dir_clus_num;                          // first cluster of root directory
+    uint32_t serial;                                     // volume serial number
+    uint32_t bitmap_cluster;                             // first cluster of allocation bitmap
+    uint32_t upcase_cluster;                             // first cluster of up-case table
+    uint32_t upcase_length;                              // bytes of up-case table
+    uint32_t free_count;                                 // free clusters, 0xFFFFFFFF = not counted yet
+  } EXFAT_t;
+
+  // Directory Iterator
+  // --------------------------------------------------------------------------------------
+  typedef struct EXFAT_Dir_t {
+    uint32_t cluster;                                    // cluster of next entry, 0 = end
+    uint32_t last;                                       // last cluster of contiguous directory, 0 = FAT chain
+    uint16_t sector;                                     // sector of next entry in cluster
+    uint8_t slot;                                        // next entry in sector
+  } EXFAT_Dir_t;
+
+  // Directory Entry Set (file, stream extension, names)
+  // --------------------------------------------------------------------------------------
+  typedef struct EXFAT_Entry_t {
+    uint16_t attribute;                                  // EXFAT_ATTR_*
+    uint8_t flags;                                       // EXFAT_FLAG_*
+    uint32_t cluster;                                    // first cluster, 0 = empty
+    uint32_t size;                                       // valid data length, 0xFFFFFFFF if 4 GB or more
+    uint32_t length;                                     // allocated bytes, for contiguous directories
+  } EXFAT_Entry_t;
+
+  // File Handle
+  // --------------------------------------------------------------------------------------
+  typedef struct EXFAT_File_t {
+    uint32_t first_cluster;                              // first cluster of file
+    uint32_t size;                                       // file size in bytes
+    uint32_t position;                                   // current byte offset in file
+    uint32_t cluster;                                    // cluster holding current byte offset
+    uint32_t cluster_index;                              // order of current cluster in file
+    uint8_t contiguous;                                  // 1 - no FAT chain, cluster = first + index
+    uint8_t open;                                        // 1 - handle in use, 0 - closed
+  } EXFAT_File_t;
+
+  /**
+   * @brief   exFAT Init - card, volume, allocation bitmap and up-case table
+   * @note    volume at LBA 0 or in primary partition of type 0x07
+   *
+   * @param   EXFAT_t * volume
+   *
+   * @return  uint8_t
+   */
+  uint8_t EXFAT_Init (EXFAT_t *);
+
+  /**
+   * @brief   Open Directory Iterator
+   *
+   * @param   EXFAT_t * volume
+   * @param   EXFAT_Dir_t * iterator
+   * @param   EXFAT_Entry_t * directory entry, NULL = root directory
+   *
+   * @return  void
+   */
+  void EXFAT_Dir_Open (EXFAT_t *, EXFAT_Dir_t *, EXFAT_Entry_t *);
+
+  /**
+   * @brief   Next File Or Directory
+   *
+   * @param   EXFAT_t * volume
+   * @param   EXFAT_Dir_t * iterator
+   * @param   EXFAT_Entry_t * entry
+   * @param   char * name buffer, characters above 0xFF as '?', NULL = not needed
+   * @param   uint8_t size of name buffer including terminator
+   *
+   * @return  uint8_t EXFAT_ERROR at end of directory
+   */
+  uint8_t EXFAT_Dir_Next (EXFAT_t *, EXFAT_Dir_t *, EXFAT_Entry_t *, char *, uint8_t);
+
+  /**
+   * @brief   Find Entry By Path
+   * @note    names compared through up-case table, stream hash checked first
+   *
+   * @param   EXFAT_t * volume
+   * @param   char * path
+   * @param   EXFAT_Entry_t * entry
+   *
+   * @return  uint8_t
+   */
+  uint8_t EXFAT_Get_Path (EXFAT_t *, char *, EXFAT_Entry_t *);
+
+  /**
+   * @brief   Open File By Path
+   *
+   * @param   EXFAT_t * volume
+   * @param   EXFAT_File_t * file handle
+   * @param   char * path
+   *
+   * @return  uint8_t
+   */
+  uint8_t EXFAT_Open_Path (EXFAT_t *, EXFAT_File_t *, char *);
+
+  /**
+   * @brief   Read Data From File
+   * @note    contiguous file (no FAT chain) never reads FAT
+   *
+   * @param   EXFAT_t * volume
+   * @param   EXFAT_File_t * file handle
+   * @param   uint8_t * buffer
+   * @param   uint16_t number of bytes
+   *
+   * @return  uint16_t number of bytes read
+   */
+  uint16_t EXFAT_Read (EXFAT_t *, EXFAT_File_t *, uint8_t *, uint16_t);
+
+  /**
+   * @brief   Set File Position
+   *
+   * @param   EXFAT_t * volume
+   * @param   EXFAT_File_t * file handle
+   * @param   uint32_t byte offset from beginning of file
+   *
+   * @return  uint8_t
+   */
+  uint8_t EXFAT_Seek (EXFAT_t *, EXFAT_File_t *, uint32_t);
+
+  /**
+   * @brief   Close File
+   *
+   * @param   EXFAT_t * volume
+   * @param   EXFAT_File_t * file handle
+   *
+   * @return  uint8_t
+   */
+  uint8_t EXFAT_Close (EXFAT_t *, EXFAT_File_t *);
+
+  /**
+   * @brief   Free Clusters From Allocation Bitmap
+   * @note    counted once, then kept in EXFAT_t
+   *
+   * @param   EXFAT_t * volume
+   *
+   * @return  uint32_t free clusters, 0xFFFFFFFF = bitmap unreadable
+   */
+  uint32_t EXFAT_Free_Clusters (EXFAT_t *);
+
+  /**
+   * @brief   Up-case Character Through Up-case Table
+   *
+   * @param   EXFAT_t * volume
+   * @param   uint16_t character
+   *
+   * @return  uint16_t
+   */
+  uint16_t EXFAT_Upcase (EXFAT_t *, uint16_t);
+
+  /**
+   * @brief   Next Cluster Of FAT Chain
+   *
+   * @param   EXFAT_t * volume
+   * @param   uint32_t cluster
+   *
+   * @return  uint32_t next cluster, EXFAT_CLUSTER_EOC if unreadable
+   */
+  uint32_t EXFAT_Next_Cluster (EXFAT_t *, uint32_t);
+
+#endif
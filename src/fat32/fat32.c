@@ -21,292 +21,4781 @@
 
 // INCLUDE libraries
 // ------------------------------------------------------------------
+#include <ctype.h>
+#include <stddef.h>
+#include <string.h>
 #include "fat32.h"
+#if defined (FAT32_INDEX_EEPROM) || defined (FAT32_MOUNT_EEPROM)
+  #include <avr/eeprom.h>
+#endif
+
+// Sector Cache
+// ------------------------------------------------------------------
+static uint8_t FAT32_Cache[BYTES_PER_SECTOR];                                 // last read sector
+static uint32_t FAT32_Cache_Sector = 0xFFFFFFFF;                              // address of cached sector
+static uint32_t FAT32_Stream = 0;                                             // next sector of open multiple block transfer
+static uint8_t FAT32_Stream_Read = 0;                                         // open transfer is multiple block read
+
+// Volume Discovery
+// ------------------------------------------------------------------
+static uint32_t FAT32_Volume_Sector0 = 0;                                     // checksum of sector 0 at last mount
+static uint32_t FAT32_Volume_Begin = 0xFFFFFFFF;                              // boot sector found at last mount
+#ifdef FAT32_MOUNT_EEPROM
+static FAT32_Mount_t EEMEM FAT32_Mount;                                       // volume of last mount, kept over power off
+static uint8_t FAT32_Mount_Cached = 0;                                        // 1 - volume taken from mount cache
+#endif
+
+// Directory Index
+// ------------------------------------------------------------------
+#ifdef FAT32_INDEX_EEPROM
+static FAT32_Index_t EEMEM FAT32_Index[FAT32_INDEX_ENTRIES];                  // spilled to EEPROM
+#endif
+static union {
+#ifndef FAT32_INDEX_EEPROM
+  FAT32_Index_t Entry[FAT32_INDEX_ENTRIES];
+#endif
+  uint8_t Sector[BYTES_PER_SECTOR];                                           // lent to pool while index file valid
+} FAT32_Index_Ram;
+static uint16_t FAT32_Index_Loaded = 0;                                       // entries filled by root directory scan
+static uint8_t FAT32_Index_Lent = 0;                                          // 1 - storage used as sector buffer
+
+/**
+ * @brief   Store Directory Index Entry
+ *
+ * @param   uint16_t position in index
+ * @param   FAT32_Index_t * entry
+ *
+ * @return  void
+ */
+static inline void FAT32_Index_Store (uint16_t i, FAT32_Index_t * Entry)
+{
+#ifdef FAT32_INDEX_EEPROM
+  eeprom_update_block (Entry, &FAT32_Index[i], sizeof (FAT32_Index_t));
+#else
+  FAT32_Index_Ram.Entry[i] = *Entry;
+#endif
+}
+
+/**
+ * @brief   Load Directory Index Entry
+ *
+ * @param   uint16_t position in index
+ * @param   FAT32_Index_t * entry
+ *
+ * @return  void
+ */
+static inline void FAT32_Index_Load (uint16_t i, FAT32_Index_t * Entry)
+{
+#ifdef FAT32_INDEX_EEPROM
+  eeprom_read_block (Entry, &FAT32_Index[i], sizeof (FAT32_Index_t));
+#else
+  *Entry = FAT32_Index_Ram.Entry[i];
+#endif
+}
+
+// Resolved Directories
+// ------------------------------------------------------------------
+static FAT32_Dircache_t FAT32_Dircache[FAT32_DIRCACHE_ENTRIES];
+static FAT32_Dir_t FAT32_Scan;                                                // position of last root directory scan
+static uint8_t FAT32_Dircache_Next = 0;                                       // round robin replacement
+
+// Free Cluster Map
+// ------------------------------------------------------------------
+#ifdef FAT32_FREEMAP
+static uint8_t FAT32_Freemap[FAT32_FREEMAP_BYTES];                            // 1 - all FAT sectors of region full
+static uint32_t FAT32_Freemap_Summary;                                        // 1 - all regions of map byte full
+static uint8_t FAT32_Freemap_Shift;                                           // region = 1 << shift FAT entries
+static uint8_t FAT32_Freemap_Seen;                                            // recount: free entry in region
+#endif
+
+// Directory Index File
+// ------------------------------------------------------------------
+static FAT32_File_t FAT32_Index_Handle;                                       // handle of index file
+static uint8_t FAT32_Index_Valid = 0;                                         // 1 - records match root directory
+static uint8_t * FAT32_Record_Buffer = NULL;                                  // records of one sector while rebuilding
+static uint8_t FAT32_Record_Overflow;                                         // index file too small
+static uint32_t FAT32_Hash_Slots = 0;                                         // buckets of name hash table, 0 = none
+static uint32_t FAT32_Index_Capacity = 0;                                     // records room in front of hash table
+static uint32_t FAT32_Index_First = 0;                                        // 1st sector of contiguous index file, 0 = fragmented
+static uint8_t FAT32_Sort_Views = 0;                                          // bit (1 << FAT32_SORT_*) set = view built
+
+// Intent Journal
+// ------------------------------------------------------------------
+#ifdef FAT32_JOURNAL
+static uint8_t FAT32_Journal_Record[sizeof (FAT32_Journal_t) + FAT32_JOURNAL_INTENTS * sizeof (FAT32_Intent_t)];
+static FAT32_Intent_t * const FAT32_Intents = (FAT32_Intent_t *) &FAT32_Journal_Record[sizeof (FAT32_Journal_t)];
+static uint8_t FAT32_Intents_Count = 0;                                       // intents not committed yet
+static uint32_t FAT32_Journal_First = 0;                                      // 1st sector of journal file, 0 = no journal
+static uint32_t FAT32_Journal_Sectors;                                        // header sector + ring of commit sectors
+static uint32_t FAT32_Journal_Sequence;                                       // last commit written
+static uint32_t FAT32_Journal_Checkpoint;                                     // last commit applied on card
+static uint8_t FAT32_Cache_Dirty = 0;                                         // cached FAT sector not written yet
+static uint32_t FAT32_Cache_Mirror;                                           // distance of second FAT copy
+static uint8_t * FAT32_Data_Buffer = NULL;                                    // pool buffer for data sectors while FAT sector held
+static uint32_t FAT32_Data_Sector = 0xFFFFFFFF;                               // sector in data buffer
+#endif
+
+static uint32_t FAT32_File_Sector (FAT32_t *, FAT32_File_t *);
+static uint8_t FAT32_Cache_Clean (void);
+static uint16_t FAT32_Hash_Find (FAT32_t *, char *, uint8_t, uint8_t *, FAT32_Index_t *);
+static uint32_t FAT32_Sort_Area (FAT32_t *, uint8_t);
+
+/**
+ * @brief   Format Short Name 8.3 As "NAME.EXT"
+ *
+ * @param   uint8_t * name 11 bytes
+ * @param   uint8_t * output, min 13 bytes
+ *
+ * @return  void
+ */
+static void FAT32_Short_Name (uint8_t * name, uint8_t * out)
+{
+  uint8_t i;
+
+  for (i = 0; (i < 8) && (name[i] != ' '); i++) {
+    *out++ = name[i];
+  }
+  if (name[8] != ' ') {
+    *out++ = '.';
+    for (i = 8; (i < 11) && (name[i] != ' '); i++) {
+      *out++ = name[i];
+    }
+  }
+  *out = 0;
+}
+
+/**
+ * @brief   Checksum Of Sector
+ *
+ * @param   uint8_t * buffer
+ *
+ * @return  uint32_t
+ */
+static uint32_t FAT32_Checksum (uint8_t * buffer)
+{
+  uint32_t sum = 0;
+
+  for (uint16_t i = 0; i < BYTES_PER_SECTOR; i++) {
+    sum = ((sum << 1) | (sum >> 31)) + buffer[i];                             // rotate & add
+  }
+
+  return sum;
+}
+
+/**
+ * @brief   Sectors Of Directory Cluster
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t cluster
+ *
+ * @return  uint16_t
+ */
+static inline uint16_t FAT32_Cluster_Sectors (FAT32_t * FAT32, uint32_t cluster)
+{
+  return (cluster < FAT32_CLUSTER_FIRST) ? FAT32->root_dir_sectors : FAT32->sectors_per_cluster;
+}
+
+/**
+ * @brief   Sector Of Index File Holding Position
+ * @note    contiguous index file is mapped without walking cluster chain
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t position
+ *
+ * @return  uint32_t sector, 0 = error
+ */
+static uint32_t FAT32_Index_Sector (FAT32_t * FAT32, uint32_t position)
+{
+  if (FAT32_Index_First) {
+    return FAT32_Index_First + (position / BYTES_PER_SECTOR);
+  }
+  FAT32_Index_Handle.position = position;
+
+  return FAT32_File_Sector (FAT32, &FAT32_Index_Handle);
+}
+
+/**
+ * @brief   Write Sector Of Records Into Index File
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t number of records written so far
+ *
+ * @return  void
+ */
+static void FAT32_Record_Flush (FAT32_t * FAT32, uint32_t records)
+{
+  uint32_t sector;
+  uint32_t position = (1 + (records - 1) / FAT32_SDINDEX_RECORDS) * BYTES_PER_SECTOR;
+
+  if (position >= FAT32_Index_Handle.size) {                                  // index file too small
+    FAT32_Record_Overflow = 1;
+  } else {
+    sector = FAT32_Index_Sector (FAT32, position);
+    if ((sector == 0) || (FAT32_ERROR == FAT32_Write_Sector (sector, FAT32_Record_Buffer))) {
+      FAT32_Record_Overflow = 1;
+    }
+  }
+  memset (FAT32_Record_Buffer, 0, BYTES_PER_SECTOR);
+}
+
+/**
+ * @brief   Fill Record Of Index File
+ *
+ * @param   FAT32_Record_t * record
+ * @param   FAT32_Index_t * entry
+ * @param   DE_t * directory entry
+ * @param   FAT32_Name_t * name
+ *
+ * @return  void
+ */
+static void FAT32_Record_Fill (FAT32_Record_t * Record, FAT32_Index_t * Entry, DE_t * DE, FAT32_Name_t * Name)
+{
+  size_t length = strlen ((char *) Name->buffer);
+
+  FAT32_Put_4Bytes_LE (Record->Cluster, Entry->cluster);
+  FAT32_Put_4Bytes_LE (Record->Size, Entry->size);
+  FAT32_Put_4Bytes_LE (Record->Sector, Entry->sector);
+  FAT32_Put_2Bytes_LE (Record->Hash, Entry->hash);
+  Record->Slot = Entry->slot;
+  Record->Attribute = Entry->attribute;
+  Record->Lfn = Entry->lfn;
+  FAT32_Put_2Bytes_LE (Record->LongHash, Name->hash);
+  memcpy (Record->Name, DE->Name, 11);
+  FAT32_Put_4Bytes_LE (Record->Changed, ((uint32_t) FAT32_Get_2Bytes_LE (DE->ChangeDate) << 16) | FAT32_Get_2Bytes_LE (DE->ChangeTime));
+  memset (Record->LongName, 0, FAT32_SDINDEX_NAME_LENGTH);                   // zero padded, directory order
+  if (length > (FAT32_SDINDEX_NAME_LENGTH - 1)) {                            // keep terminator
+    length = FAT32_SDINDEX_NAME_LENGTH - 1;
+  }
+  memcpy (Record->LongName, Name->buffer, length);
+}
+
+/**
+ * @brief   Append Record To Index File Being Rebuilt
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t file number
+ * @param   FAT32_Index_t * entry
+ * @param   DE_t * directory entry
+ * @param   FAT32_Name_t * name
+ *
+ * @return  void
+ */
+static void FAT32_Record_Append (FAT32_t * FAT32, uint32_t files, FAT32_Index_t * Entry, DE_t * DE, FAT32_Name_t * Name)
+{
+  uint8_t i = (files - 1) % FAT32_SDINDEX_RECORDS;
+
+  FAT32_Record_Fill ((FAT32_Record_t *) FAT32_Record_Buffer + i, Entry, DE, Name);
+  if (i == (FAT32_SDINDEX_RECORDS - 1)) {                                     // sector full
+    FAT32_Record_Flush (FAT32, files);
+  }
+}
+
+/**
+ * @brief   Fingerprint Of Root Directory
+ * @note    chain of root directory, first sectors and sector holding end of directory
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_SDIndex_t * header
+ * @param   uint8_t 1 - compare with header, 0 - store into header
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Root_Fingerprint (FAT32_t * FAT32, FAT32_SDIndex_t * Header, uint8_t verify)
+{
+  uint8_t i;
+  uint8_t end = 0;
+  uint8_t * buffer;
+  uint32_t head = 0;
+  uint32_t length = 0;
+  uint32_t last;
+  uint32_t tail;
+  uint32_t cluster = FAT32->root_dir_clus_num;
+  uint32_t first = FAT32_Get_1st_Sector_Of_Clus (FAT32, cluster);
+
+  // Root Directory Chain
+  // ----------------------------------------------------------------
+  do {
+    last = cluster;
+    if (++length > 0xFFFF) {                                                  // cycle in FAT
+      return FAT32_ERROR;
+    }
+    cluster = FAT32_FAT_Next_Cluster (FAT32, cluster) & FAT32_CLUSTER_MASK;
+  } while ((cluster >= FAT32_CLUSTER_FIRST) && (cluster < FAT32_CLUSTER_EOC));
+
+  // Head - first sectors of directory
+  // ----------------------------------------------------------------
+  for (i = 0; (i < FAT32_SDINDEX_HEAD_SECTORS) && (i < FAT32_Cluster_Sectors (FAT32, FAT32->root_dir_clus_num)); i++) {
+    if (NULL == (buffer = FAT32_Read_Sector (first + i))) {
+      return FAT32_ERROR;
+    }
+    head = ((head << 1) | (head >> 31)) ^ FAT32_Checksum (buffer);
+  }
+
+  // Tail - sector holding end of directory marker in last cluster
+  // ----------------------------------------------------------------
+  first = FAT32_Get_1st_Sector_Of_Clus (FAT32, last);
+  tail = verify ? FAT32_Get_4Bytes_LE (Header->TailSector) : first;
+  if ((tail < first) || (tail >= (first + FAT32_Cluster_Sectors (FAT32, last)))) {
+    return FAT32_ERROR;                                                       // directory grew or shrank
+  }
+  while (1) {
+    if (NULL == (buffer = FAT32_Read_Sector (tail))) {
+      return FAT32_ERROR;
+    }
+    for (i = 0; i < (BYTES_PER_SECTOR >> 5); i++) {
+      if (buffer[i << 5] == FAT32_DE_END) {
+        end = 1;
+        break;
+      }
+    }
+    if (end || (tail == (first + FAT32_Cluster_Sectors (FAT32, last) - 1))) {          // last sector of chain
+      break;
+    }
+    if (verify) {
+      return FAT32_ERROR;                                                     // end of directory moved
+    }
+    tail++;
+  }
+
+  // Compare / Store
+  // ----------------------------------------------------------------
+  if (verify) {
+    if ((FAT32_Get_4Bytes_LE (Header->RootCluster) != FAT32->root_dir_clus_num) ||
+        (FAT32_Get_4Bytes_LE (Header->ChainLength) != length) ||
+        (FAT32_Get_4Bytes_LE (Header->HeadChecksum) != head) ||
+        (FAT32_Get_4Bytes_LE (Header->TailChecksum) != FAT32_Checksum (buffer))) {
+      return FAT32_ERROR;
+    }
+  } else {
+    FAT32_Put_4Bytes_LE (Header->RootCluster, FAT32->root_dir_clus_num);
+    FAT32_Put_4Bytes_LE (Header->ChainLength, length);
+    FAT32_Put_4Bytes_LE (Header->HeadChecksum, head);
+    FAT32_Put_4Bytes_LE (Header->TailSector, tail);
+    FAT32_Put_4Bytes_LE (Header->TailChecksum, FAT32_Checksum (buffer));
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Scan Root Directory In One Pass
+ * @note    filenum == 0 fills directory index, otherwise stops at filenum
+ *          forward lookups resume from position of previous lookup
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t file number to find, 0 = build index
+ * @param   FAT32_Index_t * found entry
+ * @param   FAT32_Name_t * name of found entry, NULL = not needed
+ *
+ * @return  uint32_t number of entries passed
+ */
+static uint32_t FAT32_Root_Dir_Scan (FAT32_t * FAT32, uint32_t filenum, FAT32_Index_t * Found, FAT32_Name_t * Name)
+{
+  uint8_t * buffer;
+  uint8_t name[FAT32_SDINDEX_NAME_LENGTH];
+  FAT32_Index_t Entry;
+  FAT32_Name_t Long;
+
+  if (Name == NULL) {
+    FAT32_Name_Init (&Long, name, sizeof (name));                             // names for index file records
+    Name = &Long;
+  }
+  if ((filenum == 0) || (filenum <= FAT32_Scan.index) || (FAT32_Scan.first_cluster == 0)) {
+    FAT32_Dir_Open (FAT32, &FAT32_Scan, 0);                                   // restart from first entry
+  }
+
+  while (FAT32_SUCCESS == FAT32_Dir_Next (FAT32, &FAT32_Scan, &Entry,
+                                          ((filenum == 0) || ((FAT32_Scan.index + 1) == filenum)) ? Name : NULL)) {
+    if (filenum != 0) {
+      if (FAT32_Scan.index == filenum) {
+        *Found = Entry;
+        break;
+      }
+      continue;
+    }
+    if ((FAT32_Scan.index <= FAT32_INDEX_ENTRIES) && !FAT32_Index_Lent) {
+      FAT32_Index_Store (FAT32_Scan.index - 1, &Entry);
+      FAT32_Index_Loaded = FAT32_Scan.index;
+    }
+    if ((FAT32_Record_Buffer != NULL) && (NULL != (buffer = FAT32_Read_Sector (Entry.sector)))) {
+      FAT32_Record_Append (FAT32, FAT32_Scan.index, &Entry, (DE_t *) &buffer[Entry.slot << 5], Name);
+    }
+  }
+
+  return FAT32_Scan.index;
+}
+
+/**
+ * @brief   Remember Current Cluster As Checkpoint
+ * @note    checkpoints lie evenly along walked part of chain; when all are
+ *          used every second one is dropped and distance doubled, so a long
+ *          file keeps checkpoints at 1/4, 2/4, ... of the walked chain
+ *
+ * @param   FAT32_File_t * file handle
+ *
+ * @return  void
+ */
+static void FAT32_File_Checkpoint (FAT32_File_t * File)
+{
+  uint8_t i;
+
+  if ((File->cluster_index == 0) ||
+      (File->cluster_index & ((1UL << File->checkpoint_shift) - 1)) ||
+      ((File->cluster_index >> File->checkpoint_shift) != (uint32_t) (File->checkpoints + 1))) {
+    return;                                                                   // not next checkpoint
+  }
+  if (File->checkpoints == FAT32_FILE_CHECKPOINTS) {
+    for (i = 0; i < (FAT32_FILE_CHECKPOINTS >> 1); i++) {
+      File->checkpoint[i] = File->checkpoint[(i << 1) + 1];
+    }
+    File->checkpoints = FAT32_FILE_CHECKPOINTS >> 1;
+    File->checkpoint_shift++;
+    return;                                                                   // odd multiple of new distance
+  }
+  File->checkpoint[File->checkpoints++] = File->cluster;
+}
+
+/**
+ * @brief   Walk Cluster Chain To Cluster Holding File Position
+ * @note    forward from current cluster, backward from nearest checkpoint
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_File_Locate (FAT32_t * FAT32, FAT32_File_t * File)
+{
+  uint8_t i;
+  uint32_t next;
+  uint32_t index = File->position >> (BYTES_PER_SECTOR_SHIFT + FAT32->cluster_shift);
+
+  // Backward Seek - restart from nearest checkpoint below position
+  // ----------------------------------------------------------------
+  if (index < File->cluster_index) {
+    File->cluster = File->first_cluster;
+    File->cluster_index = 0;
+    for (i = File->checkpoints; i > 0; i--) {
+      if (((uint32_t) i << File->checkpoint_shift) <= index) {
+        File->cluster = File->checkpoint[i - 1];
+        File->cluster_index = (uint32_t) i << File->checkpoint_shift;
+        break;
+      }
+    }
+  }
+  // Forward - continue from current cluster, never from the start
+  // ----------------------------------------------------------------
+  while (File->cluster_index < index) {
+    next = FAT32_FAT_Next_Cluster (FAT32, File->cluster) & FAT32_CLUSTER_MASK;
+    if ((next < FAT32_CLUSTER_FIRST) || (next >= FAT32_CLUSTER_EOC)) {        // chain shorter than file size
+      return FAT32_ERROR;
+    }
+    File->cluster = next;
+    File->cluster_index++;
+    FAT32_File_Checkpoint (File);
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Sector Holding File Position
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
+ *
+ * @return  uint32_t sector, 0 if cluster chain is broken
+ */
+static uint32_t FAT32_File_Sector (FAT32_t * FAT32, FAT32_File_t * File)
+{
+  if (FAT32_ERROR == FAT32_File_Locate (FAT32, File)) {
+    return 0;
+  }
+
+  return FAT32_Get_1st_Sector_Of_Clus (FAT32, File->cluster) +
+         ((File->position >> BYTES_PER_SECTOR_SHIFT) & (FAT32->sectors_per_cluster - 1));
+}
+
+/**
+ * @brief   Init File Handle
+ *
+ * @param   FAT32_File_t * file handle
+ * @param   uint32_t first cluster
+ * @param   uint32_t size
+ *
+ * @return  void
+ */
+static void FAT32_File_Init (FAT32_File_t * File, uint32_t cluster, uint32_t size)
+{
+  File->first_cluster = cluster;
+  File->size = size;
+  File->position = 0;
+  File->cluster = cluster;
+  File->cluster_index = 0;
+  File->open = 1;
+  File->dirty = 0;
+  File->entry_slot = 0;
+  File->entry_sector = 0;
+  File->reserved_first = 0;
+  File->reserved_last = 0;
+  File->checkpoints = 0;
+  File->checkpoint_shift = 0;
+}
+
+/**
+ * @brief   Short Name 8.3 Of Path Component
+ *
+ * @param   char * component
+ * @param   uint8_t length
+ * @param   uint8_t * 11 bytes short name
+ *
+ * @return  uint8_t 1 - component is valid short name, 0 - not
+ */
+static uint8_t FAT32_Name_83 (char * component, uint8_t length, uint8_t * name)
+{
+  uint8_t i;
+  uint8_t dot = length;
+
+  memset (name, ' ', 11);
+  if ((length == 2) && (component[0] == '.') && (component[1] == '.')) {      // parent directory
+    name[0] = name[1] = '.';
+    return 1;
+  }
+  for (i = 0; i < length; i++) {
+    if (component[i] == '.') {
+      dot = i;
+    }
+  }
+  if ((dot == 0) || (dot > 8) || ((length - dot) > 4)) {                      // base 1-8, extension 0-3
+    return 0;
+  }
+  for (i = 0; i < length; i++) {
+    if (i == dot) {
+      continue;
+    }
+    if ((component[i] == '.') || (component[i] == ' ')) {                     // second dot or space
+      return 0;
+    }
+    name[(i < dot) ? i : (i - dot + 7)] = toupper (component[i]);
+  }
+
+  return 1;
+}
+
+/**
+ * @brief   Entry Passes Filter Of Directory Iterator
+ * @note    attribute and extension compared in place, files only; same test
+ *          for directory entries and index file records
+ *
+ * @param   uint8_t attribute
+ * @param   uint8_t * extension of short name, 3 characters
+ *
+ * @return  uint8_t 1 - passes
+ */
+static inline uint8_t FAT32_Dir_Filter (uint8_t attribute, uint8_t * extension)
+{
+  const char * filter = FAT32_FILTER_EXTENSIONS;
+
+  if (attribute & FAT32_FILTER_ATTRIBUTES) {
+    return 0;
+  }
+  for (; *filter; filter += 3) {
+    if (memcmp (extension, filter, 3) == 0) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief   Find Name In Directory
+ * @note    matches short name or long name (case insensitive), root directory
+ *          is looked up in hash table of index file when available, names
+ *          the table does not cover (long names without FAT32_HASH_LONG_NAMES)
+ *          walk the directory
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t first cluster of directory
+ * @param   char * name
+ * @param   uint8_t length of name
+ * @param   FAT32_Index_t * entry
+ *
+ * @return  uint16_t number of entry in directory, 0 = not found
+ */
+static uint16_t FAT32_Dir_Find (FAT32_t * FAT32, uint32_t cluster, char * component, uint8_t length, FAT32_Index_t * Entry)
+{
+  uint8_t * buffer;
+  uint8_t name83[11];
+  uint8_t name[FAT32_PATH_NAME_LENGTH + 2];                                   // +1 detects longer names
+  uint8_t shortname = FAT32_Name_83 (component, length, name83);
+  uint16_t hash = FAT32_Hash (name83, 11);
+  uint16_t filenum;
+  FAT32_Dir_t Dir;
+  FAT32_Name_t Long;
+
+  if (length > FAT32_PATH_NAME_LENGTH) {
+    return 0;
+  }
+  // Hash Table - bucket and record read
+  // ----------------------------------------------------------------
+  if ((cluster == FAT32->root_dir_clus_num) && FAT32_Index_Valid && FAT32_Hash_Slots) {
+    if (0 != (filenum = FAT32_Hash_Find (FAT32, component, length, shortname ? name83 : NULL, Entry))) {
+      return filenum;
+    }
+#ifdef FAT32_HASH_LONG_NAMES
+    return 0;                                                                 // every name hashed, miss is final
+#endif
+  }
+
+  // Directory Walk
+  // ----------------------------------------------------------------
+  FAT32_Name_Init (&Long, name, length + 2);
+  FAT32_Dir_Open (FAT32, &Dir, cluster);
+  while (FAT32_SUCCESS == FAT32_Dir_Next (FAT32, &Dir, Entry, &Long)) {
+    if ((name[length] == 0) && (strncasecmp ((char *) name, component, length) == 0)) {
+      return Dir.index;                                                       // long name or short name
+    }
+    if (shortname && (Entry->hash == hash)) {                                 // short name written differently
+      if (NULL == (buffer = FAT32_Read_Sector (Entry->sector))) {
+        return 0;
+      }
+      if (memcmp (((DE_t *) &buffer[Entry->slot << 5])->Name, name83, 11) == 0) {
+        return Dir.index;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief   Position Of Record In Index File
+ *
+ * @param   uint32_t file number (1 - files), files + 1 = end of records
+ *
+ * @return  uint32_t
+ */
+static uint32_t FAT32_Record_Position (uint32_t filenum)
+{
+  return (1 + (filenum - 1) / FAT32_SDINDEX_RECORDS) * BYTES_PER_SECTOR +
+         ((filenum - 1) % FAT32_SDINDEX_RECORDS) * sizeof (FAT32_Record_t);
+}
+
+/**
+ * @brief   Position Of Hash Table In Index File (first sector after room for records)
+ *
+ * @param   uint32_t records room
+ *
+ * @return  uint32_t
+ */
+static uint32_t FAT32_Hash_Table (uint32_t capacity)
+{
+  return (1 + (capacity + FAT32_SDINDEX_RECORDS - 1) / FAT32_SDINDEX_RECORDS) * BYTES_PER_SECTOR;
+}
+
+/**
+ * @brief   Read From Index File
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t position
+ * @param   uint8_t * buffer
+ * @param   uint16_t length
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Index_Read (FAT32_t * FAT32, uint32_t position, uint8_t * buffer, uint16_t length)
+{
+  uint8_t * data;
+
+  if (FAT32_Index_First && (((position % BYTES_PER_SECTOR) + length) <= BYTES_PER_SECTOR)) {
+    if ((position + length) > FAT32_Index_Handle.size) {
+      return FAT32_ERROR;
+    }
+    if (NULL == (data = FAT32_Read_Sector (FAT32_Index_Sector (FAT32, position)))) {
+      return FAT32_ERROR;
+    }
+    memcpy (buffer, data + (position % BYTES_PER_SECTOR), length);            // one cached sector read
+    return FAT32_SUCCESS;
+  }
+  if (FAT32_ERROR == FAT32_Seek (FAT32, &FAT32_Index_Handle, position)) {
+    return FAT32_ERROR;
+  }
+  if (length != FAT32_Read (FAT32, &FAT32_Index_Handle, buffer, length)) {
+    return FAT32_ERROR;
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Place Key Into Bucket Sector Of Hash Table
+ * @note    probing wraps inside sector, so every sector is built on its own
+ *
+ * @param   uint8_t * buffer holding bucket sector
+ * @param   uint16_t hash
+ * @param   uint16_t file number
+ *
+ * @return  uint8_t FAT32_ERROR if sector is full
+ */
+static uint8_t FAT32_Hash_Place (uint8_t * buffer, uint16_t hash, uint16_t filenum)
+{
+  uint8_t i;
+  uint8_t slot = hash % FAT32_SDINDEX_BUCKETS;
+  FAT32_Bucket_t * Bucket;
+
+  for (i = 0; i < FAT32_SDINDEX_BUCKETS; i++) {
+    Bucket = (FAT32_Bucket_t *) buffer + slot;
+    if (FAT32_Get_2Bytes_LE (Bucket->File) == 0) {
+      FAT32_Put_2Bytes_LE (Bucket->Hash, hash);
+      FAT32_Put_2Bytes_LE (Bucket->File, filenum);
+      return FAT32_SUCCESS;
+    }
+    slot = (slot + 1) % FAT32_SDINDEX_BUCKETS;                                // linear probing
+  }
+
+  return FAT32_ERROR;
+}
+
+/**
+ * @brief   Key Of Hash Table Being Built
+ * @note    from compact key list if built, else from record (short name key, then long name key)
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t position of key list, 0 = none
+ * @param   uint32_t key number
+ * @param   FAT32_Bucket_t * key, file number 0 = no key
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Hash_Key (FAT32_t * FAT32, uint32_t list, uint32_t key, FAT32_Bucket_t * Bucket)
+{
+  uint16_t filenum = key + 1;
+  FAT32_Record_t Record;
+
+  if (list) {
+    return FAT32_Index_Read (FAT32, list + key * sizeof (FAT32_Bucket_t), (uint8_t *) Bucket, sizeof (FAT32_Bucket_t));
+  }
+#ifdef FAT32_HASH_LONG_NAMES
+  filenum = (key >> 1) + 1;
+#endif
+  if (FAT32_ERROR == FAT32_Index_Read (FAT32, FAT32_Record_Position (filenum), (uint8_t *) &Record, sizeof (Record))) {
+    return FAT32_ERROR;
+  }
+  memcpy (Bucket->Hash, Record.Hash, 2);
+  FAT32_Put_2Bytes_LE (Bucket->File, filenum);
+#ifdef FAT32_HASH_LONG_NAMES
+  if (key & 1) {
+    memcpy (Bucket->Hash, Record.LongHash, 2);
+    if (FAT32_Get_2Bytes_LE (Record.LongHash) == 0) {
+      FAT32_Put_2Bytes_LE (Bucket->File, 0);                                  // no long name
+    }
+  }
+#endif
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Build Name Hash Table From Records Of Index File
+ * @note    keys are first gathered into compact list in scratch area (records
+ *          read once), then table is built one sector per pass over keys, so
+ *          every sector is written once; table is kept at most half full, no
+ *          table if index file is too small or a sector overflows
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t * buffer of one sector
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Hash_Build (FAT32_t * FAT32, uint8_t * buffer)
+{
+  uint32_t key;
+  uint32_t count = 0;
+  uint32_t table;
+  uint32_t keys = FAT32->files;
+  uint32_t list;
+  uint32_t part;
+  uint32_t sector;
+  FAT32_Bucket_t Bucket;
+
+#ifdef FAT32_HASH_LONG_NAMES
+  keys <<= 1;
+#endif
+  FAT32_Hash_Slots = FAT32_SDINDEX_BUCKETS;
+  while (FAT32_Hash_Slots < (keys << 1)) {
+    FAT32_Hash_Slots <<= 1;
+  }
+
+  // Room For Records - as many as table admits, if sort areas still fit
+  // ----------------------------------------------------------------
+  FAT32_Index_Capacity = FAT32_Hash_Slots >> 1;                               // keys at most half of buckets
+#ifdef FAT32_HASH_LONG_NAMES
+  FAT32_Index_Capacity >>= 1;
+#endif
+  if (FAT32_Sort_Area (FAT32, FAT32_SORT_KEYS + 3) > FAT32_Index_Handle.size) {
+    FAT32_Index_Capacity = (FAT32->files + FAT32_SDINDEX_RECORDS - 1) / FAT32_SDINDEX_RECORDS * FAT32_SDINDEX_RECORDS;
+  }
+  table = FAT32_Hash_Table (FAT32_Index_Capacity);
+  if ((FAT32->files > 0xFFFF) ||
+      ((table + FAT32_Hash_Slots * sizeof (FAT32_Bucket_t)) > FAT32_Index_Handle.size)) {
+    FAT32_Hash_Slots = 0;                                                     // lookups walk directory
+    return FAT32_ERROR;
+  }
+
+  // Key List - one pass over records, if scratch area fits
+  // ----------------------------------------------------------------
+  list = FAT32_Sort_Area (FAT32, FAT32_SORT_KEYS + 1);
+  if ((list + keys * sizeof (FAT32_Bucket_t)) > FAT32_Index_Handle.size) {
+    list = 0;                                                                 // passes read records
+  }
+  for (key = 0; list && (key < keys); key++) {
+    if (FAT32_ERROR == FAT32_Hash_Key (FAT32, 0, key, &Bucket)) {
+      FAT32_Hash_Slots = 0;
+      return FAT32_ERROR;
+    }
+    if (FAT32_Get_2Bytes_LE (Bucket.File) == 0) {
+      continue;
+    }
+    memcpy ((FAT32_Bucket_t *) buffer + (count % FAT32_SDINDEX_BUCKETS), &Bucket, sizeof (Bucket));
+    if ((++count % FAT32_SDINDEX_BUCKETS) == 0) {
+      sector = FAT32_Index_Sector (FAT32, list + (count / FAT32_SDINDEX_BUCKETS - 1) * BYTES_PER_SECTOR);
+      if ((sector == 0) || (FAT32_ERROR == FAT32_Write_Sector (sector, buffer))) {
+        FAT32_Hash_Slots = 0;
+        return FAT32_ERROR;
+      }
+    }
+  }
+  if (list && (count % FAT32_SDINDEX_BUCKETS)) {                              // last, partially filled sector
+    sector = FAT32_Index_Sector (FAT32, list + (count / FAT32_SDINDEX_BUCKETS) * BYTES_PER_SECTOR);
+    if ((sector == 0) || (FAT32_ERROR == FAT32_Write_Sector (sector, buffer))) {
+      FAT32_Hash_Slots = 0;
+      return FAT32_ERROR;
+    }
+  }
+  if (list == 0) {
+    count = keys;
+  }
+
+  // Table - one sector per pass over keys
+  // ----------------------------------------------------------------
+  for (part = 0; part < (FAT32_Hash_Slots / FAT32_SDINDEX_BUCKETS); part++) {
+    memset (buffer, 0, BYTES_PER_SECTOR);
+    for (key = 0; key < count; key++) {
+      if (FAT32_ERROR == FAT32_Hash_Key (FAT32, list, key, &Bucket)) {
+        FAT32_Hash_Slots = 0;
+        return FAT32_ERROR;
+      }
+      if ((FAT32_Get_2Bytes_LE (Bucket.File) != 0) &&
+          (((FAT32_Get_2Bytes_LE (Bucket.Hash) & (FAT32_Hash_Slots - 1)) / FAT32_SDINDEX_BUCKETS) == part) &&
+          (FAT32_ERROR == FAT32_Hash_Place (buffer, FAT32_Get_2Bytes_LE (Bucket.Hash), FAT32_Get_2Bytes_LE (Bucket.File)))) {
+        FAT32_Hash_Slots = 0;                                                 // sector overflows
+        return FAT32_ERROR;
+      }
+    }
+    if ((0 == (sector = FAT32_Index_Sector (FAT32, table + part * BYTES_PER_SECTOR))) ||
+        (FAT32_ERROR == FAT32_Write_Sector (sector, buffer))) {
+      FAT32_Hash_Slots = 0;
+      return FAT32_ERROR;
+    }
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Find Name In Hash Table Of Index File
+ * @note    candidates with equal hash are confirmed by their record only,
+ *          long names longer than record keep are confirmed by prefix
+ *
+ * @param   FAT32_t * FAT32
+ * @param   char * name
+ * @param   uint8_t length of name
+ * @param   uint8_t * short name 8.3, NULL = name is not valid short name
+ * @param   FAT32_Index_t * entry
+ *
+ * @return  uint16_t file number, 0 = not found
+ */
+static uint16_t FAT32_Hash_Find (FAT32_t * FAT32, char * component, uint8_t length, uint8_t * name83, FAT32_Index_t * Entry)
+{
+  uint8_t key;
+  uint8_t probe;
+  uint8_t compare = (length < FAT32_SDINDEX_NAME_LENGTH) ? length : (FAT32_SDINDEX_NAME_LENGTH - 1);
+  uint16_t hash;
+  uint16_t filenum;
+  uint32_t slot;
+  uint32_t table = FAT32_Hash_Table (FAT32_Index_Capacity);
+  FAT32_Bucket_t Bucket;
+  FAT32_Record_t Record;
+
+#ifdef FAT32_HASH_LONG_NAMES
+  for (key = (name83 == NULL) ? 1 : 0; key < 2; key++) {
+#else
+  for (key = 0; (key < 1) && (name83 != NULL); key++) {
+#endif
+    hash = key ? FAT32_Hash_Long ((uint8_t *) component, length) : FAT32_Hash (name83, 11);
+    slot = hash & (FAT32_Hash_Slots - 1);
+    for (probe = 0; probe < FAT32_SDINDEX_BUCKETS; probe++) {
+      if (FAT32_ERROR == FAT32_Index_Read (FAT32, table + slot * sizeof (Bucket), (uint8_t *) &Bucket, sizeof (Bucket))) {
+        return 0;
+      }
+      if (0 == (filenum = FAT32_Get_2Bytes_LE (Bucket.File))) {
+        break;                                                                // empty bucket ends probing
+      }
+      if ((FAT32_Get_2Bytes_LE (Bucket.Hash) == hash) &&
+          (FAT32_SUCCESS == FAT32_Get_Record (FAT32, filenum, &Record))) {
+        if (key ? ((FAT32_Get_2Bytes_LE (Record.LongHash) == hash) &&
+                   (strncasecmp ((char *) Record.LongName, component, compare) == 0) &&
+                   ((compare < length) || (Record.LongName[length] == 0)))
+                : (memcmp (Record.Name, name83, 11) == 0)) {
+          return (FAT32_SUCCESS == FAT32_Get_Index (FAT32, filenum, Entry)) ? filenum : 0;
+        }
+      }
+      slot = (slot & ~(uint32_t) (FAT32_SDINDEX_BUCKETS - 1)) | ((slot + 1) % FAT32_SDINDEX_BUCKETS);   // wraps inside sector
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief   Position Of Sorted View Or Scratch Area In Index File
+ * @note    areas follow hash table: views of FAT32_SORT_KEYS keys (2 bytes per file),
+ *          then two scratch areas for runs (FAT32_Key_t per file)
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t area, 1 - FAT32_SORT_KEYS views, FAT32_SORT_KEYS + 1 / + 2 scratch
+ *
+ * @return  uint32_t
+ */
+static uint32_t FAT32_Sort_Area (FAT32_t * FAT32, uint8_t area)
+{
+  uint32_t view = ((uint32_t) FAT32->files * 2 + BYTES_PER_SECTOR - 1) & ~(uint32_t) (BYTES_PER_SECTOR - 1);
+  uint32_t scratch = ((uint32_t) FAT32->files * sizeof (FAT32_Key_t) + BYTES_PER_SECTOR - 1) & ~(uint32_t) (BYTES_PER_SECTOR - 1);
+  uint32_t position = FAT32_Hash_Table (FAT32_Index_Capacity) + FAT32_Hash_Slots * sizeof (FAT32_Bucket_t);
+
+  if (area <= FAT32_SORT_KEYS) {
+    return position + (area - 1) * view;
+  }
+
+  return position + FAT32_SORT_KEYS * view + (area - FAT32_SORT_KEYS - 1) * scratch;
+}
+
+/**
+ * @brief   Sort Key Of Record
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t FAT32_SORT_*
+ * @param   uint16_t file number
+ * @param   FAT32_Key_t * key
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Sort_Key (FAT32_t * FAT32, uint8_t sort, uint16_t filenum, FAT32_Key_t * Key)
+{
+  uint8_t i;
+  uint32_t value;
+  FAT32_Record_t Record;
+
+  if (FAT32_ERROR == FAT32_Get_Record (FAT32, filenum, &Record)) {
+    return FAT32_ERROR;
+  }
+  memset (Key->Key, 0, sizeof (Key->Key));
+  if (sort == FAT32_SORT_NAME) {
+    for (i = 0; (i < sizeof (Key->Key)) && Record.LongName[i]; i++) {
+      Key->Key[i] = toupper (Record.LongName[i]);
+    }
+  } else {
+    value = FAT32_Get_4Bytes_LE ((sort == FAT32_SORT_SIZE) ? Record.Size : Record.Changed);
+    for (i = sizeof (Key->Key); value; value >>= 8) {
+      Key->Key[--i] = (uint8_t) value;                                        // big endian, memcmp order
+    }
+  }
+  FAT32_Put_2Bytes_LE (Key->File, filenum);
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Compare Sort Keys
+ * @note    names equal in key prefix are compared by record, equal keys by file number
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t FAT32_SORT_*
+ * @param   FAT32_Key_t * first
+ * @param   FAT32_Key_t * second
+ *
+ * @return  int8_t < 0, 0, > 0
+ */
+static int8_t FAT32_Sort_Compare (FAT32_t * FAT32, uint8_t sort, FAT32_Key_t * A, FAT32_Key_t * B)
+{
+  int result = memcmp (A->Key, B->Key, sizeof (A->Key));
+  FAT32_Record_t Record;
+  uint8_t name[FAT32_SDINDEX_NAME_LENGTH - sizeof (A->Key)];
+
+  if ((result == 0) && (sort == FAT32_SORT_NAME) && A->Key[sizeof (A->Key) - 1] &&
+      (FAT32_SUCCESS == FAT32_Get_Record (FAT32, FAT32_Get_2Bytes_LE (A->File), &Record))) {
+    memcpy (name, &Record.LongName[sizeof (A->Key)], sizeof (name));
+    if (FAT32_SUCCESS == FAT32_Get_Record (FAT32, FAT32_Get_2Bytes_LE (B->File), &Record)) {
+      result = strncasecmp ((char *) name, (char *) &Record.LongName[sizeof (A->Key)], sizeof (name));
+    }
+  }
+  if (result == 0) {
+    result = (int) FAT32_Get_2Bytes_LE (A->File) - (int) FAT32_Get_2Bytes_LE (B->File);
+  }
+
+  return (result < 0) ? -1 : (result > 0);
+}
+
+/**
+ * @brief   Write Half Sector Into Index File
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t position, multiple of half sector
+ * @param   uint8_t * data
+ * @param   uint16_t length, at most half sector
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Sort_Flush (FAT32_t * FAT32, uint32_t position, uint8_t * data, uint16_t length)
+{
+  uint8_t * buffer;
+  uint32_t sector;
+
+  if ((0 == (sector = FAT32_Index_Sector (FAT32, position))) ||
+      (NULL == (buffer = FAT32_Read_Sector (sector)))) {
+    return FAT32_ERROR;
+  }
+  memcpy (&buffer[position % BYTES_PER_SECTOR], data, length);
+
+  return FAT32_Write_Sector (sector, buffer);
+}
+
+/**
+ * @brief   Emit Key Into Run Or Sorted View Being Written
+ * @note    keys are collected in half sector buffer, last pass stores file numbers only
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t * half sector buffer
+ * @param   uint32_t position of buffer start in index file
+ * @param   uint16_t index of key in buffer
+ * @param   FAT32_Key_t * key
+ * @param   uint8_t 1 - last pass
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Sort_Emit (FAT32_t * FAT32, uint8_t * half, uint32_t position, uint16_t index, FAT32_Key_t * Key, uint8_t last)
+{
+  uint16_t size = last ? 2 : sizeof (FAT32_Key_t);
+  uint16_t count = (BYTES_PER_SECTOR >> 1) / size;
+
+  memcpy (&half[(index % count) * size], last ? Key->File : (uint8_t *) Key, size);
+  if (((index % count) == (count - 1)) || (index == (FAT32->files - 1))) {
+    return FAT32_Sort_Flush (FAT32, position + (index - index % count) * size, half, (index % count + 1) * size);
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Sector Cache Claimed For Sector Written From Scratch
+ * @note    content is zeroed, not read from card
+ *
+ * @param   uint32_t sector
+ *
+ * @return  uint8_t *
+ */
+static uint8_t * FAT32_Blank_Sector (uint32_t sector)
+{
+  if (FAT32_ERROR == FAT32_Cache_Clean ()) {
+    return NULL;
+  }
+  memset (FAT32_Cache, 0, BYTES_PER_SECTOR);
+  FAT32_Cache_Sector = sector;                                                // valid once written
+
+  return FAT32_Cache;
+}
+
+/**
+ * @brief   Close Open Multiple Block Transfer
+ * @note    called before any other card access
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Stream_Stop (void)
+{
+  if (FAT32_Stream == 0) {
+    return FAT32_SUCCESS;
+  }
+  FAT32_Stream = 0;
+  if (SD_SUCCESS != (FAT32_Stream_Read ? SD_Read_Stop () : SD_Write_Stop ())) {
+    return FAT32_ERROR;
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Write Sector As Part Of Multiple Block Write
+ * @note    consecutive sectors continue one transfer, other sector starts new one
+ *
+ * @param   uint32_t sector
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Stream_Write (uint32_t sector, uint8_t * buffer)
+{
+  if ((sector != FAT32_Stream) || FAT32_Stream_Read) {
+    FAT32_Stream_Stop ();
+    if (SD_SUCCESS != SD_Write_Start (sector)) {
+      return FAT32_ERROR;
+    }
+    FAT32_Stream_Read = 0;
+  }
+  if (sector == FAT32_Cache_Sector) {
+    FAT32_Cache_Sector = 0xFFFFFFFF;                                          // cached copy outdated
+  }
+#ifdef FAT32_JOURNAL
+  if (sector == FAT32_Data_Sector) {
+    FAT32_Data_Sector = 0xFFFFFFFF;
+  }
+#endif
+  if (SD_SUCCESS != SD_Write_Next (buffer)) {
+    FAT32_Stream = 0;
+    SD_Write_Stop ();
+    return FAT32_ERROR;
+  }
+  FAT32_Stream = sector + 1;
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Read Run Of Sectors By One Multiple Block Read
+ * @note    straight into caller buffer, bypass cache
+ *
+ * @param   uint32_t first sector
+ * @param   uint8_t * buffer
+ * @param   uint16_t number of sectors
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Read_Run (uint32_t sector, uint8_t * buffer, uint16_t count)
+{
+  uint8_t response = FAT32_SUCCESS;
+
+  FAT32_Stream_Stop ();
+  if (SD_SUCCESS != SD_Read_Start (sector)) {
+    return FAT32_ERROR;
+  }
+  while (count--) {
+    if (SD_START_TOKEN != SD_Read_Next (buffer)) {
+      response = FAT32_ERROR;
+      break;
+    }
+    buffer += BYTES_PER_SECTOR;
+  }
+  if (SD_SUCCESS != SD_Read_Stop ()) {
+    response = FAT32_ERROR;
+  }
+
+  return response;
+}
+
+#ifdef FAT32_JOURNAL
+/**
+ * @brief   Sector Of Commit In Journal Ring
+ *
+ * @param   uint32_t commit number
+ *
+ * @return  uint32_t
+ */
+static inline uint32_t FAT32_Journal_Slot (uint32_t sequence)
+{
+  return FAT32_Journal_First + 1 + (sequence % (FAT32_Journal_Sectors - 1));
+}
+
+/**
+ * @brief   Checksum Of Journal Record
+ * @note    computed with checksum field zeroed
+ *
+ * @param   uint8_t intents
+ *
+ * @return  uint32_t
+ */
+static uint32_t FAT32_Journal_Checksum (uint8_t intents)
+{
+  uint32_t sum = 0;
+  uint16_t length = sizeof (FAT32_Journal_t) + intents * sizeof (FAT32_Intent_t);
+
+  FAT32_Put_4Bytes_LE (((FAT32_Journal_t *) FAT32_Journal_Record)->Checksum, 0);
+  for (uint16_t i = 0; i < length; i++) {
+    sum = ((sum << 1) | (sum >> 31)) + FAT32_Journal_Record[i];               // rotate & add
+  }
+
+  return sum;
+}
+
+/**
+ * @brief   Write Journal Record
+ * @note    header sector holds checkpoint and no intents, rest of sector zeroed
+ *
+ * @param   uint32_t sector
+ * @param   uint32_t commit number / checkpoint
+ * @param   uint8_t number of intents
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Journal_Write (uint32_t sector, uint32_t sequence, uint8_t intents)
+{
+  FAT32_Journal_t * Journal = (FAT32_Journal_t *) FAT32_Journal_Record;
+
+  memcpy (Journal->Signature, FAT32_JOURNAL_SIGNATURE, 4);
+  FAT32_Put_4Bytes_LE (Journal->Sequence, sequence);
+  FAT32_Put_2Bytes_LE (Journal->Intents, intents);
+  FAT32_Put_2Bytes_LE (Journal->Reserved, 0);
+  FAT32_Put_4Bytes_LE (Journal->Checksum, FAT32_Journal_Checksum (intents));
+
+  return FAT32_Write_Part (sector, FAT32_Journal_Record, sizeof (FAT32_Journal_t) + intents * sizeof (FAT32_Intent_t));
+}
+
+/**
+ * @brief   Write Dirty FAT Sector Into All FAT Copies
+ * @note    intents of sector committed before; failed write is redone by replay
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Cache_Writeback (void)
+{
+  uint8_t i;
+
+  if (!FAT32_Cache_Dirty) {
+    return FAT32_SUCCESS;
+  }
+  FAT32_Cache_Dirty = 0;
+  for (i = 0; i < FAT32_NUM_OF_FATS; i++) {
+    if (FAT32_ERROR == FAT32_Write_Sector (FAT32_Cache_Sector + i * FAT32_Cache_Mirror, FAT32_Cache)) {
+      return FAT32_ERROR;
+    }
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Commit Collected Intents - one journal sector write
+ * @note    full ring is checkpointed: dirty FAT sector written, older commits dropped
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Journal_Commit (void)
+{
+  if (FAT32_Intents_Count == 0) {
+    return FAT32_SUCCESS;
+  }
+  if (FAT32_ERROR == FAT32_Journal_Write (FAT32_Journal_Slot (FAT32_Journal_Sequence + 1),
+                                          FAT32_Journal_Sequence + 1, FAT32_Intents_Count)) {
+    return FAT32_ERROR;
+  }
+  FAT32_Journal_Sequence++;
+  FAT32_Intents_Count = 0;
+
+  // Ring Full - next commit would overwrite commit not applied yet
+  // ----------------------------------------------------------------
+  if ((FAT32_Journal_Sequence - FAT32_Journal_Checkpoint) == (FAT32_Journal_Sectors - 1)) {
+    if ((FAT32_ERROR == FAT32_Cache_Writeback ()) ||
+        (FAT32_ERROR == FAT32_Journal_Write (FAT32_Journal_First, FAT32_Journal_Sequence, 0))) {
+      return FAT32_ERROR;
+    }
+    FAT32_Journal_Checkpoint = FAT32_Journal_Sequence;
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Collect Intent
+ * @note    FAT entries linking run of clusters (run chained, cluster appended
+ *          to chain) extend last intent, so sequential writes take few intents
+ *
+ * @param   uint8_t type
+ * @param   uint8_t slot of directory entry
+ * @param   uint32_t target - cluster / sector of directory entry
+ * @param   uint32_t count - clusters / file size
+ * @param   uint32_t value - link of last cluster / first cluster
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Journal_Intent (uint8_t type, uint8_t slot, uint32_t target, uint32_t count, uint32_t value)
+{
+  FAT32_Intent_t * Last;
+  uint32_t end;
+
+  if (FAT32_Journal_First == 0) {
+    return FAT32_SUCCESS;                                                     // no journal, written through
+  }
+  if ((type == FAT32_INTENT_FAT) && FAT32_Intents_Count) {
+    Last = &FAT32_Intents[FAT32_Intents_Count - 1];
+    end = FAT32_Get_4Bytes_LE (Last->Target) + FAT32_Get_4Bytes_LE (Last->Count);
+    // Chained Run - link (cluster, cluster + 1) behind run ending by link to cluster
+    if ((Last->Type == FAT32_INTENT_FAT) && (target == end) && (FAT32_Get_4Bytes_LE (Last->Value) == target)) {
+      FAT32_Put_4Bytes_LE (Last->Count, FAT32_Get_4Bytes_LE (Last->Count) + 1);
+      FAT32_Put_4Bytes_LE (Last->Value, value);
+      return FAT32_SUCCESS;
+    }
+    // Appended Cluster - end mark of new cluster, then link (previous, new)
+    if ((value == (target + 1)) && (Last->Type == FAT32_INTENT_FAT) &&
+        (FAT32_Get_4Bytes_LE (Last->Target) == value) && (FAT32_Get_4Bytes_LE (Last->Count) == 1)) {
+      if ((FAT32_Intents_Count > 1) && ((Last - 1)->Type == FAT32_INTENT_FAT) &&       // run before ends by previous
+          ((FAT32_Get_4Bytes_LE ((Last - 1)->Target) + FAT32_Get_4Bytes_LE ((Last - 1)->Count)) == value)) {
+        FAT32_Put_4Bytes_LE ((Last - 1)->Count, FAT32_Get_4Bytes_LE ((Last - 1)->Count) + 1);
+        memcpy ((Last - 1)->Value, Last->Value, 4);
+        FAT32_Intents_Count--;
+      } else {
+        FAT32_Put_4Bytes_LE (Last->Target, target);                           // run of previous and new
+        FAT32_Put_4Bytes_LE (Last->Count, 2);
+      }
+      return FAT32_SUCCESS;
+    }
+  }
+  if ((FAT32_Intents_Count == FAT32_JOURNAL_INTENTS) && (FAT32_ERROR == FAT32_Journal_Commit ())) {
+    return FAT32_ERROR;
+  }
+  Last = &FAT32_Intents[FAT32_Intents_Count++];
+  Last->Type = type;
+  Last->Slot = slot;
+  FAT32_Put_2Bytes_LE (Last->Reserved, 0);
+  FAT32_Put_4Bytes_LE (Last->Target, target);
+  FAT32_Put_4Bytes_LE (Last->Count, count);
+  FAT32_Put_4Bytes_LE (Last->Value, value);
+
+  return FAT32_SUCCESS;
+}
+#endif
+
+/**
+ * @brief   Clean Sector Cache Before Its Content Is Replaced
+ * @note    dirty FAT sector: intents committed, then sector written
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Cache_Clean (void)
+{
+#ifdef FAT32_JOURNAL
+  if (FAT32_Cache_Dirty) {
+    if ((FAT32_ERROR == FAT32_Journal_Commit ()) || (FAT32_ERROR == FAT32_Cache_Writeback ())) {
+      return FAT32_ERROR;
+    }
+  }
+#endif
+
+  return FAT32_SUCCESS;
+}
+
+#ifdef FAT32_JOURNAL
+/**
+ * @brief   Data Sector Modified Beside Held FAT Sector
+ * @note    while dirty FAT sector is held in cache, partial data sectors are
+ *          read or blanked in pool buffer, so FAT sector is not evicted (and
+ *          committed and written back) for every new cluster
+ *
+ * @param   uint32_t sector
+ * @param   uint8_t 1 - zeroed, 0 - read from card
+ *
+ * @return  uint8_t * NULL = no FAT sector held or no free buffer, use cache
+ */
+static uint8_t * FAT32_Data_Read (uint32_t sector, uint8_t blank)
+{
+  if (!FAT32_Cache_Dirty) {
+    return NULL;
+  }
+  if ((FAT32_Data_Buffer == NULL) && (NULL == (FAT32_Data_Buffer = POOL_Borrow (POOL_OWNER_WRITE)))) {
+    return NULL;
+  }
+  if (blank) {
+    memset (FAT32_Data_Buffer, 0, BYTES_PER_SECTOR);
+  } else if (sector != FAT32_Data_Sector) {
+    FAT32_Stream_Stop ();
+    if (SD_START_TOKEN != SD_Read_Block (sector, FAT32_Data_Buffer)) {
+      FAT32_Data_Sector = 0xFFFFFFFF;
+      return NULL;
+    }
+  }
+  FAT32_Data_Sector = sector;                                                 // valid once written
+
+  return FAT32_Data_Buffer;
+}
+
+/**
+ * @brief   Return Data Buffer To Pool
+ * @note    content is copy of card, nothing written
+ *
+ * @param   void
+ *
+ * @return  void
+ */
+static void FAT32_Data_Release (void)
+{
+  if (FAT32_Data_Buffer != NULL) {
+    POOL_Return (FAT32_Data_Buffer, POOL_OWNER_WRITE);
+    FAT32_Data_Buffer = NULL;
+  }
+  FAT32_Data_Sector = 0xFFFFFFFF;
+}
+#endif
+
+#ifdef FAT32_FREEMAP
+/**
+ * @brief   Init Free Cluster Map - nothing known yet
+ * @note    regions grow with FAT size so the map always covers whole FAT
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  void
+ */
+static void FAT32_Freemap_Init (FAT32_t * FAT32)
+{
+  FAT32_Freemap_Shift = 0;
+  while (((FAT32->sectors_per_fat + (1UL << FAT32_Freemap_Shift) - 1) >> FAT32_Freemap_Shift) > (FAT32_FREEMAP_BYTES << 3)) {
+    FAT32_Freemap_Shift++;
+  }
+  FAT32_Freemap_Shift += FAT32->fat_shift;                                    // entries per region
+  memset (FAT32_Freemap, 0, FAT32_FREEMAP_BYTES);
+  FAT32_Freemap_Summary = 0;
+}
+
+/**
+ * @brief   Region Of Free Cluster Map Holding FAT Entry Of Cluster
+ *
+ * @param   uint32_t cluster
+ *
+ * @return  uint16_t
+ */
+static inline uint16_t FAT32_Freemap_Region (uint32_t cluster)
+{
+  return cluster >> FAT32_Freemap_Shift;
+}
+
+/**
+ * @brief   Mark Region Full / Not Full, Keep Summary Current
+ *
+ * @param   uint16_t region
+ * @param   uint8_t 1 - full, 0 - has free entries
+ *
+ * @return  void
+ */
+static void FAT32_Freemap_Mark (uint16_t region, uint8_t full)
+{
+  uint8_t byte = region >> 3;
+
+  if (full) {
+    FAT32_Freemap[byte] |= (1 << (region & 7));
+  } else {
+    FAT32_Freemap[byte] &= ~(1 << (region & 7));
+  }
+  if (FAT32_Freemap[byte] == 0xFF) {
+    FAT32_Freemap_Summary |= (1UL << byte);
+  } else {
+    FAT32_Freemap_Summary &= ~(1UL << byte);
+  }
+}
+
+/**
+ * @brief   First Cluster Behind Full Regions
+ * @note    whole map bytes are skipped through summary, FAT sectors are not read
+ *
+ * @param   uint32_t cluster
+ *
+ * @return  uint32_t cluster, unchanged if its region is not known full
+ */
+static uint32_t FAT32_Freemap_Skip (uint32_t cluster)
+{
+  uint16_t region = FAT32_Freemap_Region (cluster);
+
+  while (region < (FAT32_FREEMAP_BYTES << 3)) {
+    if (FAT32_Freemap_Summary & (1UL << (region >> 3))) {
+      region = (region | 7) + 1;                                              // 8 full regions
+    } else if (FAT32_Freemap[region >> 3] & (1 << (region & 7))) {
+      region++;
+    } else {
+      break;
+    }
+  }
+  if (region == FAT32_Freemap_Region (cluster)) {
+    return cluster;
+  }
+
+  return (uint32_t) region << FAT32_Freemap_Shift;
+}
+#endif
+
+/**
+ * @brief   Read Next Cluster From FAT12 / FAT16
+ * @note    kept out of FAT32 path; value widened to FAT32 meaning, FAT12 entry
+ *          crossing sector boundary takes second sector
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t cluster
+ *
+ * @return  uint32_t
+ */
+static uint32_t FAT32_FAT_Next_Cluster_12_16 (FAT32_t * FAT32, uint32_t cluster)
+{
+  uint8_t * buffer;
+  uint16_t next;
+  uint32_t offset;
+
+  if (cluster < FAT32_CLUSTER_FIRST) {
+    return FAT32_CLUSTER_MASK;                                                // fixed root has no chain
+  }
+  if (FAT32->type == FAT32_TYPE_16) {
+    if (NULL == (buffer = FAT32_Read_Sector (FAT32->fat_area_begin + (cluster >> 8)))) {
+      return FAT32_CLUSTER_MASK;
+    }
+    next = FAT32_Get_2Bytes_LE (&buffer[(cluster << 1) % BYTES_PER_SECTOR]);
+    return (next >= 0xFFF7) ? (0x0FFF0000 | next) : next;
+  }
+  offset = cluster + (cluster >> 1);                                          // 1.5 bytes per entry
+  if (NULL == (buffer = FAT32_Read_Sector (FAT32->fat_area_begin + offset / BYTES_PER_SECTOR))) {
+    return FAT32_CLUSTER_MASK;
+  }
+  next = buffer[offset % BYTES_PER_SECTOR];
+  if (((offset + 1) % BYTES_PER_SECTOR) == 0) {
+    if (NULL == (buffer = FAT32_Read_Sector (FAT32->fat_area_begin + offset / BYTES_PER_SECTOR + 1))) {
+      return FAT32_CLUSTER_MASK;
+    }
+  }
+  next |= (uint16_t) buffer[(offset + 1) % BYTES_PER_SECTOR] << 8;
+  next = (cluster & 1) ? (next >> 4) : (next & 0x0FFF);
+
+  return (next >= 0x0FF7) ? (0x0FFFF000 | next) : next;
+}
+
+/**
+ * @brief   Set FAT Entry In Cached FAT Sector
+ * @note    reserved upper nibble is kept, sector must be written by FAT32_FAT_Write
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t cluster
+ * @param   uint32_t value
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_FAT_Set (FAT32_t * FAT32, uint32_t cluster, uint32_t value)
+{
+  uint8_t * buffer;
+
+  if (FAT32->type == FAT32_TYPE_12) {
+    return FAT32_ERROR;                                                       // FAT12 read only
+  }
+  if (NULL == (buffer = FAT32_Read_Sector (FAT32->fat_area_begin + (cluster >> FAT32->fat_shift)))) {
+    return FAT32_ERROR;
+  }
+#ifdef FAT32_JOURNAL
+  if (FAT32_ERROR == FAT32_Journal_Intent (FAT32_INTENT_FAT, 0, cluster, 1, value)) {
+    return FAT32_ERROR;
+  }
+  FAT32_Cache_Dirty = (FAT32_Journal_First != 0);                             // written back when evicted
+#endif
+  if (FAT32->type == FAT32_TYPE_16) {
+    FAT32_Put_2Bytes_LE (&buffer[(cluster << 1) % BYTES_PER_SECTOR], value & 0xFFFF);
+  } else {
+    value = (value & FAT32_CLUSTER_MASK) | (FAT32_Get_4Bytes_LE (&buffer[(cluster << 2) % BYTES_PER_SECTOR]) & ~FAT32_CLUSTER_MASK);
+    FAT32_Put_4Bytes_LE (&buffer[(cluster << 2) % BYTES_PER_SECTOR], value);
+  }
+#ifdef FAT32_FREEMAP
+  if ((value & FAT32_CLUSTER_MASK) == FAT32_CLUSTER_FREE) {
+    FAT32_Freemap_Mark (FAT32_Freemap_Region (cluster), 0);                   // region has free entry again
+  }
+#endif
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Write Cached FAT Sector Into All FAT Copies
+ * @note    with journal sector stays dirty in cache until evicted
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t cluster with entry in sector
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_FAT_Write (FAT32_t * FAT32, uint32_t cluster)
+{
+  uint8_t i;
+  uint8_t * buffer;
+  uint32_t sector = FAT32->fat_area_begin + (cluster >> FAT32->fat_shift);
+
+#ifdef FAT32_JOURNAL
+  if (FAT32_Journal_First) {
+    return FAT32_SUCCESS;                                                     // dirty in cache, intents protect it
+  }
+#endif
+  if (NULL == (buffer = FAT32_Read_Sector (sector))) {
+    return FAT32_ERROR;
+  }
+  for (i = 0; i < FAT32_NUM_OF_FATS; i++) {
+    if (FAT32_ERROR == FAT32_Write_Sector (sector + i * FAT32->sectors_per_fat, buffer)) {
+      return FAT32_ERROR;
+    }
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Find Run Of Free Clusters
+ * @note    search continues from next free hint, so cost per cluster stays constant
+ *          while card fills; regions known full are skipped without reading and
+ *          regions scanned end to end without free entry are marked full
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t number of contiguous free clusters
+ *
+ * @return  uint32_t first cluster of run, 0 = no such run
+ */
+static uint32_t FAT32_Cluster_Find (FAT32_t * FAT32, uint32_t length)
+{
+  uint32_t run = 0;                                                           // free clusters in a row
+  uint32_t count = FAT32->clusters + length - 1;
+  uint32_t cluster = FAT32->next_free;
+  uint32_t end = FAT32->clusters + FAT32_CLUSTER_FIRST;
+#ifdef FAT32_FREEMAP
+  uint32_t next;
+  uint16_t whole = 0xFFFF;                                                    // region examined from its start
+#endif
+
+  if (FAT32->type == FAT32_TYPE_12) {
+    return 0;                                                                 // FAT12 read only
+  }
+  while (count--) {
+    if ((cluster < FAT32_CLUSTER_FIRST) || (cluster >= end)) {
+      cluster = FAT32_CLUSTER_FIRST;                                          // wrap around
+      run = 0;
+    }
+#ifdef FAT32_FREEMAP
+    if ((next = FAT32_Freemap_Skip (cluster)) != cluster) {
+      count = ((next - cluster - 1) < count) ? (count - (next - cluster - 1)) : 0;
+      cluster = next;
+      run = 0;
+      continue;
+    }
+    if ((cluster == FAT32_CLUSTER_FIRST) || ((cluster & ((1UL << FAT32_Freemap_Shift) - 1)) == 0)) {
+      whole = FAT32_Freemap_Region (cluster);
+    }
+#endif
+    if ((FAT32_FAT_Next_Cluster (FAT32, cluster) & FAT32_CLUSTER_MASK) == FAT32_CLUSTER_FREE) {
+      if (++run == length) {
+        return cluster - length + 1;
+      }
+#ifdef FAT32_FREEMAP
+      whole = 0xFFFF;                                                         // region has free entry
+#endif
+    } else {
+      run = 0;
+    }
+    cluster++;
+#ifdef FAT32_FREEMAP
+    if ((((cluster & ((1UL << FAT32_Freemap_Shift) - 1)) == 0) || (cluster == end)) &&
+        (whole == FAT32_Freemap_Region (cluster - 1))) {
+      FAT32_Freemap_Mark (whole, 1);                                          // whole region without free entry
+    }
+#endif
+  }
+
+  return 0;
+}
+
+/**
+ * @brief   Account Clusters Taken From Free Space
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t first cluster
+ * @param   uint32_t number of clusters
+ *
+ * @return  void
+ */
+static void FAT32_Cluster_Used (FAT32_t * FAT32, uint32_t cluster, uint32_t count)
+{
+  FAT32->next_free = cluster + count;
+  if (FAT32->free_count != FAT32_FSI_UNKNOWN) {
+    FAT32->free_count -= count;
+  } else if (FAT32->recount > cluster) {                                      // already counted as free
+    FAT32->recount_free -= ((FAT32->recount - cluster) < count) ? (FAT32->recount - cluster) : count;
+  }
+}
+
+/**
+ * @brief   Account Cluster Returned To Free Space
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t cluster
+ *
+ * @return  void
+ */
+static void FAT32_Cluster_Free (FAT32_t * FAT32, uint32_t cluster)
+{
+  if (FAT32->free_count != FAT32_FSI_UNKNOWN) {
+    FAT32->free_count++;
+  } else if (FAT32->recount > cluster) {                                      // already counted as used
+    FAT32->recount_free++;
+  }
+}
+
+/**
+ * @brief   Chain Run Of Free Clusters
+ * @note    every FAT sector written once, run is not linked to any file
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t first cluster
+ * @param   uint32_t number of clusters
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Cluster_Chain (FAT32_t * FAT32, uint32_t first, uint32_t clusters)
+{
+  uint32_t next;
+  uint32_t cluster;
+
+  for (cluster = first; cluster < (first + clusters); cluster++) {
+    next = ((cluster + 1) < (first + clusters)) ? (cluster + 1) : FAT32_CLUSTER_MASK;
+    if (FAT32_ERROR == FAT32_FAT_Set (FAT32, cluster, next)) {
+      return FAT32_ERROR;
+    }
+    if ((((cluster + 1) & ((1UL << FAT32->fat_shift) - 1)) == 0) || (next == FAT32_CLUSTER_MASK)) {
+      if (FAT32_ERROR == FAT32_FAT_Write (FAT32, cluster)) {
+        return FAT32_ERROR;
+      }
+    }
+  }
+  FAT32_Cluster_Used (FAT32, first, clusters);
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Free Cluster Chain
+ * @note    each FAT sector written once it is left
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t first cluster of chain
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Chain_Free (FAT32_t * FAT32, uint32_t cluster)
+{
+  uint32_t next;
+
+  while ((cluster >= FAT32_CLUSTER_FIRST) && (cluster < FAT32_CLUSTER_EOC)) {
+    next = FAT32_FAT_Next_Cluster (FAT32, cluster) & FAT32_CLUSTER_MASK;
+    if (FAT32_ERROR == FAT32_FAT_Set (FAT32, cluster, FAT32_CLUSTER_FREE)) {
+      return FAT32_ERROR;
+    }
+    if (((next >> FAT32->fat_shift) != (cluster >> FAT32->fat_shift)) ||
+        (next < FAT32_CLUSTER_FIRST) || (next >= FAT32_CLUSTER_EOC)) {
+      if (FAT32_ERROR == FAT32_FAT_Write (FAT32, cluster)) {
+        return FAT32_ERROR;
+      }
+    }
+    FAT32_Cluster_Free (FAT32, cluster);
+    cluster = next;
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Allocate Free Cluster Behind Previous Cluster
+ * @note    new cluster is marked end of chain before it is linked
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t previous cluster of chain, 0 = new chain
+ *
+ * @return  uint32_t cluster, 0 = no free cluster
+ */
+static uint32_t FAT32_Cluster_Alloc (FAT32_t * FAT32, uint32_t previous)
+{
+  uint32_t cluster;
+
+  if (0 == (cluster = FAT32_Cluster_Find (FAT32, 1))) {
+    return 0;
+  }
+  // End Of Chain, then Link - same FAT sector written once
+  // ----------------------------------------------------------------
+  if (FAT32_ERROR == FAT32_FAT_Set (FAT32, cluster, FAT32_CLUSTER_MASK)) {
+    return 0;
+  }
+  if (previous && ((previous >> FAT32->fat_shift) == (cluster >> FAT32->fat_shift))) {
+    if (FAT32_ERROR == FAT32_FAT_Set (FAT32, previous, cluster)) {
+      return 0;
+    }
+    previous = 0;
+  }
+  if (FAT32_ERROR == FAT32_FAT_Write (FAT32, cluster)) {
+    return 0;
+  }
+  if (previous && ((FAT32_ERROR == FAT32_FAT_Set (FAT32, previous, cluster)) ||
+                   (FAT32_ERROR == FAT32_FAT_Write (FAT32, previous)))) {
+    return 0;
+  }
+  FAT32_Cluster_Used (FAT32, cluster, 1);
+
+  return cluster;
+}
+
+/**
+ * @brief   Store Free Count And Next Free Hint Into FSInfo Sector
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_FSInfo_Update (FAT32_t * FAT32)
+{
+  uint8_t * buffer;
+  FSI_t * FSI;
+
+  if (FAT32->fsinfo_sector == 0) {
+    return FAT32_SUCCESS;
+  }
+  if (NULL == (buffer = FAT32_Read_Sector (FAT32->fsinfo_sector))) {
+    return FAT32_ERROR;
+  }
+  FSI = (FSI_t *) buffer;
+  if ((FAT32_Get_4Bytes_LE (FSI->LeadSignature) != FAT32_FSI_LEAD_SIGNATURE) ||
+      (FAT32_Get_4Bytes_LE (FSI->StrucSignature) != FAT32_FSI_STRUC_SIGNATURE)) {
+    return FAT32_ERROR;                                                       // not FSInfo, keep untouched
+  }
+  if ((FAT32_Get_4Bytes_LE (FSI->NextFree) == FAT32->next_free) &&
+      (FAT32_Get_4Bytes_LE (FSI->FreeCount) == FAT32->free_count)) {
+    return FAT32_SUCCESS;
+  }
+  FAT32_Put_4Bytes_LE (FSI->NextFree, FAT32->next_free);
+  FAT32_Put_4Bytes_LE (FSI->FreeCount, FAT32->free_count);                   // unknown stays 0xFFFFFFFF
+
+  return FAT32_Write_Sector (FAT32->fsinfo_sector, buffer);
+}
+
+/**
+ * @brief   Load Free Count And Next Free Hint From FSInfo Sector
+ * @note    unknown free count is recounted in background
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  void
+ */
+static void FAT32_FSInfo_Load (FAT32_t * FAT32)
+{
+  uint8_t * buffer;
+
+  FAT32->next_free = FAT32_CLUSTER_FIRST;
+  FAT32->free_count = FAT32_FSI_UNKNOWN;
+  if (FAT32->fsinfo_sector && (NULL != (buffer = FAT32_Read_Sector (FAT32->fsinfo_sector)))) {
+    FSI_t * FSI = (FSI_t *) buffer;
+    if ((FAT32_Get_4Bytes_LE (FSI->LeadSignature) == FAT32_FSI_LEAD_SIGNATURE) &&
+        (FAT32_Get_4Bytes_LE (FSI->StrucSignature) == FAT32_FSI_STRUC_SIGNATURE) &&
+        (FAT32_Get_4Bytes_LE (FSI->TrailSignature) == FAT32_FSI_TRAIL_SIGNATURE)) {
+      if ((FAT32_Get_4Bytes_LE (FSI->NextFree) >= FAT32_CLUSTER_FIRST) &&
+          (FAT32_Get_4Bytes_LE (FSI->NextFree) < (FAT32->clusters + FAT32_CLUSTER_FIRST))) {
+        FAT32->next_free = FAT32_Get_4Bytes_LE (FSI->NextFree);
+      }
+      if (FAT32_Get_4Bytes_LE (FSI->FreeCount) <= FAT32->clusters) {          // 0xFFFFFFFF or garbage => recount
+        FAT32->free_count = FAT32_Get_4Bytes_LE (FSI->FreeCount);
+      }
+    }
+  }
+  FAT32->recount = (FAT32->free_count == FAT32_FSI_UNKNOWN) ? FAT32_CLUSTER_FIRST : 0;
+  FAT32->recount_free = 0;
+#ifdef FAT32_FREEMAP
+  FAT32_Freemap_Init (FAT32);
+#endif
+}
+
+#ifdef FAT32_JOURNAL
+/**
+ * @brief   Load Journal Record Into Record Buffer
+ *
+ * @param   uint32_t sector
+ *
+ * @return  uint8_t FAT32_ERROR if unreadable, not journal record or checksum fails
+ */
+static uint8_t FAT32_Journal_Load (uint32_t sector)
+{
+  uint8_t * buffer;
+  uint32_t checksum;
+  FAT32_Journal_t * Journal = (FAT32_Journal_t *) FAT32_Journal_Record;
+
+  if (NULL == (buffer = FAT32_Read_Sector (sector))) {
+    return FAT32_ERROR;
+  }
+  memcpy (FAT32_Journal_Record, buffer, sizeof (FAT32_Journal_Record));
+  checksum = FAT32_Get_4Bytes_LE (Journal->Checksum);
+  if ((memcmp (Journal->Signature, FAT32_JOURNAL_SIGNATURE, 4) != 0) ||
+      (FAT32_Get_2Bytes_LE (Journal->Intents) > FAT32_JOURNAL_INTENTS) ||
+      (checksum != FAT32_Journal_Checksum (FAT32_Get_2Bytes_LE (Journal->Intents)))) {
+    return FAT32_ERROR;
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Apply Intents Of Loaded Journal Record
+ * @note    intents set absolute values, so applying twice is harmless
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Journal_Apply (FAT32_t * FAT32)
+{
+  DE_t * DE;
+  uint8_t i;
+  uint8_t * buffer;
+  uint32_t cluster;
+  uint32_t last;
+  FAT32_Intent_t * Intent;
+
+  for (i = 0; i < FAT32_Get_2Bytes_LE (((FAT32_Journal_t *) FAT32_Journal_Record)->Intents); i++) {
+    Intent = &FAT32_Intents[i];
+    cluster = FAT32_Get_4Bytes_LE (Intent->Target);
+    last = cluster + FAT32_Get_4Bytes_LE (Intent->Count) - 1;
+    // FAT Run - clusters chained, last one set to value
+    // --------------------------------------------------------------
+    if (Intent->Type == FAT32_INTENT_FAT) {
+      if ((cluster < FAT32_CLUSTER_FIRST) || (last < cluster) || (last >= (FAT32->clusters + FAT32_CLUSTER_FIRST))) {
+        return FAT32_ERROR;
+      }
+      for (; cluster <= last; cluster++) {
+        if (FAT32_ERROR == FAT32_FAT_Set (FAT32, cluster, (cluster == last) ? FAT32_Get_4Bytes_LE (Intent->Value) : (cluster + 1))) {
+          return FAT32_ERROR;
+        }
+        if (((cluster == last) || (((cluster + 1) >> FAT32->fat_shift) != (cluster >> FAT32->fat_shift))) &&
+            (FAT32_ERROR == FAT32_FAT_Write (FAT32, cluster))) {
+          return FAT32_ERROR;
+        }
+      }
+    // Directory Entry - first cluster and size
+    // --------------------------------------------------------------
+    } else if ((Intent->Type == FAT32_INTENT_ENTRY) && (Intent->Slot < (BYTES_PER_SECTOR >> 5))) {
+      if (NULL == (buffer = FAT32_Read_Sector (cluster))) {
+        return FAT32_ERROR;
+      }
+      DE = (DE_t *) &buffer[Intent->Slot << 5];
+      memcpy (DE->FirstClustHI, &Intent->Value[2], 2);
+      memcpy (DE->FirstClustLO, &Intent->Value[0], 2);
+      memcpy (DE->FileSize, Intent->Count, 4);
+      if (FAT32_ERROR == FAT32_Write_Sector (cluster, buffer)) {
+        return FAT32_ERROR;
+      }
+    } else {
+      return FAT32_ERROR;
+    }
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Open Journal File, Replay Commits Behind Checkpoint
+ * @note    journal is contiguous file SDJOURNL among first root entries, at least
+ *          3 sectors; without it metadata is written through as before
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint8_t FAT32_ERROR if no journal
+ */
+static uint8_t FAT32_Journal_Open (FAT32_t * FAT32)
+{
+  DE_t * DE;
+  uint8_t i;
+  uint8_t slot;
+  uint8_t * buffer;
+  uint32_t sector = FAT32_Get_1st_Sector_Of_Clus (FAT32, FAT32->root_dir_clus_num);
+  uint32_t first = 0;
+  uint32_t size = 0;
+  uint32_t cluster;
+  uint32_t next;
+  uint32_t sequence;
+  uint8_t header;
+  FAT32_Journal_t * Journal = (FAT32_Journal_t *) FAT32_Journal_Record;
+
+  FAT32_Journal_First = 0;
+  FAT32_Intents_Count = 0;
+  if (FAT32->type == FAT32_TYPE_12) {
+    return FAT32_ERROR;                                                       // read only
+  }
+
+  // Find Journal File In First Directory Sectors
+  // ----------------------------------------------------------------
+  for (i = 0; (i < FAT32_SDINDEX_HEAD_SECTORS) && (i < FAT32_Cluster_Sectors (FAT32, FAT32->root_dir_clus_num)) && !first; i++) {
+    if (NULL == (buffer = FAT32_Read_Sector (sector + i))) {
+      return FAT32_ERROR;
+    }
+    for (slot = 0; slot < (BYTES_PER_SECTOR >> 5); slot++) {
+      DE = (DE_t *) &buffer[slot << 5];
+      if (DE->Name[0] == FAT32_DE_END) {
+        break;
+      }
+      if ((memcmp (DE->Name, FAT32_JOURNAL_NAME, 11) == 0) &&
+          !(DE->Attribute & (FAT32_ATTR_DIRECTORY | FAT32_ATTR_VOLUME_ID))) {
+        first = ((uint32_t) FAT32_Get_2Bytes_LE (DE->FirstClustHI) << 16) | FAT32_Get_2Bytes_LE (DE->FirstClustLO);
+        size = FAT32_Get_4Bytes_LE (DE->FileSize);
+        break;
+      }
+    }
+  }
+  if ((first < FAT32_CLUSTER_FIRST) || (size < (3 * BYTES_PER_SECTOR))) {
+    return FAT32_ERROR;
+  }
+
+  // Contiguous - commits written without FAT lookup
+  // ----------------------------------------------------------------
+  cluster = first;
+  while ((next = (FAT32_FAT_Next_Cluster (FAT32, cluster) & FAT32_CLUSTER_MASK)) == (cluster + 1)) {
+    cluster = next;
+  }
+  if ((next < FAT32_CLUSTER_EOC) ||
+      (((cluster - first + 1) << (BYTES_PER_SECTOR_SHIFT + FAT32->cluster_shift)) < size)) {
+    return FAT32_ERROR;
+  }
+  sector = FAT32_Get_1st_Sector_Of_Clus (FAT32, first);
+  FAT32_Journal_Sectors = size >> BYTES_PER_SECTOR_SHIFT;
+
+  // Checkpoint - unreadable header: latest commit found taken as applied,
+  // so commits of a lost header are never replayed over newer metadata
+  // ----------------------------------------------------------------
+  header = FAT32_Journal_Load (sector);
+  if (FAT32_SUCCESS == header) {
+    FAT32_Journal_Checkpoint = FAT32_Get_4Bytes_LE (Journal->Sequence);
+  } else {
+    FAT32_Journal_Checkpoint = 0;
+    for (cluster = 1; cluster < FAT32_Journal_Sectors; cluster++) {
+      if ((FAT32_SUCCESS == FAT32_Journal_Load (sector + cluster)) &&
+          ((int32_t) (FAT32_Get_4Bytes_LE (Journal->Sequence) - FAT32_Journal_Checkpoint) > 0)) {
+        FAT32_Journal_Checkpoint = FAT32_Get_4Bytes_LE (Journal->Sequence);
+      }
+    }
+  }
+
+  // Replay - consecutive commits behind checkpoint, written through
+  // ----------------------------------------------------------------
+  sequence = FAT32_Journal_Checkpoint;
+  while (((sequence - FAT32_Journal_Checkpoint) < (FAT32_Journal_Sectors - 1)) &&
+         (FAT32_SUCCESS == FAT32_Journal_Load (sector + 1 + ((sequence + 1) % (FAT32_Journal_Sectors - 1)))) &&
+         (FAT32_Get_4Bytes_LE (Journal->Sequence) == (sequence + 1))) {
+    if (FAT32_ERROR == FAT32_Journal_Apply (FAT32)) {
+      return FAT32_ERROR;                                                     // card error, journal stays off
+    }
+    sequence++;
+  }
+  if ((sequence != FAT32_Journal_Checkpoint) || (FAT32_ERROR == header)) {
+    FAT32->free_count = FAT32_FSI_UNKNOWN;                                    // counted again in background
+    FAT32->recount = FAT32_CLUSTER_FIRST;
+    FAT32->recount_free = 0;
+    FAT32_FSInfo_Update (FAT32);
+    if (FAT32_ERROR == FAT32_Journal_Write (sector, sequence, 0)) {
+      return FAT32_ERROR;
+    }
+  }
+  FAT32_Journal_Sequence = sequence;
+  FAT32_Journal_Checkpoint = sequence;
+  FAT32_Cache_Mirror = FAT32->sectors_per_fat;
+  FAT32_Journal_First = sector;
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Checkpoint Journal When No File Is Written
+ * @note    dirty FAT sector written, header moved behind last commit,
+ *          so next mount replays nothing
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Journal_Close (void)
+{
+  if ((FAT32_Journal_First == 0) || (FAT32_ERROR == FAT32_Cache_Clean ())) {
+    return FAT32_ERROR;
+  }
+  if (FAT32_Journal_Sequence != FAT32_Journal_Checkpoint) {
+    if (FAT32_ERROR == FAT32_Journal_Write (FAT32_Journal_First, FAT32_Journal_Sequence, 0)) {
+      return FAT32_ERROR;
+    }
+    FAT32_Journal_Checkpoint = FAT32_Journal_Sequence;
+  }
+
+  return FAT32_SUCCESS;
+}
+#endif
+
+/**
+ * @brief   Check Sector Is FAT Boot Sector
+ * @note    distinguishes boot sector of volume without MBR (superfloppy)
+ *          from MBR, both end with signature 0xAA55
+ *
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t 1 - boot sector, 0 - not
+ */
+static uint8_t FAT32_Boot_Sector_Valid (uint8_t * buffer)
+{
+  BS_t * BS = (BS_t *) buffer;
+
+  if ((BS->Jump[0] != 0xEB) && (BS->Jump[0] != 0xE9)) {                      // x86 jump opcode
+    return 0;
+  }
+  if ((FAT32_Get_2Bytes_LE (BS->Signature) != FAT32_SIGNATURE) ||
+      (FAT32_Get_2Bytes_LE (BS->BytesPerSector) != BYTES_PER_SECTOR) ||
+      (FAT32_Get_2Bytes_LE (BS->ReservedSectors) == 0)) {
+    return 0;
+  }
+  if ((BS->SectorsPerCluster == 0) || (BS->SectorsPerCluster & (BS->SectorsPerCluster - 1))) {
+    return 0;                                                                 // power of 2 only
+  }
+
+  return 1;
+}
+
+/**
+ * @brief   Check Partition Entry Holds FAT Volume
+ *
+ * @param   PE_t * partition entry
+ *
+ * @return  uint8_t 1 - FAT volume, 0 - not
+ */
+static uint8_t FAT32_Partition_Valid (PE_t * PE)
+{
+  if (PE->Status & PE_STATUS_ACTIVE_FLAG) {                                   // only 0x80 or 0x00 status accepted
+    return 0;
+  }
+  switch (PE->TypeCode) {
+    case PE_TYPECODE_FAT12:
+    case PE_TYPECODE_DOSFAT16:
+    case PE_TYPECODE_FAT16:
+    case PE_TYPECODE_FAT16LBA:
+    case PE_TYPECODE_FAT32:
+    case PE_TYPECODE_FAT32LBA:
+      break;
+    default:
+      return 0;
+  }
+
+  return FAT32_Get_4Bytes_LE (PE->LBA_Begin) != 0;
+}
+
+#ifdef FAT32_MOUNT_EEPROM
+/**
+ * @brief   Checksum Of Mount Cache Record
+ * @note    inverted, so erased or zeroed EEPROM never passes
+ *
+ * @param   FAT32_Mount_t * record
+ *
+ * @return  uint32_t
+ */
+static uint32_t FAT32_Mount_Checksum (FAT32_Mount_t * Mount)
+{
+  uint32_t sum = 0;
+  uint8_t * byte = (uint8_t *) Mount;
+
+  for (uint8_t i = 0; i < (sizeof (FAT32_Mount_t) - sizeof (Mount->check)); i++) {
+    sum = ((sum << 1) | (sum >> 31)) + byte[i];                               // rotate & add
+  }
+
+  return ~sum;
+}
+
+/**
+ * @brief   Volume Serial Number Of Boot Sector
+ * @note    extended boot record of FAT12/16 starts behind 16 bit fields
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t * boot sector
+ *
+ * @return  uint32_t
+ */
+static inline uint32_t FAT32_Volume_Serial (FAT32_t * FAT32, uint8_t * buffer)
+{
+  return FAT32_Get_4Bytes_LE (&buffer[(FAT32->type == FAT32_TYPE_32) ? FAT32_BS_SERIAL : FAT16_BS_SERIAL]);
+}
+
+/**
+ * @brief   Store Geometry Of Mounted Volume Into Mount Cache
+ * @note    location of index file kept while volume is the same;
+ *          EEPROM written only where bytes differ
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t * boot sector
+ *
+ * @return  void
+ */
+static void FAT32_Mount_Store (FAT32_t * FAT32, uint8_t * buffer)
+{
+  FAT32_Mount_t Mount;
+  uint32_t serial = FAT32_Volume_Serial (FAT32, buffer);
+  uint32_t checksum = FAT32_Checksum (buffer);
+
+  eeprom_read_block (&Mount, &FAT32_Mount, sizeof (FAT32_Mount_t));
+  if ((Mount.check != FAT32_Mount_Checksum (&Mount)) || (Mount.serial != serial) || (Mount.checksum != checksum)) {
+    Mount.index_cluster = 0;                                                  // other volume, index file searched
+    Mount.index_size = 0;
+    Mount.index_first = 0;
+  }
+  Mount.serial = serial;
+  Mount.checksum = checksum;
+  Mount.Volume = *FAT32;
+  Mount.Volume.next_free = 0;                                                 // state, not geometry
+  Mount.Volume.free_count = 0;
+  Mount.Volume.recount = 0;
+  Mount.Volume.recount_free = 0;
+  Mount.Volume.files = 0;
+  Mount.check = FAT32_Mount_Checksum (&Mount);
+  eeprom_update_block (&Mount, &FAT32_Mount, sizeof (FAT32_Mount_t));
+}
+
+/**
+ * @brief   Store Location Of Index File Into Mount Cache
+ *
+ * @param   uint32_t first cluster, 0 = no index file
+ * @param   uint32_t size
+ * @param   uint32_t 1st sector of contiguous file, 0 = fragmented
+ *
+ * @return  void
+ */
+static void FAT32_Mount_Index (uint32_t cluster, uint32_t size, uint32_t first)
+{
+  FAT32_Mount_t Mount;
+
+  eeprom_read_block (&Mount, &FAT32_Mount, sizeof (FAT32_Mount_t));
+  if (Mount.check != FAT32_Mount_Checksum (&Mount)) {
+    return;
+  }
+  Mount.index_cluster = cluster;
+  Mount.index_size = size;
+  Mount.index_first = first;
+  Mount.check = FAT32_Mount_Checksum (&Mount);
+  eeprom_update_block (&Mount, &FAT32_Mount, sizeof (FAT32_Mount_t));
+}
+
+/**
+ * @brief   Mount Volume Of Last Mount From Mount Cache
+ * @note    boot sector at stored address must still carry same serial
+ *          number and checksum, so mount takes 1 read instead of MBR walk
+ *          and boot sector decoding (FSInfo read as before)
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint8_t FAT32_ERROR if card not seen at last mount
+ */
+static uint8_t FAT32_Mount_Load (FAT32_t * FAT32)
+{
+  uint8_t * buffer;
+  FAT32_Mount_t Mount;
+
+  FAT32_Mount_Cached = 0;
+  eeprom_read_block (&Mount, &FAT32_Mount, sizeof (FAT32_Mount_t));
+  if (Mount.check != FAT32_Mount_Checksum (&Mount)) {
+    return FAT32_ERROR;
+  }
+  if (NULL == (buffer = FAT32_Read_Sector (Mount.Volume.lba_begin))) {
+    return FAT32_ERROR;
+  }
+  if ((FAT32_Volume_Serial (&Mount.Volume, buffer) != Mount.serial) ||
+      (FAT32_Checksum (buffer) != Mount.checksum)) {
+    return FAT32_ERROR;                                                       // other card or reformatted
+  }
+  *FAT32 = Mount.Volume;
+  FAT32_FSInfo_Load (FAT32);
+  FAT32_Mount_Cached = 1;
+
+  return FAT32_SUCCESS;
+}
+#endif
+
+/**
+ * @brief   Update Index Of Root Directory After Entry Of File Changed
+ * @note    RAM index entry and index file record are patched in place, fingerprint
+ *          of index file is refreshed; on failure index file is rebuilt at next mount
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
+ *
+ * @return  void
+ */
+static void FAT32_Index_Update (FAT32_t * FAT32, FAT32_File_t * File)
+{
+  uint8_t * buffer;
+  uint8_t name83[11];
+  uint8_t name[13];
+  uint16_t i;
+  uint16_t filenum = 0;
+  uint32_t sector;
+  FAT32_Index_t Entry;
+  FAT32_Record_t * Record;
+  FAT32_SDIndex_t Header;
+
+  // RAM Index
+  // ----------------------------------------------------------------
+  for (i = 0; i < FAT32_Index_Loaded; i++) {
+    FAT32_Index_Load (i, &Entry);
+    if ((Entry.sector == File->entry_sector) && (Entry.slot == File->entry_slot)) {
+      Entry.cluster = File->first_cluster;
+      Entry.size = File->size;
+      FAT32_Index_Store (i, &Entry);
+      break;
+    }
+  }
+  if (!FAT32_Index_Valid) {
+    return;
+  }
+
+  // Record Of File - found by short name
+  // ----------------------------------------------------------------
+  if (NULL == (buffer = FAT32_Read_Sector (File->entry_sector))) {
+    FAT32_Index_Valid = 0;
+    return;
+  }
+  memcpy (name83, ((DE_t *) &buffer[File->entry_slot << 5])->Name, 11);
+  FAT32_Short_Name (name83, name);
+  if (FAT32_Hash_Slots) {
+    filenum = FAT32_Hash_Find (FAT32, (char *) name, strlen ((char *) name), name83, &Entry);
+  } else {
+    for (filenum = FAT32->files; filenum; filenum--) {
+      if ((FAT32_SUCCESS == FAT32_Get_Index (FAT32, filenum, &Entry)) &&
+          (Entry.sector == File->entry_sector) && (Entry.slot == File->entry_slot)) {
+        break;
+      }
+    }
+  }
+  if ((filenum == 0) || (Entry.sector != File->entry_sector) || (Entry.slot != File->entry_slot)) {
+    return;                                                                   // not in root directory
+  }
+  if ((0 == (sector = FAT32_Index_Sector (FAT32, FAT32_Record_Position (filenum)))) ||
+      (NULL == (buffer = FAT32_Read_Sector (sector)))) {
+    FAT32_Index_Valid = 0;
+    return;
+  }
+  Record = (FAT32_Record_t *) &buffer[FAT32_Record_Position (filenum) % BYTES_PER_SECTOR];
+  FAT32_Put_4Bytes_LE (Record->Cluster, File->first_cluster);
+  FAT32_Put_4Bytes_LE (Record->Size, File->size);
+  if (FAT32_ERROR == FAT32_Write_Sector (sector, buffer)) {
+    FAT32_Index_Valid = 0;
+    return;
+  }
+
+  // Fingerprint - directory sector changed
+  // ----------------------------------------------------------------
+  if ((FAT32_ERROR == FAT32_Index_Read (FAT32, 0, (uint8_t *) &Header, sizeof (Header))) ||
+      (FAT32_ERROR == FAT32_Root_Fingerprint (FAT32, &Header, 0)) ||
+      (0 == (sector = FAT32_Index_Sector (FAT32, 0))) ||
+      (NULL == (buffer = FAT32_Read_Sector (sector)))) {
+    FAT32_Index_Valid = 0;
+    return;
+  }
+  Header.Sorted &= ~(1 << FAT32_SORT_SIZE);                                   // size changed
+  FAT32_Sort_Views = Header.Sorted;
+  memcpy (buffer, &Header, sizeof (Header));
+  if (FAT32_ERROR == FAT32_Write_Sector (sector, buffer)) {
+    FAT32_Index_Valid = 0;
+  }
+}
+
+/**
+ * @brief   FAT32 Init
+ *
+ * @param   FAT32_t * FAT32 structure
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Init (FAT32_t * FAT32)
+{
+  uint8_t status = FAT32_ERROR;
+
+  // SD Card Init
+  // -------------------------------------------------------------------------------------
+  SD sd = { .voltage = 0, .sdhc = 0, .version = 0 };
+  if (SD_Init (&sd) == SD_ERROR) {
+    return FAT32_ERROR;
+  }
+  FAT32_Stream = 0;
+#ifdef FAT32_JOURNAL
+  FAT32_Journal_First = 0;
+  FAT32_Cache_Dirty = 0;                                                      // not written onto other card
+#endif
+  FAT32_Cache_Invalidate ();                                                  // card may have been replaced
+
+  // Mount Cache - card of last mount recognized by its boot sector
+  // ----------------------------------------------------------------
+#ifdef FAT32_MOUNT_EEPROM
+  status = FAT32_Mount_Load (FAT32);
+#endif
+  if (FAT32_ERROR == status) {
+    // MBR - Read Master Boot Record
+    // ----------------------------------------------------------------
+    if (FAT32_ERROR == FAT32_Read_Master_Boot_Record (FAT32)) {
+      return FAT32_ERROR;
+    }
+    // BS - Read Boot Sector
+    // ----------------------------------------------------------------
+    if (FAT32_ERROR == FAT32_Read_Boot_Sector (FAT32)) {
+      FAT32_Volume_Begin = 0xFFFFFFFF;                                        // search again next time
+      return FAT32_ERROR;
+    }
+  }
+  // Directory Index - index file or one pass over root directory
+  // ----------------------------------------------------------------
+  memset (FAT32_Dircache, 0, sizeof (FAT32_Dircache));
+  FAT32_Scan.first_cluster = 0;
+#ifdef FAT32_JOURNAL
+  FAT32_Journal_Open (FAT32);                                                 // replay before anything reads FAT
+#endif
+  FAT32_Index_File (FAT32);
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Find Volume - Boot Sector At LBA 0 Or Partition Of MBR
+ * @note    sector 0 unchanged since last mount reuses found boot sector,
+ *          so mount takes 1 read without MBR and 2 reads with MBR;
+ *          extended partition chain is followed on first mount only
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Read_Master_Boot_Record (FAT32_t * FAT32)
+{
+  uint8_t i;
+  uint8_t * buffer;
+  uint32_t sum;
+  uint32_t lba;
+  uint32_t extended = 0;
+  uint32_t ebr;
+  PE_t * PE;
+
+  // Read MBR / Master Boot Record
+  // ----------------------------------------------------------------
+  if (NULL == (buffer = FAT32_Read_Sector (0))) {
+    return FAT32_ERROR;
+  }
+  MBR_t * MBR = (MBR_t *) buffer;
+  
+  // Checking
+  // ----------------------------------------------------------------
+  if ((FAT32_Get_2Bytes_LE (MBR->Signature) != FAT32_SIGNATURE)) {            // check signature 0xAA55
+    return FAT32_ERROR;
+  }
+
+  // Same Card As Last Mount
+  // ----------------------------------------------------------------
+  sum = FAT32_Checksum (buffer);
+  if ((FAT32_Volume_Begin != 0xFFFFFFFF) && (sum == FAT32_Volume_Sector0)) {
+    FAT32->lba_begin = FAT32_Volume_Begin;
+    return FAT32_SUCCESS;
+  }
+  FAT32_Volume_Sector0 = sum;
+  FAT32_Volume_Begin = 0xFFFFFFFF;
+
+  // Superfloppy - boot sector at LBA 0, no partition table
+  // ----------------------------------------------------------------
+  if (FAT32_Boot_Sector_Valid (buffer)) {
+    FAT32->lba_begin = 0;
+    return FAT32_SUCCESS;
+  }
+
+  // Primary Partitions
+  // ----------------------------------------------------------------
+  PE = &MBR->Partition1;
+  for (i = 0; i < 4; i++, PE++) {
+    if (FAT32_Partition_Valid (PE)) {
+      FAT32->lba_begin = FAT32_Get_4Bytes_LE (PE->LBA_Begin);                 // LBA begin address
+      return FAT32_SUCCESS;
+    }
+    if ((extended == 0) && ((PE->TypeCode == PE_TYPECODE_EXTDOS) || (PE->TypeCode == PE_TYPECODE_EXTDOSLBA))) {
+      extended = FAT32_Get_4Bytes_LE (PE->LBA_Begin);
+    }
+  }
+
+  // Logical Partitions - chain of EBRs, links relative to extended partition
+  // ----------------------------------------------------------------
+  ebr = extended;
+  for (i = 0; (i < PE_EXTENDED_MAX) && ebr; i++) {
+    if (NULL == (buffer = FAT32_Read_Sector (ebr))) {
+      return FAT32_ERROR;
+    }
+    MBR = (MBR_t *) buffer;
+    if ((FAT32_Get_2Bytes_LE (MBR->Signature) != FAT32_SIGNATURE)) {
+      break;
+    }
+    if (FAT32_Partition_Valid (&MBR->Partition1)) {
+      FAT32->lba_begin = ebr + FAT32_Get_4Bytes_LE (MBR->Partition1.LBA_Begin);  // relative to EBR
+      return FAT32_SUCCESS;
+    }
+    lba = FAT32_Get_4Bytes_LE (MBR->Partition2.LBA_Begin);
+    if (((MBR->Partition2.TypeCode != PE_TYPECODE_EXTDOS) && (MBR->Partition2.TypeCode != PE_TYPECODE_EXTDOSLBA)) ||
+        (lba == 0)) {
+      break;                                                                  // last logical partition
+    }
+    ebr = extended + lba;
+  }
+
+  return FAT32_ERROR;
+}
+
+/**
+ * @brief   Read Boot Sector
+ * @note    FAT type follows from number of clusters; FAT12/16 keep root
+ *          directory in fixed region, addressed as FAT32_CLUSTER_ROOT
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Read_Boot_Sector (FAT32_t * FAT32)
+{
+  uint8_t * buffer;
+  uint16_t reserved_sectors;
+  uint16_t root_entries;
+  uint16_t fsinfo_sector;
+  uint32_t sector_per_fats;
+  uint32_t entries;
+  uint32_t sectors;
+
+  // Read Boot Sector with BIOS Parameter Block
+  // ----------------------------------------------------------------
+  if (NULL == (buffer = FAT32_Read_Sector (FAT32->lba_begin))) {            // same sector as MBR for superfloppy
+    return FAT32_ERROR;
+  }
+  BS_t * BS = (BS_t *) buffer;
+
+  // Checking
+  // ----------------------------------------------------------------
+  if ((FAT32_Get_2Bytes_LE (BS->Signature) != FAT32_SIGNATURE)) {             // check signature 0xAA55
+    return FAT32_ERROR;
+  }
+  if ((FAT32_Get_2Bytes_LE (BS->BytesPerSector) != BYTES_PER_SECTOR)) {       // only 512 bytes per sector accepted
+    return FAT32_ERROR;
+  }
+  if (BS->NumberOfFATs != FAT32_NUM_OF_FATS) {                                // only 2 FAT tables accepted
+    return FAT32_ERROR;
+  }
+
+  // Calculations - 16 bit fields are zero on FAT32
+  // ----------------------------------------------------------------
+  reserved_sectors = FAT32_Get_2Bytes_LE (BS->ReservedSectors);
+  root_entries = FAT32_Get_2Bytes_LE (BS->RootEntries);
+  if (0 == (sector_per_fats = FAT32_Get_2Bytes_LE (BS->SectorsPerFAT))) {
+    sector_per_fats = FAT32_Get_4Bytes_LE (BS->BigSectorsPerFAT);
+  }
+  if (0 == (sectors = FAT32_Get_2Bytes_LE (BS->NumberOfSectors))) {
+    sectors = FAT32_Get_4Bytes_LE (BS->BigNumberOfSectors);
+  }
+
+  FAT32->sectors_per_cluster = BS->SectorsPerCluster;
+  FAT32->fat_area_begin = FAT32->lba_begin + reserved_sectors;
+  FAT32->root_dir_sector = FAT32->fat_area_begin + (BS->NumberOfFATs * sector_per_fats);
+  FAT32->root_dir_sectors = ((uint32_t) root_entries * sizeof (DE_t) + BYTES_PER_SECTOR - 1) / BYTES_PER_SECTOR;
+  FAT32->data_area_begin = FAT32->root_dir_sector + FAT32->root_dir_sectors;
+  FAT32->sectors_per_fat = sector_per_fats;
+
+  if ((FAT32->sectors_per_cluster == 0) || (FAT32->sectors_per_cluster & (FAT32->sectors_per_cluster - 1)) ||
+      (sectors <= (FAT32->data_area_begin - FAT32->lba_begin))) {
+    return FAT32_ERROR;                                                       // cluster size must be power of 2
+  }
+  for (FAT32->cluster_shift = 0; (1U << FAT32->cluster_shift) < FAT32->sectors_per_cluster; FAT32->cluster_shift++) {
+    ;
+  }
+  FAT32->cluster_base = FAT32->data_area_begin - (FAT32_CLUSTER_FIRST << FAT32->cluster_shift);
+  sectors -= FAT32->data_area_begin - FAT32->lba_begin;
+  FAT32->clusters = sectors >> FAT32->cluster_shift;
+
+  // FAT Type
+  // ----------------------------------------------------------------
+  if (FAT32->clusters < FAT12_CLUSTERS_MAX) {
+    FAT32->type = FAT32_TYPE_12;
+    FAT32->fat_shift = 0;                                                     // entries not aligned to sectors
+    entries = (sector_per_fats * BYTES_PER_SECTOR * 2) / 3;
+  } else if (FAT32->clusters < FAT16_CLUSTERS_MAX) {
+    FAT32->type = FAT32_TYPE_16;
+    FAT32->fat_shift = 8;
+    entries = sector_per_fats << 8;
+  } else {
+    FAT32->type = FAT32_TYPE_32;
+    FAT32->fat_shift = 7;
+    entries = sector_per_fats << 7;
+  }
+  if ((FAT32->clusters + FAT32_CLUSTER_FIRST) > entries) {
+    FAT32->clusters = entries - FAT32_CLUSTER_FIRST;                          // limited by FAT size
+  }
+
+  // Root Directory - fixed region or cluster chain
+  // ----------------------------------------------------------------
+  if (FAT32->type != FAT32_TYPE_32) {
+    if ((FAT32->root_dir_sectors == 0) || (FAT32->root_dir_sectors > 0xFF)) {  // sector of iterator is 8 bit
+      return FAT32_ERROR;
+    }
+    FAT32->root_dir_clus_num = FAT32_CLUSTER_ROOT;
+    FAT32->fsinfo_sector = 0;                                                 // no FSInfo, free count recounted
+  } else {
+    if (FAT32->root_dir_sectors != 0) {
+      return FAT32_ERROR;
+    }
+    FAT32->root_dir_clus_num = FAT32_Get_4Bytes_LE (BS->RootDirClusNo);
+    FAT32->root_dir_sector = FAT32_Get_1st_Sector_Of_Clus (FAT32, FAT32->root_dir_clus_num);
+    fsinfo_sector = FAT32_Get_2Bytes_LE (BS->FSInfoSector);
+    FAT32->fsinfo_sector = ((fsinfo_sector == 0) || (fsinfo_sector >= reserved_sectors)) ? 0 : (FAT32->lba_begin + fsinfo_sector);
+  }
+
+  // Geometry Valid - reused at next mount
+  // ----------------------------------------------------------------
+  FAT32_Volume_Begin = FAT32->lba_begin;
+#ifdef FAT32_MOUNT_EEPROM
+  FAT32_Mount_Store (FAT32, buffer);                                          // buffer still holds boot sector
+#endif
+  FAT32_FSInfo_Load (FAT32);
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Read Root Directory & Build Directory Index
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint32_t
+ *  */
+uint32_t FAT32_Root_Dir_Files (FAT32_t * FAT32)
+{
+  FAT32->files = 0;                                                           // index empty while scanning
+  FAT32_Index_Loaded = 0;
+  FAT32->files = FAT32_Root_Dir_Scan (FAT32, 0, NULL, NULL);
+
+  return FAT32->files;
+}
+
+/**
+ * @brief   Get Directory Index Entry
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint16_t file number (1 - files)
+ * @param   FAT32_Index_t * entry
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Get_Index (FAT32_t * FAT32, uint16_t filenum, FAT32_Index_t * Entry)
+{
+  // Checking
+  // ----------------------------------------------------------------
+  if ((filenum == 0) || (filenum > FAT32->files)) {
+    return FAT32_ERROR;
+  }
+  // Index File - one record read
+  // ----------------------------------------------------------------
+  if (FAT32_Index_Valid) {
+    FAT32_Record_t Record;
+    if (FAT32_ERROR == FAT32_Get_Record (FAT32, filenum, &Record)) {
+      return FAT32_ERROR;
+    }
+    Entry->sector = FAT32_Get_4Bytes_LE (Record.Sector);
+    Entry->cluster = FAT32_Get_4Bytes_LE (Record.Cluster);
+    Entry->size = FAT32_Get_4Bytes_LE (Record.Size);
+    Entry->hash = FAT32_Get_2Bytes_LE (Record.Hash);
+    Entry->slot = Record.Slot;
+    Entry->attribute = Record.Attribute;
+    Entry->lfn = Record.Lfn;
+    return FAT32_SUCCESS;
+  }
+  // Indexed - O(1)
+  // ----------------------------------------------------------------
+  if (filenum <= FAT32_Index_Loaded) {
+    FAT32_Index_Load (filenum - 1, Entry);
+    return FAT32_SUCCESS;
+  }
+  // Beyond Index Capacity - scan
+  // ----------------------------------------------------------------
+  if (FAT32_Root_Dir_Scan (FAT32, filenum, Entry, NULL) < filenum) {
+    return FAT32_ERROR;
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Load Header Of Directory Index File
+ * @note    header valid only while fingerprint matches root directory
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Index_Header (FAT32_t * FAT32)
+{
+  FAT32_SDIndex_t Header;
+
+  if ((sizeof (Header) != FAT32_Read (FAT32, &FAT32_Index_Handle, (uint8_t *) &Header, sizeof (Header))) ||
+      (memcmp (Header.Signature, FAT32_SDINDEX_SIGNATURE, 4) != 0) ||
+      (Header.Version != FAT32_SDINDEX_VERSION) ||
+      (Header.RecordSize != sizeof (FAT32_Record_t)) ||
+      (FAT32_Get_4Bytes_LE (Header.Capacity) < FAT32_Get_4Bytes_LE (Header.Entries)) ||
+      (FAT32_ERROR == FAT32_Root_Fingerprint (FAT32, &Header, 1))) {
+    return FAT32_ERROR;
+  }
+  FAT32->files = FAT32_Get_4Bytes_LE (Header.Entries);
+  FAT32_Index_Capacity = FAT32_Get_4Bytes_LE (Header.Capacity);
+  FAT32_Hash_Slots = FAT32_Get_4Bytes_LE (Header.HashSlots);
+  if ((FAT32_Hash_Slots & (FAT32_Hash_Slots - 1)) ||                          // power of two inside file
+      ((FAT32_Hash_Table (FAT32_Index_Capacity) + FAT32_Hash_Slots * sizeof (FAT32_Bucket_t)) > FAT32_Index_Handle.size)) {
+    FAT32_Hash_Slots = 0;
+  } else {
+    FAT32_Sort_Views = Header.Sorted;                                         // views follow hash table
+  }
+  FAT32_Index_Valid = 1;
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Rebuild Stale Directory Index File
+ * @note    records formed in one pass over root directory
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t * buffer of one sector
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Index_Rebuild (FAT32_t * FAT32, uint8_t * records)
+{
+  uint32_t sector;
+
+  // Records - one sector formed at a time
+  // ----------------------------------------------------------------
+  memset (records, 0, BYTES_PER_SECTOR);
+  FAT32_Record_Buffer = records;
+  FAT32_Record_Overflow = 0;
+  FAT32_Root_Dir_Files (FAT32);
+  if (FAT32->files % FAT32_SDINDEX_RECORDS) {                                 // last, partially filled sector
+    FAT32_Record_Flush (FAT32, FAT32->files);
+  }
+  FAT32_Record_Buffer = NULL;
+  if (FAT32_Record_Overflow) {
+    return FAT32_ERROR;
+  }
+  FAT32_Hash_Build (FAT32, records);                                          // without table lookups walk directory
+
+  // Header written last
+  // ----------------------------------------------------------------
+  memset (records, 0, BYTES_PER_SECTOR);
+  FAT32_SDIndex_t * New = (FAT32_SDIndex_t *) records;
+  memcpy (New->Signature, FAT32_SDINDEX_SIGNATURE, 4);
+  New->Version = FAT32_SDINDEX_VERSION;
+  New->RecordSize = sizeof (FAT32_Record_t);
+  FAT32_Put_4Bytes_LE (New->Entries, FAT32->files);
+  FAT32_Put_4Bytes_LE (New->HashSlots, FAT32_Hash_Slots);
+  FAT32_Put_4Bytes_LE (New->Capacity, FAT32_Index_Capacity);
+  if (FAT32_ERROR == FAT32_Root_Fingerprint (FAT32, New, 0)) {
+    return FAT32_ERROR;
+  }
+  if ((0 == (sector = FAT32_Index_Sector (FAT32, 0))) ||
+      (FAT32_ERROR == FAT32_Write_Sector (sector, records))) {
+    return FAT32_ERROR;
+  }
+  FAT32_Index_Valid = 1;
+#ifdef FAT32_MOUNT_EEPROM
+  FAT32_Mount_Index (FAT32_Index_Handle.first_cluster, FAT32_Index_Handle.size, FAT32_Index_First);
+#endif
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Lend Storage Of RAM Index To Pool
+ * @note    RAM entries are not read while index file is valid
+ *
+ * @param   void
+ *
+ * @return  void
+ */
+static void FAT32_Index_Lend (void)
+{
+  if (POOL_SUCCESS == POOL_Lend (FAT32_Index_Ram.Sector)) {
+    FAT32_Index_Lent = 1;
+    FAT32_Index_Loaded = 0;
+  }
+}
+
+/**
+ * @brief   Take Storage Of RAM Index Back From Pool
+ *
+ * @param   void
+ *
+ * @return  uint8_t FAT32_ERROR while borrowed
+ */
+static uint8_t FAT32_Index_Reclaim (void)
+{
+  if (FAT32_Index_Lent && (POOL_ERROR == POOL_Reclaim (FAT32_Index_Ram.Sector))) {
+    return FAT32_ERROR;
+  }
+  FAT32_Index_Lent = 0;
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Load Directory Index File Or Rebuild It When Stale
+ * @note    root directory is scanned only if index file is missing or stale
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint8_t FAT32_SUCCESS if index file is valid
+ */
+uint8_t FAT32_Index_File (FAT32_t * FAT32)
+{
+  DE_t * DE;
+  uint8_t i;
+  uint8_t slot;
+  uint8_t * buffer;
+  uint8_t * records;
+  uint32_t sector = FAT32_Get_1st_Sector_Of_Clus (FAT32, FAT32->root_dir_clus_num);
+  uint32_t cluster;
+  uint32_t next;
+
+  FAT32_Index_Valid = 0;
+  FAT32_Index_Handle.open = 0;
+  FAT32_Hash_Slots = 0;
+  FAT32_Index_First = 0;
+  FAT32_Sort_Views = 0;
+#ifdef FAT32_JOURNAL
+  FAT32_Data_Release ();
+#endif
+  FAT32_Index_Reclaim ();                                                     // still borrowed => RAM index stays empty
+
+#ifdef FAT32_MOUNT_EEPROM
+  // Index File Of Last Mount - no directory search, header still verified
+  // ----------------------------------------------------------------
+  if (FAT32_Mount_Cached && (0 != (cluster = eeprom_read_dword (&FAT32_Mount.index_cluster)))) {
+    FAT32_File_Init (&FAT32_Index_Handle, cluster, eeprom_read_dword (&FAT32_Mount.index_size));
+    FAT32_Index_First = eeprom_read_dword (&FAT32_Mount.index_first);
+    if (FAT32_SUCCESS == FAT32_Index_Header (FAT32)) {
+      FAT32_Mount_Cached = 0;
+      FAT32_Index_Lend ();
+      return FAT32_SUCCESS;
+    }
+    FAT32_Index_Handle.open = 0;
+    FAT32_Index_First = 0;
+  }
+  FAT32_Mount_Cached = 0;                                                     // only at mount, directory may change
+#endif
+
+  // Find Index File In First Directory Sectors
+  // ----------------------------------------------------------------
+  for (i = 0; (i < FAT32_SDINDEX_HEAD_SECTORS) && (i < FAT32_Cluster_Sectors (FAT32, FAT32->root_dir_clus_num)) && !FAT32_Index_Handle.open; i++) {
+    if (NULL == (buffer = FAT32_Read_Sector (sector + i))) {
+      break;
+    }
+    for (slot = 0; slot < (BYTES_PER_SECTOR >> 5); slot++) {
+      DE = (DE_t *) &buffer[slot << 5];
+      if (DE->Name[0] == FAT32_DE_END) {
+        break;
+      }
+      if ((memcmp (DE->Name, FAT32_SDINDEX_NAME, 11) == 0) &&
+          !(DE->Attribute & (FAT32_ATTR_DIRECTORY | FAT32_ATTR_VOLUME_ID))) {
+        FAT32_File_Init (&FAT32_Index_Handle,
+                         ((uint32_t) FAT32_Get_2Bytes_LE (DE->FirstClustHI) << 16) | FAT32_Get_2Bytes_LE (DE->FirstClustLO),
+                         FAT32_Get_4Bytes_LE (DE->FileSize));
+        break;
+      }
+    }
+  }
+  if ((!FAT32_Index_Handle.open) || (FAT32_Index_Handle.size < (2 * BYTES_PER_SECTOR))) {
+    FAT32_Index_Handle.open = 0;
+#ifdef FAT32_MOUNT_EEPROM
+    FAT32_Mount_Index (0, 0, 0);
+#endif
+    FAT32_Root_Dir_Files (FAT32);                                             // RAM index only
+    return FAT32_ERROR;
+  }
+
+  // Contiguous Index File - positions mapped directly to sectors
+  // ----------------------------------------------------------------
+  cluster = FAT32_Index_Handle.first_cluster;
+  while ((next = (FAT32_FAT_Next_Cluster (FAT32, cluster) & FAT32_CLUSTER_MASK)) == (cluster + 1)) {
+    cluster = next;
+  }
+  if ((next >= FAT32_CLUSTER_EOC) &&
+      (((cluster - FAT32_Index_Handle.first_cluster + 1) << (BYTES_PER_SECTOR_SHIFT + FAT32->cluster_shift)) >= FAT32_Index_Handle.size)) {
+    FAT32_Index_First = FAT32_Get_1st_Sector_Of_Clus (FAT32, FAT32_Index_Handle.first_cluster);
+  }
+
+  // Header Matches Root Directory => Done
+  // ----------------------------------------------------------------
+  if (FAT32_SUCCESS == FAT32_Index_Header (FAT32)) {
+#ifdef FAT32_MOUNT_EEPROM
+    FAT32_Mount_Index (FAT32_Index_Handle.first_cluster, FAT32_Index_Handle.size, FAT32_Index_First);
+#endif
+    FAT32_Index_Lend ();
+    return FAT32_SUCCESS;
+  }
+
+  // Stale - rebuilt in storage of RAM index, or in buffer of pool while storage borrowed
+  // ----------------------------------------------------------------
+  if (!FAT32_Index_Lent) {
+    FAT32_Index_Lent = 1;                                                     // records overlap RAM entries
+    i = FAT32_Index_Rebuild (FAT32, FAT32_Index_Ram.Sector);
+    FAT32_Index_Lent = 0;
+  } else if (NULL != (records = POOL_Borrow (POOL_OWNER_INDEX))) {
+    i = FAT32_Index_Rebuild (FAT32, records);
+    POOL_Return (records, POOL_OWNER_INDEX);
+  } else {
+    i = FAT32_ERROR;
+  }
+  if (i == FAT32_ERROR) {
+    FAT32_Root_Dir_Files (FAT32);                                             // RAM index only
+    return FAT32_ERROR;
+  }
+  FAT32_Index_Lend ();
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Get Directory Index File Record
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint16_t file number (1 - files)
+ * @param   FAT32_Record_t * record
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Get_Record (FAT32_t * FAT32, uint16_t filenum, FAT32_Record_t * Record)
+{
+  if ((!FAT32_Index_Valid) || (filenum == 0) || (filenum > FAT32->files)) {
+    return FAT32_ERROR;
+  }
+
+  return FAT32_Index_Read (FAT32, FAT32_Record_Position (filenum), (uint8_t *) Record, sizeof (FAT32_Record_t));
+}
+
+/**
+ * @brief   Sort Runs And Merge Them Into Sorted View
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t FAT32_SORT_NAME / FAT32_SORT_SIZE / FAT32_SORT_DATE
+ * @param   uint8_t * buffer of half sector at least, run being formed / written
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Sort_Build (FAT32_t * FAT32, uint8_t sort, uint8_t * half)
+{
+  uint8_t w;
+  uint8_t best;
+  uint8_t last;
+  uint8_t * buffer;
+  uint8_t source = FAT32_SORT_KEYS + 1;                                       // scratch area holding runs
+  uint16_t i;
+  uint16_t j;
+  uint16_t emitted;
+  uint16_t next[FAT32_SORT_WAYS];
+  uint16_t end[FAT32_SORT_WAYS];
+  uint32_t run;
+  uint32_t start;
+  uint32_t sector;
+  FAT32_Key_t Key;
+  FAT32_Key_t Head[FAT32_SORT_WAYS];                                          // smallest unmerged key of runs
+  FAT32_Key_t * Run = (FAT32_Key_t *) half;
+
+  // Runs - keys of consecutive records sorted in RAM
+  // ----------------------------------------------------------------
+  last = (FAT32->files <= FAT32_SORT_RUN);
+  for (start = 0; start < FAT32->files; start += FAT32_SORT_RUN) {
+    for (i = 0; (i < FAT32_SORT_RUN) && ((start + i) < FAT32->files); i++) {
+      if (FAT32_ERROR == FAT32_Sort_Key (FAT32, sort, start + i + 1, &Key)) {
+        return FAT32_ERROR;
+      }
+      for (j = i; (j > 0) && (FAT32_Sort_Compare (FAT32, sort, &Run[j - 1], &Key) > 0); j--) {
+        Run[j] = Run[j - 1];                                                  // insertion sort
+      }
+      Run[j] = Key;
+    }
+    if (last) {
+      for (j = 0; j < i; j++) {                                               // file number j lands before key j + 1
+        if (FAT32_ERROR == FAT32_Sort_Emit (FAT32, half, FAT32_Sort_Area (FAT32, sort), j, &Run[j], 1)) {
+          return FAT32_ERROR;
+        }
+      }
+    } else if (FAT32_ERROR == FAT32_Sort_Flush (FAT32, FAT32_Sort_Area (FAT32, source) + start * sizeof (FAT32_Key_t), half, i * sizeof (FAT32_Key_t))) {
+      return FAT32_ERROR;
+    }
+  }
+
+  // Merge Passes - each reads runs and writes merged runs sequentially
+  // ----------------------------------------------------------------
+  for (run = FAT32_SORT_RUN; !last; run *= FAT32_SORT_WAYS) {
+    last = ((run * FAT32_SORT_WAYS) >= FAT32->files);
+    emitted = 0;
+    for (start = 0; start < FAT32->files; start += run * FAT32_SORT_WAYS) {
+      for (w = 0; w < FAT32_SORT_WAYS; w++) {
+        next[w] = ((start + w * run) < FAT32->files) ? (start + w * run) : FAT32->files;
+        end[w] = ((start + (w + 1) * run) < FAT32->files) ? (start + (w + 1) * run) : FAT32->files;
+        if ((next[w] < end[w]) &&
+            (FAT32_ERROR == FAT32_Index_Read (FAT32, FAT32_Sort_Area (FAT32, source) + (uint32_t) next[w] * sizeof (FAT32_Key_t),
+                                              (uint8_t *) &Head[w], sizeof (FAT32_Key_t)))) {
+          return FAT32_ERROR;
+        }
+      }
+      while (1) {
+        best = FAT32_SORT_WAYS;
+        for (w = 0; w < FAT32_SORT_WAYS; w++) {
+          if ((next[w] < end[w]) &&
+              ((best == FAT32_SORT_WAYS) || (FAT32_Sort_Compare (FAT32, sort, &Head[w], &Head[best]) < 0))) {
+            best = w;
+          }
+        }
+        if (best == FAT32_SORT_WAYS) {
+          break;                                                              // runs of group merged
+        }
+        if (FAT32_ERROR == FAT32_Sort_Emit (FAT32, half, FAT32_Sort_Area (FAT32, last ? sort : ((2 * FAT32_SORT_KEYS + 3) - source)),
+                                            emitted++, &Head[best], last)) {
+          return FAT32_ERROR;
+        }
+        if ((++next[best] < end[best]) &&
+            (FAT32_ERROR == FAT32_Index_Read (FAT32, FAT32_Sort_Area (FAT32, source) + (uint32_t) next[best] * sizeof (FAT32_Key_t),
+                                              (uint8_t *) &Head[best], sizeof (FAT32_Key_t)))) {
+          return FAT32_ERROR;
+        }
+      }
+    }
+    source = (2 * FAT32_SORT_KEYS + 3) - source;                              // merged runs are source of next pass
+  }
+
+  // Header - view valid until index is rebuilt
+  // ----------------------------------------------------------------
+  if ((0 == (sector = FAT32_Index_Sector (FAT32, 0))) ||
+      (NULL == (buffer = FAT32_Read_Sector (sector)))) {
+    return FAT32_ERROR;
+  }
+  ((FAT32_SDIndex_t *) buffer)->Sorted |= 1 << sort;
+  if (FAT32_ERROR == FAT32_Write_Sector (sector, buffer)) {
+    return FAT32_ERROR;
+  }
+  FAT32_Sort_Views |= 1 << sort;
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Build Sorted View Of Root Directory In Index File
+ * @note    external merge sort, runs of FAT32_SORT_RUN keys merged FAT32_SORT_WAYS
+ *          at a time in sequential passes; view is kept until index is rebuilt
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t FAT32_SORT_NAME / FAT32_SORT_SIZE / FAT32_SORT_DATE
+ *
+ * @return  uint8_t FAT32_ERROR if index file is missing or too small
+ */
+uint8_t FAT32_Sort (FAT32_t * FAT32, uint8_t sort)
+{
+  uint8_t status;
+  uint8_t * buffer;
+
+  if ((!FAT32_Index_Valid) || (sort == FAT32_SORT_NONE) || (sort > FAT32_SORT_KEYS)) {
+    return FAT32_ERROR;
+  }
+  if (FAT32_Sort_Views & (1 << sort)) {
+    return FAT32_SUCCESS;
+  }
+  if (FAT32_Sort_Area (FAT32, FAT32_SORT_KEYS + 3) > FAT32_Index_Handle.size) {
+    return FAT32_ERROR;                                                       // index file too small
+  }
+#ifdef FAT32_JOURNAL
+  FAT32_Data_Release ();
+#endif
+  if (NULL == (buffer = POOL_Borrow (POOL_OWNER_SORT))) {
+    return FAT32_ERROR;
+  }
+  status = FAT32_Sort_Build (FAT32, sort, buffer);
+  POOL_Return (buffer, POOL_OWNER_SORT);
+
+  return status;
+}
+
+/**
+ * @brief   File Number At Position Of Sorted View
+ * @note    one read of the view, view must be built by FAT32_Sort
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t FAT32_SORT_NAME / FAT32_SORT_SIZE / FAT32_SORT_DATE
+ * @param   uint16_t position (1 - files)
+ *
+ * @return  uint16_t file number, 0 = no view
+ */
+uint16_t FAT32_Sorted_File (FAT32_t * FAT32, uint8_t sort, uint16_t position)
+{
+  uint8_t file[2];
+
+  if ((!FAT32_Index_Valid) || (sort == FAT32_SORT_NONE) || (sort > FAT32_SORT_KEYS) ||
+      !(FAT32_Sort_Views & (1 << sort)) || (position == 0) || (position > FAT32->files)) {
+    return 0;
+  }
+  if (FAT32_ERROR == FAT32_Index_Read (FAT32, FAT32_Sort_Area (FAT32, sort) + (uint32_t) (position - 1) * 2, file, sizeof (file))) {
+    return 0;
+  }
+
+  return FAT32_Get_2Bytes_LE (file);
+}
+
+/**
+ * @brief   Next File Of Sorted View Passing Filter
+ * @note    entries not passing filter of directory iterator (FAT32_FILTER_*)
+ *          skipped, so positions match filtered directory order count
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint8_t FAT32_SORT_NAME / FAT32_SORT_SIZE / FAT32_SORT_DATE
+ * @param   uint16_t * positions of view passed, moved behind returned file
+ *
+ * @return  uint16_t file number, 0 = end of view or no view
+ */
+uint16_t FAT32_Sorted_Next (FAT32_t * FAT32, uint8_t sort, uint16_t * position)
+{
+  uint16_t filenum;
+  FAT32_Record_t Record;
+
+  while (0 != (filenum = FAT32_Sorted_File (FAT32, sort, *position + 1))) {
+    (*position)++;
+    if (FAT32_ERROR == FAT32_Get_Record (FAT32, filenum, &Record)) {
+      return 0;
+    }
+    if (FAT32_Dir_Filter (Record.Attribute, &Record.Name[8])) {
+      return filenum;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief   Get Name (Long Name Prefix or Short Name "NAME.EXT")
+ * @note    at most 3 directory sectors are read when only the RAM index is available
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint16_t file number (1 - files)
+ * @param   uint8_t * buffer
+ * @param   uint8_t size of buffer
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Get_Name (FAT32_t * FAT32, uint16_t filenum, uint8_t * buffer, uint8_t size)
+{
+  uint8_t * data;
+  uint16_t start;
+  uint32_t sector;
+  FAT32_Name_t Name;
+  FAT32_Index_t Entry;
+  FAT32_Record_t Record;
+
+  if (size == 0) {
+    return FAT32_ERROR;
+  }
+  // Index File - name stored in record
+  // ----------------------------------------------------------------
+  if (FAT32_Index_Valid) {
+    if (FAT32_ERROR == FAT32_Get_Record (FAT32, filenum, &Record)) {
+      return FAT32_ERROR;
+    }
+    if (size > FAT32_SDINDEX_NAME_LENGTH) {
+      size = FAT32_SDINDEX_NAME_LENGTH + 1;
+    }
+    memcpy (buffer, Record.LongName, size - 1);
+    buffer[size - 1] = 0;
+    return FAT32_SUCCESS;
+  }
+  if (FAT32_ERROR == FAT32_Get_Index (FAT32, filenum, &Entry)) {
+    return FAT32_ERROR;
+  }
+  FAT32_Name_Init (&Name, buffer, size);
+
+  // Long name slots inside the same cluster => stream from first slot
+  // ----------------------------------------------------------------
+  if (FAT32->root_dir_clus_num == FAT32_CLUSTER_ROOT) {                      // fixed root is one region
+    start = (Entry.sector - FAT32->root_dir_sector) * (BYTES_PER_SECTOR >> 5) + Entry.slot;
+  } else {
+    start = ((Entry.sector - FAT32->data_area_begin) & (FAT32->sectors_per_cluster - 1)) * (BYTES_PER_SECTOR >> 5) + Entry.slot;
+  }
+  if (start < Entry.lfn) {                                                    // slots begin in previous cluster
+    return (FAT32_Root_Dir_Scan (FAT32, filenum, &Entry, &Name) < filenum) ? FAT32_ERROR : FAT32_SUCCESS;
+  }
+  sector = Entry.sector - (Entry.slot < Entry.lfn ? ((Entry.lfn - Entry.slot + 15) >> 4) : 0);
+  start = (Entry.slot + (BYTES_PER_SECTOR >> 5) * (Entry.sector - sector)) - Entry.lfn;
+  while (1) {
+    if (NULL == (data = FAT32_Read_Sector (sector))) {
+      return FAT32_ERROR;
+    }
+    for (; start < (BYTES_PER_SECTOR >> 5); start++) {
+      if ((sector == Entry.sector) && (start == Entry.slot)) {
+        FAT32_Name_Entry (&Name, (DE_t *) &data[start << 5]);
+        return FAT32_SUCCESS;
+      }
+      FAT32_Name_Slot (&Name, (LFN_t *) &data[start << 5]);
+    }
+    start = 0;
+    sector++;
+  }
+}
+
+/**
+ * @brief   Start Long File Name Assembly
+ *
+ * @param   FAT32_Name_t * name
+ * @param   uint8_t * buffer
+ * @param   uint8_t size of buffer
+ *
+ * @return  void
+ */
+void FAT32_Name_Init (FAT32_Name_t * Name, uint8_t * buffer, uint8_t size)
+{
+  Name->buffer = buffer;
+  Name->size = size;
+  Name->order = 0;
+  Name->checksum = 0;
+  Name->hash = 0;
+}
+
+/**
+ * @brief   Feed Long File Name Slot
+ * @note    slots are stored last part first, every part lands at its fixed
+ *          offset so only the prefix fitting into buffer is kept
+ *
+ * @param   FAT32_Name_t * name
+ * @param   LFN_t * long name slot
+ *
+ * @return  void
+ */
+void FAT32_Name_Slot (FAT32_Name_t * Name, LFN_t * LFN)
+{
+  static const uint8_t offsets[FAT32_LFN_CHARS] = { 1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30 };
+
+  uint8_t i;
+  uint8_t * slot = (uint8_t *) LFN;
+  uint8_t order = slot[0] & ~FAT32_LFN_LAST;
+  uint8_t last = slot[0] & FAT32_LFN_LAST;
+  uint16_t character;
+  uint16_t position = (uint16_t) (order - 1) * FAT32_LFN_CHARS;
+  uint16_t power = FAT32_HASH_MULTIPLIER;
+
+  // Sequence Check
+  // ----------------------------------------------------------------
+  if ((order == 0) || (order > 20)) {                                         // max 255 characters
+    Name->order = 0;
+    return;
+  }
+  if (last) {
+    Name->checksum = (uint8_t) LFN->Checksum;
+    Name->hash = 0;
+  } else if ((Name->order != (order + 1)) || (Name->checksum != (uint8_t) LFN->Checksum)) {
+    Name->order = 0;                                                          // orphan or foreign slot
+    return;
+  }
+  Name->order = order;
+
+  // Characters (UCS-2, non ASCII => '?')
+  // ----------------------------------------------------------------
+  for (i = 0; i < position; i++) {                                            // K^(position + 1)
+    power *= FAT32_HASH_MULTIPLIER;
+  }
+  for (i = 0; i < FAT32_LFN_CHARS; i++, position++) {
+    character = slot[offsets[i]] | ((uint16_t) slot[offsets[i] + 1] << 8);
+    if (character == 0x0000) {
+      break;
+    }
+    character = (character < 0x80) ? character : '?';
+    if (position < (Name->size - 1)) {
+      Name->buffer[position] = (uint8_t) character;
+    }
+    Name->hash += toupper (character) * power;                               // whole name, not only prefix
+    power *= FAT32_HASH_MULTIPLIER;
+  }
+  if (last) {
+    Name->buffer[(position < (Name->size - 1)) ? position : (Name->size - 1)] = 0;
+  }
+}
+
+/**
+ * @brief   Finish Name At Short Entry
+ * @note    long name is accepted only if all slots arrived and checksum matches
+ *
+ * @param   FAT32_Name_t * name
+ * @param   DE_t * short entry
+ *
+ * @return  uint8_t 1 - long name, 0 - short name
+ */
+uint8_t FAT32_Name_Entry (FAT32_Name_t * Name, DE_t * DE)
+{
+  uint8_t i;
+  uint8_t sum = 0;
+  uint8_t name[13];
+  uint8_t * shortname = (uint8_t *) DE;                                       // name and extension, 11 bytes
+
+  for (i = 0; i < 11; i++) {
+    sum = ((sum & 1) << 7) + (sum >> 1) + shortname[i];
+  }
+  if ((Name->order == 1) && (sum == Name->checksum)) {
+    Name->order = 0;
+    return 1;
+  }
+  Name->order = 0;
+  Name->hash = 0;
+
+  // Short Name
+  // ----------------------------------------------------------------
+  FAT32_Short_Name (DE->Name, name);
+  for (i = 0; (i < (Name->size - 1)) && name[i]; i++) {
+    Name->buffer[i] = name[i];
+  }
+  Name->buffer[i] = 0;
+
+  return 0;
+}
+
+/**
+ * @brief   Read Next Cluster From FAT
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t cluster position in FAT
+ *
+ * @return  uint32_t
+ */
+uint32_t FAT32_FAT_Next_Cluster (FAT32_t * FAT32, uint32_t cluster_pos_in_FAT)
+{
+  uint8_t * buffer;
+
+  if (FAT32->type != FAT32_TYPE_32) {
+    return FAT32_FAT_Next_Cluster_12_16 (FAT32, cluster_pos_in_FAT);
+  }
+
+  uint32_t next_cluster;
+  uint32_t packet = cluster_pos_in_FAT << 2;                                  // sequel * 4
+  uint32_t sector = FAT32->fat_area_begin + packet / BYTES_PER_SECTOR;        // fats_begin + next block for SD read
+  uint16_t offset = packet % BYTES_PER_SECTOR;                                // packet % 512
+
+  // Read FAT Sector (consecutive lookups hit the cache)
+  // ----------------------------------------------------------------
+  if (NULL == (buffer = FAT32_Read_Sector (sector))) {
+    return FAT32_CLUSTER_MASK;                                                // unreadable => end of chain
+  }
+  next_cluster = FAT32_Get_4Bytes_LE (&buffer[offset]);
+
+  return next_cluster;
+}
+
+/**
+ * @brief   Get File Info from Root Directory
+ * @note    entry decoded into caller storage, sector cache free for reuse
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint16_t file number
+ * @param   FAT32_Info_t * info
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Get_File_Info (FAT32_t * FAT32, uint16_t filenum, FAT32_Info_t * Info)
+{
+  DE_t * DE;
+  uint8_t * buffer;
+  FAT32_Index_t Entry;
+
+  if (FAT32_ERROR == FAT32_Get_Index (FAT32, filenum, &Entry)) {
+    return FAT32_ERROR;
+  }
+  // Read only sector holding entry
+  // ----------------------------------------------------------------
+  if (NULL == (buffer = FAT32_Read_Sector (Entry.sector))) {
+    return FAT32_ERROR;
+  }
+  DE = (DE_t *) &buffer[Entry.slot << 5];
+  memcpy (Info->name, DE->Name, 11);
+  Info->attribute = DE->Attribute;
+  Info->cluster = Entry.cluster;
+  Info->size = Entry.size;
+  Info->date = FAT32_Get_2Bytes_LE (DE->ChangeDate);
+  Info->time = FAT32_Get_2Bytes_LE (DE->ChangeTime);
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Open File from Root Directory
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
+ * @param   uint16_t file number
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Open (FAT32_t * FAT32, FAT32_File_t * File, uint16_t filenum)
+{
+  FAT32_Index_t Entry;
+
+  // Checking
+  // ----------------------------------------------------------------
+  if (FAT32_ERROR == FAT32_Get_Index (FAT32, filenum, &Entry)) {              // file not found
+    return FAT32_ERROR;
+  }
+  if (Entry.attribute & FAT32_ATTR_DIRECTORY) {                               // only regular files
+    return FAT32_ERROR;
+  }
+
+  // Init Handle
+  // ----------------------------------------------------------------
+  FAT32_File_Init (File, Entry.cluster, Entry.size);
+  File->entry_sector = Entry.sector;
+  File->entry_slot = Entry.slot;
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Open Directory Iterator
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_Dir_t * iterator
+ * @param   uint32_t first cluster of directory, 0 = root directory
+ *
+ * @return  void
+ */
+void FAT32_Dir_Open (FAT32_t * FAT32, FAT32_Dir_t * Dir, uint32_t cluster)
+{
+  if (cluster == 0) {
+    cluster = FAT32->root_dir_clus_num;
+  }
+  Dir->first_cluster = cluster;
+  Dir->cluster = cluster;
+  Dir->sector = 0;
+  Dir->slot = 0;
+  Dir->index = 0;
+  Dir->hidden = 0;
+  Dir->filter = 0;
+}
+
+/**
+ * @brief   Next Entry Of Directory
+ * @note    skips deleted entries, volume label and index file (unless hidden set);
+ *          with filter set also entries not passing FAT32_Dir_Filter, tested
+ *          in cached sector before anything is copied
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_Dir_t * iterator
+ * @param   FAT32_Index_t * entry
+ * @param   FAT32_Name_t * long name assembly, NULL = not needed
+ *
+ * @return  uint8_t FAT32_ERROR at end of directory
+ */
+uint8_t FAT32_Dir_Next (FAT32_t * FAT32, FAT32_Dir_t * Dir, FAT32_Index_t * Entry, FAT32_Name_t * Name)
+{
+  DE_t * DE;
+  uint8_t lfn = 0;
+  uint8_t found;
+  uint8_t * buffer;
+  uint32_t sector;
+
+  if (Name != NULL) {
+    Name->order = 0;
+  }
+  while (Dir->cluster != 0) {
+
+    sector = FAT32_Get_1st_Sector_Of_Clus (FAT32, Dir->cluster) + Dir->sector;
+    if (NULL == (buffer = FAT32_Read_Sector (sector))) {                      // cursor kept, may be resumed
+      return FAT32_ERROR;
+    }
+    DE = (DE_t *) &buffer[Dir->slot << 5];
+    if (DE->Name[0] == FAT32_DE_END) {                                        // end of directory
+      Dir->cluster = 0;
+      return FAT32_ERROR;
+    }
+
+    // Examine Slot - before cursor moves, next cluster lookup evicts cache
+    // --------------------------------------------------------------
+    found = 0;
+    if ((DE->Attribute & 0x3F) == FAT32_DE_LONG_NAME) {                       // long name slot, may continue
+      if (Name != NULL) {                                                     // in next sector or cluster
+        FAT32_Name_Slot (Name, (LFN_t *) DE);
+      }
+      lfn++;
+    } else if ((DE->Name[0] == FAT32_DE_UNUSED) ||                            // deleted files
+               (DE->Attribute & FAT32_ATTR_VOLUME_ID) ||                      // volume label
+               (Dir->filter && !FAT32_Dir_Filter (DE->Attribute, DE->Extension)) ||  // not playable
+               ((Dir->first_cluster == FAT32->root_dir_clus_num) && !Dir->hidden &&
+                ((memcmp (DE->Name, FAT32_SDINDEX_NAME, 11) == 0) ||          // index file itself
+                 (memcmp (DE->Name, FAT32_JOURNAL_NAME, 11) == 0)))) {        // journal file
+      if (Name != NULL) {
+        Name->order = 0;
+      }
+      lfn = 0;
+    } else {
+      Entry->sector = sector;
+      Entry->slot = Dir->slot;
+      Entry->lfn = lfn;
+      Entry->attribute = DE->Attribute;
+      Entry->cluster = ((uint32_t) FAT32_Get_2Bytes_LE (DE->FirstClustHI) << 16) |
+                       FAT32_Get_2Bytes_LE (DE->FirstClustLO);
+      Entry->size = FAT32_Get_4Bytes_LE (DE->FileSize);
+      Entry->hash = FAT32_Hash (DE->Name, 11);
+      if (Name != NULL) {
+        FAT32_Name_Entry (Name, DE);
+      }
+      found = 1;
+    }
+
+    // Move Cursor To Next Slot
+    // --------------------------------------------------------------
+    if (++Dir->slot == (BYTES_PER_SECTOR >> 5)) {
+      Dir->slot = 0;
+      if (++Dir->sector == FAT32_Cluster_Sectors (FAT32, Dir->cluster)) {
+        Dir->sector = 0;
+        Dir->cluster = FAT32_FAT_Next_Cluster (FAT32, Dir->cluster) & FAT32_CLUSTER_MASK;
+        if ((Dir->cluster < FAT32_CLUSTER_FIRST) || (Dir->cluster >= FAT32_CLUSTER_EOC)) {
+          Dir->cluster = 0;                                                   // last cluster of directory
+        }
+      }
+    }
+    if (found) {
+      Dir->index++;
+      return FAT32_SUCCESS;
+    }
+  }
+
+  return FAT32_ERROR;
+}
+
+/**
+ * @brief   Find File In Root Directory By Name
+ * @note    short name "NAME.EXT" or long name, case insensitive
+ *
+ * @param   FAT32_t * FAT32
+ * @param   char * name
+ *
+ * @return  uint16_t file number (1 - files), 0 = not found
+ */
+uint16_t FAT32_Find (FAT32_t * FAT32, char * name)
+{
+  size_t length = strlen (name);
+  FAT32_Index_t Entry;
+
+  if (length > FAT32_PATH_NAME_LENGTH) {
+    return 0;
+  }
+
+  return FAT32_Dir_Find (FAT32, FAT32->root_dir_clus_num, name, (uint8_t) length, &Entry);
+}
+
+/**
+ * @brief   Resolve Path To Directory Entry
+ * @note    resolution starts at the deepest directory found in cache
+ *
+ * @param   FAT32_t * FAT32
+ * @param   char * path, e.g. "/ALBUM/01.MP3" or "/Album/Long Name.mp3"
+ * @param   FAT32_Index_t * entry
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Get_Path (FAT32_t * FAT32, char * path, FAT32_Index_t * Entry)
+{
+  uint8_t i;
+  uint8_t length;
+  uint8_t start = 0;
+  uint16_t hash;
+  uint32_t cluster = FAT32->root_dir_clus_num;
+  char * component;
+
+  // Deepest Cached Directory On Path
+  // ----------------------------------------------------------------
+  for (i = 1; (i != 0) && path[i]; i++) {                                     // max 255 characters
+    if ((path[i] == FAT32_PATH_SEPARATOR) && (path[i - 1] != FAT32_PATH_SEPARATOR)) {
+      hash = FAT32_Hash ((uint8_t *) path, i);
+      for (uint8_t j = 0; j < FAT32_DIRCACHE_ENTRIES; j++) {
+        if ((FAT32_Dircache[j].cluster != 0) &&
+            (FAT32_Dircache[j].hash == hash) &&
+            (FAT32_Dircache[j].length == i)) {
+          cluster = FAT32_Dircache[j].cluster;
+          start = i;
+          break;
+        }
+      }
+    }
+  }
+
+  // Root Directory
+  // ----------------------------------------------------------------
+  Entry->cluster = cluster;
+  Entry->attribute = FAT32_ATTR_DIRECTORY;
+  Entry->size = 0;
+
+  // Remaining Components
+  // ----------------------------------------------------------------
+  component = path + start;
+  while (1) {
+    while (*component == FAT32_PATH_SEPARATOR) {
+      component++;
+    }
+    if (*component == 0) {
+      return FAT32_SUCCESS;                                                   // directory path
+    }
+    if (!(Entry->attribute & FAT32_ATTR_DIRECTORY)) {                         // file in the middle of path
+      return FAT32_ERROR;
+    }
+    for (length = 0; component[length] && (component[length] != FAT32_PATH_SEPARATOR); length++) {
+      ;
+    }
+    if ((length == 1) && (component[0] == '.')) {                             // current directory
+      component++;
+      continue;
+    }
+    if (0 == FAT32_Dir_Find (FAT32, cluster, component, length, Entry)) {
+      return FAT32_ERROR;
+    }
+    component += length;
+    if (Entry->attribute & FAT32_ATTR_DIRECTORY) {
+      if (Entry->cluster == 0) {                                              // ".." of first level points to root
+        Entry->cluster = FAT32->root_dir_clus_num;
+      }
+      cluster = Entry->cluster;
+      // Remember Directory
+      // ------------------------------------------------------------
+      if (*component && ((component - path) < 0xFF)) {
+        FAT32_Dircache[FAT32_Dircache_Next].hash = FAT32_Hash ((uint8_t *) path, component - path);
+        FAT32_Dircache[FAT32_Dircache_Next].length = component - path;
+        FAT32_Dircache[FAT32_Dircache_Next].cluster = cluster;
+        FAT32_Dircache_Next = (FAT32_Dircache_Next + 1) % FAT32_DIRCACHE_ENTRIES;
+      }
+    }
+  }
+}
+
+/**
+ * @brief   Open File By Path
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
+ * @param   char * path
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Open_Path (FAT32_t * FAT32, FAT32_File_t * File, char * path)
+{
+  FAT32_Index_t Entry;
+
+  if (FAT32_ERROR == FAT32_Get_Path (FAT32, path, &Entry)) {
+    return FAT32_ERROR;
+  }
+  if (Entry.attribute & FAT32_ATTR_DIRECTORY) {                               // only regular files
+    return FAT32_ERROR;
+  }
+  FAT32_File_Init (File, Entry.cluster, Entry.size);
+  File->entry_sector = Entry.sector;
+  File->entry_slot = Entry.slot;
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Read Data From File
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
+ * @param   uint8_t * buffer
+ * @param   uint16_t number of bytes
+ *
+ * @return  uint16_t number of bytes read
+ */
+uint16_t FAT32_Read (FAT32_t * FAT32, FAT32_File_t * File, uint8_t * buffer, uint16_t length)
+{
+  uint8_t * cache;
+  uint16_t offset;
+  uint16_t chunk;
+  uint16_t done = 0;
+  uint32_t sector;
+
+  // Checking
+  // ----------------------------------------------------------------
+  if ((!File->open) || (File->position >= File->size)) {
+    return 0;
+  }
+  if (length > (File->size - File->position)) {                              // clip to end of file
+    length = File->size - File->position;
+  }
+
+  while (done < length) {
+    // Current Cluster / Sector / Offset
+    // --------------------------------------------------------------
+    if (0 == (sector = FAT32_File_Sector (FAT32, File))) {
+      break;
+    }
+    offset = File->position % BYTES_PER_SECTOR;
+    chunk = BYTES_PER_SECTOR - offset;
+    if (chunk > (length - done)) {
+      chunk = length - done;
+    }
+    // Whole Sector - straight into caller buffer, bypass cache
+    // --------------------------------------------------------------
+    if (chunk == BYTES_PER_SECTOR) {
+      FAT32_Stream_Stop ();
+      if (SD_START_TOKEN != SD_Read_Block (sector, &buffer[done])) {
+        break;
+      }
+    // Partial Sector - through cache
+    // --------------------------------------------------------------
+    } else {
+      if (NULL == (cache = FAT32_Read_Sector (sector))) {
+        break;
+      }
+      memcpy (&buffer[done], &cache[offset], chunk);
+    }
+    done += chunk;
+    File->position += chunk;
+  }
+
+  return done;
+}
+
+/**
+ * @brief   Set File Position
+ * @note    cluster chain is walked lazily on next read
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
+ * @param   uint32_t byte offset from beginning of file
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Seek (FAT32_t * FAT32, FAT32_File_t * File, uint32_t position)
+{
+  if ((!File->open) || (position > File->size)) {
+    return FAT32_ERROR;
+  }
+  File->position = position;
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Free Clusters
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint32_t free clusters, 0xFFFFFFFF = unknown until recount finishes
+ */
+uint32_t FAT32_Free_Clusters (FAT32_t * FAT32)
+{
+  return FAT32->free_count;
+}
+
+/**
+ * @brief   Recount Free Clusters In Steps
+ * @note    call repeatedly (e.g. from idle loop) while FSInfo free count is unknown,
+ *          position is kept in FAT32_t so the job resumes where previous step ended
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint16_t FAT sectors examined in this step
+ *
+ * @return  uint8_t FAT32_PENDING / FAT32_SUCCESS when count is known / FAT32_ERROR
+ */
+uint8_t FAT32_Recount (FAT32_t * FAT32, uint16_t sectors)
+{
+  uint8_t * buffer;
+  uint32_t end = FAT32->clusters + FAT32_CLUSTER_FIRST;
+
+  if (FAT32->recount == 0) {
+    return FAT32_SUCCESS;
+  }
+  if (FAT32->type == FAT32_TYPE_12) {
+    return FAT32_ERROR;                                                       // FAT12 read only, count unused
+  }
+  while (sectors-- && (FAT32->recount < end)) {
+    if (NULL == (buffer = FAT32_Read_Sector (FAT32->fat_area_begin + (FAT32->recount >> FAT32->fat_shift)))) {
+      return FAT32_ERROR;                                                     // position kept, step may be repeated
+    }
+#ifdef FAT32_FREEMAP
+    if ((FAT32->recount == FAT32_CLUSTER_FIRST) || ((FAT32->recount & ((1UL << FAT32_Freemap_Shift) - 1)) == 0)) {
+      FAT32_Freemap_Seen = 0;                                                 // region starts
+    }
+#endif
+    do {
+      if (((FAT32->type == FAT32_TYPE_16) ?
+           FAT32_Get_2Bytes_LE (&buffer[(FAT32->recount << 1) % BYTES_PER_SECTOR]) :
+           (FAT32_Get_4Bytes_LE (&buffer[(FAT32->recount << 2) % BYTES_PER_SECTOR]) & FAT32_CLUSTER_MASK)) == FAT32_CLUSTER_FREE) {
+        FAT32->recount_free++;
+#ifdef FAT32_FREEMAP
+        FAT32_Freemap_Seen = 1;
+#endif
+      }
+      FAT32->recount++;
+    } while ((FAT32->recount & ((1UL << FAT32->fat_shift) - 1)) && (FAT32->recount < end));
+#ifdef FAT32_FREEMAP
+    if (((FAT32->recount & ((1UL << FAT32_Freemap_Shift) - 1)) == 0) || (FAT32->recount == end)) {
+      FAT32_Freemap_Mark (FAT32_Freemap_Region (FAT32->recount - 1), !FAT32_Freemap_Seen);
+    }
+#endif
+  }
+  if (FAT32->recount < end) {
+    return FAT32_PENDING;
+  }
+  FAT32->free_count = FAT32->recount_free;
+  FAT32->recount = 0;
+  FAT32_FSInfo_Update (FAT32);
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Add Record Of File Created At End Of Root Directory
+ * @note    record, bucket and fingerprint are updated in place; fails when
+ *          records fill their room, table would be more than half full or
+ *          bucket sector is full, then index file has to be rebuilt
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t directory sector of new entry
+ * @param   uint8_t slot of new entry
+ *
+ * @return  uint8_t
+ */
+static uint8_t FAT32_Index_Append (FAT32_t * FAT32, uint32_t entry_sector, uint8_t entry_slot)
+{
+  uint8_t * buffer;
+  uint8_t name[13];
+  uint32_t filenum = FAT32->files + 1;
+  uint32_t keys = filenum;
+  uint32_t sector;
+  FAT32_Index_t Entry;
+  FAT32_Name_t Name;
+  FAT32_Record_t Record;
+  FAT32_SDIndex_t Header;
+  DE_t * DE;
+
+#ifdef FAT32_HASH_LONG_NAMES
+  keys <<= 1;
+#endif
+  if (!FAT32_Index_Valid || (filenum > FAT32_Index_Capacity) || (FAT32_Hash_Slots && (FAT32_Hash_Slots < (keys << 1)))) {
+    return FAT32_ERROR;
+  }
+
+  // Record - as scan of directory would form it
+  // ----------------------------------------------------------------
+  if (NULL == (buffer = FAT32_Read_Sector (entry_sector))) {
+    return FAT32_ERROR;
+  }
+  DE = (DE_t *) &buffer[entry_slot << 5];
+  Entry.sector = entry_sector;
+  Entry.slot = entry_slot;
+  Entry.lfn = 0;
+  Entry.attribute = DE->Attribute;
+  Entry.cluster = 0;
+  Entry.size = 0;
+  Entry.hash = FAT32_Hash (DE->Name, 11);
+  FAT32_Name_Init (&Name, name, sizeof (name));
+  FAT32_Name_Entry (&Name, DE);
+  FAT32_Record_Fill (&Record, &Entry, DE, &Name);
+  if (0 == (sector = FAT32_Index_Sector (FAT32, FAT32_Record_Position (filenum)))) {
+    return FAT32_ERROR;
+  }
+  if ((filenum - 1) % FAT32_SDINDEX_RECORDS) {
+    buffer = FAT32_Read_Sector (sector);
+  } else {
+    buffer = FAT32_Blank_Sector (sector);                                     // first record of sector, zero padded
+  }
+  if (buffer == NULL) {
+    return FAT32_ERROR;
+  }
+  memcpy (&buffer[FAT32_Record_Position (filenum) % BYTES_PER_SECTOR], &Record, sizeof (Record));
+  if (FAT32_ERROR == FAT32_Write_Sector (sector, buffer)) {
+    return FAT32_ERROR;
+  }
+
+  // Bucket - short name key only, no long name
+  // ----------------------------------------------------------------
+  if (FAT32_Hash_Slots) {
+    sector = FAT32_Index_Sector (FAT32, FAT32_Hash_Table (FAT32_Index_Capacity) +
+                                        ((Entry.hash & (FAT32_Hash_Slots - 1)) / FAT32_SDINDEX_BUCKETS) * BYTES_PER_SECTOR);
+    if ((sector == 0) ||
+        (NULL == (buffer = FAT32_Read_Sector (sector))) ||
+        (FAT32_ERROR == FAT32_Hash_Place (buffer, Entry.hash, filenum)) ||
+        (FAT32_ERROR == FAT32_Write_Sector (sector, buffer))) {
+      return FAT32_ERROR;
+    }
+  }
+
+  // Header - written last, views lack new file
+  // ----------------------------------------------------------------
+  if ((FAT32_ERROR == FAT32_Index_Read (FAT32, 0, (uint8_t *) &Header, sizeof (Header))) ||
+      (FAT32_ERROR == FAT32_Root_Fingerprint (FAT32, &Header, 0)) ||
+      (0 == (sector = FAT32_Index_Sector (FAT32, 0))) ||
+      (NULL == (buffer = FAT32_Read_Sector (sector)))) {
+    return FAT32_ERROR;
+  }
+  FAT32_Put_4Bytes_LE (Header.Entries, filenum);
+  Header.Sorted = 0;
+  memcpy (buffer, &Header, sizeof (Header));
+  if (FAT32_ERROR == FAT32_Write_Sector (sector, buffer)) {
+    return FAT32_ERROR;
+  }
+  FAT32->files = filenum;
+  FAT32_Sort_Views = 0;
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Create Empty File In Root Directory
+ * @note    short name 8.3 only, fails if file exists
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
+ * @param   char * name "NAME.EXT"
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Create (FAT32_t * FAT32, FAT32_File_t * File, char * name)
+{
+  DE_t * DE;
+  uint8_t i;
+  uint8_t slot = 0;
+  uint8_t append = 0;
+  uint8_t name83[11];
+  uint8_t tail[4];
+  uint8_t * buffer;
+  uint32_t sector = 0;
+  uint32_t last = FAT32->root_dir_clus_num;
+  uint32_t cluster = FAT32->root_dir_clus_num;
+  size_t length = strlen (name);
+  FAT32_Index_t Entry;
+
+  // Checking
+  // ----------------------------------------------------------------
+  if ((length > 12) || (0 == FAT32_Name_83 (name, length, name83)) || (name83[0] == '.')) {
+    return FAT32_ERROR;
+  }
+  if (FAT32->type == FAT32_TYPE_12) {
+    return FAT32_ERROR;                                                       // FAT12 read only
+  }
+  if (0 != FAT32_Dir_Find (FAT32, FAT32->root_dir_clus_num, name, length, &Entry)) {
+    return FAT32_ERROR;                                                       // file exists
+  }
+
+  // Free Slot - end of directory kept by index file
+  // ----------------------------------------------------------------
+  if (FAT32_Index_Valid &&
+      (FAT32_SUCCESS == FAT32_Index_Read (FAT32, offsetof (FAT32_SDIndex_t, TailSector), tail, sizeof (tail)))) {
+    append = 1;
+    if (last >= FAT32_CLUSTER_FIRST) {
+      last = (FAT32_Get_4Bytes_LE (tail) - FAT32->cluster_base) >> FAT32->cluster_shift;
+    }
+    if (NULL == (buffer = FAT32_Read_Sector (FAT32_Get_4Bytes_LE (tail)))) {
+      return FAT32_ERROR;
+    }
+    for (slot = 0; slot < (BYTES_PER_SECTOR >> 5); slot++) {
+      if (buffer[slot << 5] == FAT32_DE_END) {                                // deleted entries before end not reused
+        sector = FAT32_Get_4Bytes_LE (tail);
+        break;
+      }
+    }
+  } else {
+
+    // Free Slot - deleted entry or end of directory, index file stale
+    // --------------------------------------------------------------
+    do {
+      last = cluster;
+      for (i = 0; (i < FAT32_Cluster_Sectors (FAT32, cluster)) && !sector; i++) {
+        if (NULL == (buffer = FAT32_Read_Sector (FAT32_Get_1st_Sector_Of_Clus (FAT32, cluster) + i))) {
+          return FAT32_ERROR;
+        }
+        for (slot = 0; slot < (BYTES_PER_SECTOR >> 5); slot++) {
+          if ((buffer[slot << 5] == FAT32_DE_END) || (buffer[slot << 5] == FAT32_DE_UNUSED)) {
+            sector = FAT32_Get_1st_Sector_Of_Clus (FAT32, cluster) + i;
+            break;
+          }
+        }
+      }
+      cluster = FAT32_FAT_Next_Cluster (FAT32, cluster) & FAT32_CLUSTER_MASK;
+    } while (!sector && (cluster >= FAT32_CLUSTER_FIRST) && (cluster < FAT32_CLUSTER_EOC));
+  }
+
+  // Directory Full - append zeroed cluster
+  // ----------------------------------------------------------------
+  if (!sector) {
+    if ((last == FAT32_CLUSTER_ROOT) || (0 == (cluster = FAT32_Cluster_Alloc (FAT32, last)))) {
+      return FAT32_ERROR;
+    }
+    sector = FAT32_Get_1st_Sector_Of_Clus (FAT32, cluster);
+    for (i = 0; i < FAT32->sectors_per_cluster; i++) {
+      if ((NULL == (buffer = FAT32_Blank_Sector (sector + i))) ||
+          (FAT32_ERROR == FAT32_Write_Sector (sector + i, buffer))) {
+        return FAT32_ERROR;
+      }
+    }
+    slot = 0;
+  }
+
+  // Directory Entry
+  // ----------------------------------------------------------------
+  if (NULL == (buffer = FAT32_Read_Sector (sector))) {
+    return FAT32_ERROR;
+  }
+  DE = (DE_t *) &buffer[slot << 5];
+  memset (DE, 0, sizeof (DE_t));
+  memcpy (DE->Name, name83, 11);
+  DE->Attribute = FAT32_ATTR_ARCHIVE;
+  FAT32_Put_2Bytes_LE (DE->CreateDate, 0x0021);                               // 1.1.1980, no clock
+  FAT32_Put_2Bytes_LE (DE->ChangeDate, 0x0021);
+  if (FAT32_ERROR == FAT32_Write_Sector (sector, buffer)) {
+    return FAT32_ERROR;
+  }
+  FAT32_File_Init (File, 0, 0);
+  File->entry_sector = sector;
+  File->entry_slot = slot;
+
+  // Root Directory Changed - new last file, else new numbering of files
+  // ----------------------------------------------------------------
+  FAT32_Scan.first_cluster = 0;
+  if (!append || (FAT32_ERROR == FAT32_Index_Append (FAT32, sector, slot))) {
+    FAT32_Index_File (FAT32);
+  }
+
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Append Data To File
+ * @note    data always go to end of file, clusters preallocated behind end
+ *          of file are used before new ones are allocated; inside run from
+ *          FAT32_Allocate no FAT is read and whole sectors are streamed
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
+ * @param   uint8_t * buffer
+ * @param   uint16_t number of bytes
+ *
+ * @return  uint16_t number of bytes written
+ */
+uint16_t FAT32_Write (FAT32_t * FAT32, FAT32_File_t * File, uint8_t * buffer, uint16_t length)
+{
+  uint8_t * data;
+  uint16_t chunk;
+  uint16_t offset;
+  uint16_t written = 0;
+  uint32_t sector;
+  uint32_t cluster;
+  uint8_t shift = BYTES_PER_SECTOR_SHIFT + FAT32->cluster_shift;            // log2 bytes per cluster
+
+  if ((!File->open) || (File->entry_sector == 0)) {
+    return 0;
+  }
+  File->position = File->size;
+
+  while (written < length) {
+
+    // Next Cluster
+    // ----------------------------------------------------------------
+    if ((File->position & ((1UL << shift) - 1)) == 0) {
+      if (File->first_cluster == 0) {
+        if (0 == (cluster = FAT32_Cluster_Alloc (FAT32, 0))) {
+          break;                                                              // card full
+        }
+        File->first_cluster = cluster;
+      } else if (File->position == 0) {
+        cluster = File->first_cluster;
+      } else {
+        File->position--;                                                     // last byte of file
+        if (FAT32_ERROR == FAT32_File_Locate (FAT32, File)) {
+          File->position++;
+          break;
+        }
+        File->position++;
+        if ((File->cluster >= File->reserved_first) && (File->cluster < File->reserved_last)) {
+          cluster = File->cluster + 1;                                        // preallocated run, no FAT read
+        } else {
+          cluster = FAT32_FAT_Next_Cluster (FAT32, File->cluster) & FAT32_CLUSTER_MASK;
+          if ((cluster < FAT32_CLUSTER_FIRST) || (cluster >= FAT32_CLUSTER_EOC)) {
+            if (0 == (cluster = FAT32_Cluster_Alloc (FAT32, File->cluster))) {
+              break;
+            }
+          }
+        }
+      }
+      File->cluster = cluster;
+      File->cluster_index = File->position >> shift;
+      File->dirty = 1;
+      FAT32_File_Checkpoint (File);
+    }
+    if (0 == (sector = FAT32_File_Sector (FAT32, File))) {
+      break;
+    }
+
+    // Whole Sector Directly, Partial Sector Through Cache
+    // ----------------------------------------------------------------
+    offset = File->position % BYTES_PER_SECTOR;
+    chunk = BYTES_PER_SECTOR - offset;
+    if (chunk > (length - written)) {
+      chunk = length - written;
+    }
+    if ((chunk == BYTES_PER_SECTOR) && (File->cluster >= File->reserved_first) && (File->cluster <= File->reserved_last)) {
+      if (FAT32_ERROR == FAT32_Stream_Write (sector, buffer + written)) {   // preallocated run
+        break;
+      }
+    } else {
+      if (chunk == BYTES_PER_SECTOR) {
+        data = buffer + written;
+      } else {
+        data = NULL;
+#ifdef FAT32_JOURNAL
+        data = FAT32_Data_Read (sector, offset == 0);                         // held FAT sector stays cached
+#endif
+        if (data == NULL) {
+          data = offset ? FAT32_Read_Sector (sector) : FAT32_Blank_Sector (sector);
+        }
+        if (data == NULL) {
+          break;
+        }
+        memcpy (data + offset, buffer + written, chunk);
+      }
+      if (FAT32_ERROR == FAT32_Write_Sector (sector, data)) {
+        break;
+      }
+    }
+    File->position += chunk;
+    File->size = File->position;
+    File->dirty = 1;
+    written += chunk;
+  }
+
+  return written;
+}
 
 /**
- * @brief   FAT32 Init
+ * @brief   Write Size And First Cluster Into Directory Entry
+ * @note    with journal FAT and entry intents committed by one sector write first
  *
- * @param   FAT32_t * FAT32 structure
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
  *
  * @return  uint8_t
  */
-uint8_t FAT32_Init (FAT32_t * FAT32)
+uint8_t FAT32_Flush (FAT32_t * FAT32, FAT32_File_t * File)
 {
-  // SD Card Init
-  // -------------------------------------------------------------------------------------
-  SD sd = { .voltage = 0, .sdhc = 0, .version = 0 };
-  if (SD_Init (&sd) == SD_ERROR) {
-    return FAT32_ERROR;
-  }
+  uint8_t * buffer;
+  DE_t * DE;
 
-  // MBR - Read Master Boot Record
+  if (FAT32_ERROR == FAT32_Stream_Stop ()) {
+    return FAT32_ERROR;                                                       // last streamed sector not written
+  }
+  if (!File->dirty) {
+    return FAT32_SUCCESS;
+  }
+#ifdef FAT32_JOURNAL
+  // Entry Intent - committed with FAT intents before entry is written
   // ----------------------------------------------------------------
-  if (FAT32_ERROR == FAT32_Read_Master_Boot_Record (FAT32)) {
+  if (FAT32_ERROR == FAT32_Journal_Intent (FAT32_INTENT_ENTRY, File->entry_slot, File->entry_sector,
+                                           File->size, File->first_cluster)) {
     return FAT32_ERROR;
   }
-  // BS - Read Boot Sector
-  // ----------------------------------------------------------------
-  if (FAT32_ERROR == FAT32_Read_Boot_Sector (FAT32)) {
+#endif
+  if (NULL == (buffer = FAT32_Read_Sector (File->entry_sector))) {
+    return FAT32_ERROR;
+  }
+#ifdef FAT32_JOURNAL
+  if (FAT32_ERROR == FAT32_Journal_Commit ()) {
+    return FAT32_ERROR;
+  }
+#endif
+  DE = (DE_t *) &buffer[File->entry_slot << 5];
+  FAT32_Put_2Bytes_LE (DE->FirstClustHI, File->first_cluster >> 16);
+  FAT32_Put_2Bytes_LE (DE->FirstClustLO, File->first_cluster & 0xFFFF);
+  FAT32_Put_4Bytes_LE (DE->FileSize, File->size);
+  if (FAT32_ERROR == FAT32_Write_Sector (File->entry_sector, buffer)) {
     return FAT32_ERROR;
   }
+  File->dirty = 0;
+#ifdef FAT32_JOURNAL
+  FAT32_Data_Release ();                                                      // end of write burst
+#endif
+
+  FAT32_Index_Update (FAT32, File);
+  FAT32_FSInfo_Update (FAT32);                                                // hint only, failure harmless
 
   return FAT32_SUCCESS;
 }
 
 /**
- * @brief   Read Master Boot Record
+ * @brief   Preallocate Contiguous Clusters Behind End Of File
+ * @note    run is chained first with each FAT sector written once, then linked
+ *          to end of chain, so interruption leaves lost clusters only; file size
+ *          keeps counting written data, unused clusters are freed by FAT32_Close
  *
  * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle opened for writing
+ * @param   uint32_t number of clusters
+ * @param   uint8_t 1 - erase run on card, 0 - keep content
  *
  * @return  uint8_t
  */
-uint8_t FAT32_Read_Master_Boot_Record (FAT32_t * FAT32)
+uint8_t FAT32_Allocate (FAT32_t * FAT32, FAT32_File_t * File, uint32_t clusters, uint8_t discard)
 {
-  uint8_t buffer[512];
+  uint32_t next;
+  uint32_t first;
+  uint32_t cluster;
+  uint32_t last = 0;
 
-  // Read MBR / Master Boot Record
-  // ----------------------------------------------------------------
-  SD_Read_Block (0, buffer);
-  MBR_t * MBR = (MBR_t *) buffer;
-  
-  // Checking
-  // ----------------------------------------------------------------
-  if ((FAT32_Get_2Bytes_LE (MBR->Signature) != FAT32_SIGNATURE)) {            // check signature 0xAA55
+  if ((!File->open) || (File->entry_sector == 0) || (clusters == 0)) {
     return FAT32_ERROR;
   }
-  if (MBR->Partition1.Status & PE_STATUS_ACTIVE_FLAG) {                       // only 0x80 or 0x00 status accepted
-    return FAT32_ERROR;
+
+  // Last Cluster Of Chain - behind clusters allocated earlier
+  // ----------------------------------------------------------------
+  if (File->first_cluster) {
+    File->position = File->size ? (File->size - 1) : 0;
+    if (FAT32_ERROR == FAT32_File_Locate (FAT32, File)) {
+      return FAT32_ERROR;
+    }
+    last = File->cluster;
+    while (((next = FAT32_FAT_Next_Cluster (FAT32, last) & FAT32_CLUSTER_MASK) >= FAT32_CLUSTER_FIRST) &&
+           (next < FAT32_CLUSTER_EOC)) {
+      last = next;
+    }
   }
-  if ((MBR->Partition1.TypeCode != PE_TYPECODE_FAT32) &&                      // only FAT32 or FAT32LBA type code accepted
-      (MBR->Partition1.TypeCode != PE_TYPECODE_FAT32LBA)) {
+  if (0 == (first = FAT32_Cluster_Find (FAT32, clusters))) {
+    return FAT32_ERROR;                                                       // no run long enough
+  }
+
+  // Chain Run - every FAT sector written once
+  // ----------------------------------------------------------------
+  if (FAT32_ERROR == FAT32_Cluster_Chain (FAT32, first, clusters)) {
     return FAT32_ERROR;
   }
 
-  // LBA Begin Address
+  // Link Run To File
+  // ----------------------------------------------------------------
+  if (last) {
+    if ((FAT32_ERROR == FAT32_FAT_Set (FAT32, last, first)) ||
+        (FAT32_ERROR == FAT32_FAT_Write (FAT32, last))) {
+      return FAT32_ERROR;
+    }
+  } else {
+    File->first_cluster = first;
+    File->cluster = first;
+    File->cluster_index = 0;
+    File->checkpoints = 0;
+    File->dirty = 1;
+  }
+  File->position = File->size;
+  File->reserved_first = first;
+  File->reserved_last = first + clusters - 1;
+
+  // Discard - hint only, card may ignore it
   // ----------------------------------------------------------------
-  FAT32->lba_begin = FAT32_Get_4Bytes_LE (MBR->Partition1.LBA_Begin);         // LBA begin address
+  if (discard) {
+    if (FAT32_ERROR == FAT32_Stream_Stop ()) {
+      return FAT32_ERROR;                                                     // card busy with open transfer
+    }
+    cluster = FAT32_Get_1st_Sector_Of_Clus (FAT32, first);
+    next = cluster + (clusters << FAT32->cluster_shift) - 1;
+    if (SD_SUCCESS == SD_Erase (cluster, next)) {
+      if ((FAT32_Cache_Sector >= cluster) && (FAT32_Cache_Sector <= next)) {
+        FAT32_Cache_Sector = 0xFFFFFFFF;
+      }
+    }
+  }
 
   return FAT32_SUCCESS;
 }
 
 /**
- * @brief   Read Master Boot Record
+ * @brief   Free Preallocated Clusters Behind End Of File
+ * @note    chain cut behind cluster of last byte before tail is freed, so
+ *          interruption leaves lost clusters only; empty file loses its first
+ *          cluster in directory entry first
  *
  * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle with flushed directory entry
  *
  * @return  uint8_t
  */
-uint8_t FAT32_Read_Boot_Sector (FAT32_t * FAT32)
+static uint8_t FAT32_Reserved_Trim (FAT32_t * FAT32, FAT32_File_t * File)
 {
-  uint8_t buffer[512];
-  uint16_t reserved_sectors;
-  uint32_t sector_per_fats;
-  uint32_t root_dir_clus;
-
-  // Read Boot Sector with BIOS Parameter Block
-  // ----------------------------------------------------------------
-  SD_Read_Block (FAT32->lba_begin, buffer);                                   // 2048 = 0x00000800
-  BS_t * BS = (BS_t *) buffer;
+  uint32_t next;
 
-  // Checking
-  // ----------------------------------------------------------------
-  if ((FAT32_Get_2Bytes_LE (BS->Signature) != FAT32_SIGNATURE)) {             // check signature 0xAA55
-    return FAT32_ERROR;
+  if (File->reserved_last == 0) {
+    return FAT32_SUCCESS;
   }
-  if ((FAT32_Get_2Bytes_LE (BS->BytesPerSector) != BYTES_PER_SECTOR)) {       // only 512 bytes per sector accepted
-    return FAT32_ERROR;
+  if (File->size == 0) {
+    next = File->first_cluster;
+    File->first_cluster = 0;
+    File->dirty = 1;
+    if (FAT32_ERROR == FAT32_Flush (FAT32, File)) {
+      File->first_cluster = next;
+      return FAT32_ERROR;
+    }
+  } else {
+    File->position = File->size - 1;
+    if (FAT32_ERROR == FAT32_File_Locate (FAT32, File)) {
+      return FAT32_ERROR;
+    }
+    next = FAT32_FAT_Next_Cluster (FAT32, File->cluster) & FAT32_CLUSTER_MASK;
+    if ((next >= FAT32_CLUSTER_FIRST) && (next < FAT32_CLUSTER_EOC)) {
+      if ((FAT32_ERROR == FAT32_FAT_Set (FAT32, File->cluster, FAT32_CLUSTER_MASK)) ||
+          (FAT32_ERROR == FAT32_FAT_Write (FAT32, File->cluster))) {
+        return FAT32_ERROR;
+      }
+    }
   }
-  if (BS->NumberOfFATs != FAT32_NUM_OF_FATS) {                                // only 2 FAT tables accepted
+  if (FAT32_ERROR == FAT32_Chain_Free (FAT32, next)) {
     return FAT32_ERROR;
   }
+  File->reserved_first = 0;
+  File->reserved_last = 0;
+  FAT32_FSInfo_Update (FAT32);                                                // hint only, failure harmless
 
-  // Calculations
-  // ----------------------------------------------------------------
-  reserved_sectors = FAT32_Get_2Bytes_LE (BS->ReservedSectors);
-  sector_per_fats = FAT32_Get_4Bytes_LE (BS->BigSectorsPerFAT);
-  root_dir_clus = FAT32_Get_4Bytes_LE (BS->RootDirClusNo);
+  return FAT32_SUCCESS;
+}
 
-  FAT32->root_dir_clus_num = root_dir_clus;
-  FAT32->sectors_per_cluster = BS->SectorsPerCluster;
-  FAT32->fat_area_begin = FAT32->lba_begin + reserved_sectors;
-  FAT32->data_area_begin = FAT32->fat_area_begin + (BS->NumberOfFATs * sector_per_fats);
+/**
+ * @brief   Close File
+ * @note    flushes directory entry of written file, frees unused preallocated
+ *          clusters, checkpoints journal
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_File_t * file handle
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Close (FAT32_t * FAT32, FAT32_File_t * File)
+{
+  if (!File->open) {
+    return FAT32_ERROR;
+  }
+  if ((FAT32_ERROR == FAT32_Flush (FAT32, File)) ||
+      (FAT32_ERROR == FAT32_Reserved_Trim (FAT32, File))) {
+    return FAT32_ERROR;                                                       // handle stays open
+  }
+  File->open = 0;
+#ifdef FAT32_JOURNAL
+  FAT32_Journal_Close ();                                                      // failure harmless, replayed at mount
+#endif
 
   return FAT32_SUCCESS;
 }
 
 /**
- * @brief   Read Root Directory
+ * @brief   Fragmentation Of File
+ * @note    cluster chain walked, no data read
  *
  * @param   FAT32_t * FAT32
+ * @param   FAT32_Index_t * directory entry
+ * @param   FAT32_Fragments_t * report
  *
- * @return  uint32_t
- *  */
-uint32_t FAT32_Root_Dir_Files (FAT32_t * FAT32)
+ * @return  uint8_t FAT32_ERROR if chain is broken
+ */
+uint8_t FAT32_Fragments (FAT32_t * FAT32, FAT32_Index_t * Entry, FAT32_Fragments_t * Fragments)
 {
-  DE_t * DE;
-  uint8_t sectors = FAT32->sectors_per_cluster;                               // number of sectors in cluster;
-  uint8_t buffer[BYTES_PER_SECTOR];
+  uint32_t next;
+  uint32_t seek;
+  uint32_t cluster = Entry->cluster;
+
+  memset (Fragments, 0, sizeof (FAT32_Fragments_t));
+  if (cluster == 0) {
+    return FAT32_SUCCESS;                                                     // empty file
+  }
+  while (1) {
+    if ((cluster < FAT32_CLUSTER_FIRST) || (cluster >= (FAT32->clusters + FAT32_CLUSTER_FIRST)) ||
+        (Fragments->clusters == FAT32->clusters)) {
+      return FAT32_ERROR;                                                     // out of volume or loop
+    }
+    if (Fragments->clusters++ == 0) {
+      Fragments->extents = 1;
+    }
+    next = FAT32_FAT_Next_Cluster (FAT32, cluster) & FAT32_CLUSTER_MASK;
+    if (next >= FAT32_CLUSTER_EOC) {
+      break;
+    }
+    if (next != (cluster + 1)) {
+      Fragments->extents++;
+      seek = (next > cluster) ? (next - cluster - 1) : (cluster + 1 - next);
+      if (seek > Fragments->worst_seek) {
+        Fragments->worst_seek = seek;
+      }
+    }
+    cluster = next;
+  }
+  Fragments->average = Fragments->clusters / Fragments->extents;
 
+  return FAT32_SUCCESS;
+}
+
+/**
+ * @brief   Move File Into Contiguous Run
+ * @note    data copied by multiple block reads and writes, then run chained,
+ *          directory entry pointed to run, old chain freed; interruption leaves
+ *          complete file and lost clusters only; offline, no file may be open
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_Index_t * directory entry, first cluster updated
+ * @param   uint8_t * buffer for copy
+ * @param   uint16_t sectors of buffer
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Defragment (FAT32_t * FAT32, FAT32_Index_t * Entry, uint8_t * buffer, uint16_t sectors)
+{
+  uint8_t * cache;
+  uint16_t i;
+  uint16_t count;
+  uint32_t next;
+  uint32_t first;
+  uint32_t length;
+  uint32_t target;
+  uint32_t cluster;
   uint32_t sector;
-  uint32_t files = 0;
-  uint32_t cluster = FAT32->root_dir_clus_num;                                // next cluster of root directory
+  uint32_t done;
+  DE_t * DE;
+  FAT32_File_t File;
+  FAT32_Fragments_t Fragments;
 
-  do {
+  if ((Entry->attribute & FAT32_ATTR_DIRECTORY) || (sectors == 0) ||
+      (FAT32_Index_Handle.open && (Entry->cluster == FAT32_Index_Handle.first_cluster))) {
+    return FAT32_ERROR;                                                       // index file addressed directly
+  }
+  if (NULL == (cache = FAT32_Read_Sector (Entry->sector))) {
+    return FAT32_ERROR;
+  }
+  DE = (DE_t *) &cache[Entry->slot << 5];
+  if ((((uint32_t) FAT32_Get_2Bytes_LE (DE->FirstClustHI) << 16) | FAT32_Get_2Bytes_LE (DE->FirstClustLO)) != Entry->cluster) {
+    return FAT32_ERROR;                                                       // entry outdated
+  }
+  if (FAT32_ERROR == FAT32_Fragments (FAT32, Entry, &Fragments)) {
+    return FAT32_ERROR;                                                       // broken chain kept as is
+  }
+  if (Fragments.extents <= 1) {
+    return FAT32_SUCCESS;
+  }
+  if (0 == (first = FAT32_Cluster_Find (FAT32, Fragments.clusters))) {
+    return FAT32_ERROR;                                                       // no run long enough, FAT12
+  }
 
-    sector = FAT32_Get_1st_Sector_Of_Clus (FAT32, cluster);                   // 1st sector of cluster
-
-    // Read Cluster
-    // ----------------------------------------------------------------    
-    while (sectors--) {
-      // Read Sector
-      // --------------------------------------------------------------
-      SD_Read_Block (sector++, buffer);
-      // Read Root Directory Entries
-      // --------------------------------------------------------------
-      for (uint16_t i=0; i<BYTES_PER_SECTOR; i=i+32) {
-        DE = (DE_t *) &buffer[i];
-        if (DE->Name[0] == FAT32_DE_END) {      
-          return files;                                                       // end of files
-        } else if (DE->Name[0] != FAT32_DE_UNUSED) {                          // deleted files
-          if (((DE->Name[0] >> 4) != 0x04) &&                                 // end of long file name
-              (DE->Name[0] > 0x20)) {                                         // !!! except 0x05
-            files++;                                                          // count files
-          }
+  // Copy Data - extent by extent into free run, not referenced yet
+  // ----------------------------------------------------------------
+  target = FAT32_Get_1st_Sector_Of_Clus (FAT32, first);
+  cluster = Entry->cluster;
+  while ((cluster >= FAT32_CLUSTER_FIRST) && (cluster < FAT32_CLUSTER_EOC)) {
+    for (length = 1; (next = FAT32_FAT_Next_Cluster (FAT32, cluster + length - 1) & FAT32_CLUSTER_MASK) == (cluster + length); length++) {
+      ;
+    }
+    sector = FAT32_Get_1st_Sector_Of_Clus (FAT32, cluster);
+    length <<= FAT32->cluster_shift;
+    for (done = 0; done < length; done += count) {
+      count = ((length - done) < sectors) ? (length - done) : sectors;
+      if (FAT32_ERROR == FAT32_Read_Run (sector + done, buffer, count)) {
+        return FAT32_ERROR;
+      }
+      for (i = 0; i < count; i++) {
+        if (FAT32_ERROR == FAT32_Stream_Write (target++, &buffer[i << BYTES_PER_SECTOR_SHIFT])) {
+          return FAT32_ERROR;
         }
       }
     }
+    cluster = next;
+  }
+  if (FAT32_ERROR == FAT32_Stream_Stop ()) {
+    return FAT32_ERROR;
+  }
 
-    cluster = FAT32_FAT_Next_Cluster (FAT32, cluster);                        // get next cluster
-    cluster &= 0x0FFFFFFF;                                                    // mask first nibble
+  // Chain Run, Then Point Directory Entry To It - single sector write
+  // ----------------------------------------------------------------
+  if (FAT32_ERROR == FAT32_Cluster_Chain (FAT32, first, Fragments.clusters)) {
+    return FAT32_ERROR;
+  }
+  FAT32_File_Init (&File, first, Entry->size);
+  File.entry_sector = Entry->sector;
+  File.entry_slot = Entry->slot;
+  File.dirty = 1;
+  if (FAT32_ERROR == FAT32_Flush (FAT32, &File)) {
+    return FAT32_ERROR;
+  }
 
-  } while (cluster < 0x0FFFFFF8);                                             // 0x?ffffff8 - 0x?fffffff = Last cluster in file (EOC)
+  // Free Old Chain - each FAT sector written once it is left
+  // ----------------------------------------------------------------
+  cluster = Entry->cluster;
+  Entry->cluster = first;
+  if (FAT32_ERROR == FAT32_Chain_Free (FAT32, cluster)) {
+    return FAT32_ERROR;
+  }
+  FAT32_FSInfo_Update (FAT32);                                                // hint only, failure harmless
 
-  return files;
+  return FAT32_SUCCESS;
 }
 
 /**
- * @brief   Read Next Cluster From FAT
+ * --------------------------------------------------------------------------------------------+
+ * PRIMITIVE / PRIVATE FUNCTIONS
+ * --------------------------------------------------------------------------------------------+
+ */
+
+/**
+ * @brief   Read Sector Through Sector Cache
  *
- * @param   FAT32_t * FAT32
- * @param   uint32_t cluster position in FAT
+ * @param   uint32_t sector
  *
- * @return  uint32_t
+ * @return  uint8_t * => cached sector, NULL if read failed
  */
-uint32_t FAT32_FAT_Next_Cluster (FAT32_t * FAT32, uint32_t cluster_pos_in_FAT)
+uint8_t * FAT32_Read_Sector (uint32_t sector)
 {
-  uint8_t buffer[512];
-
-  uint32_t next_cluster;
-  uint32_t packet = cluster_pos_in_FAT << 2;                                  // sequel * 4
-  uint32_t sector = FAT32->fat_area_begin + packet / BYTES_PER_SECTOR;        // fats_begin + next block for SD read
-  uint32_t offset = packet - (sector * BYTES_PER_SECTOR);                     // packet % 512
-
-  // Read Directory Entries
-  // ----------------------------------------------------------------
-  SD_Read_Block (sector, buffer);
-  next_cluster = FAT32_Get_4Bytes_LE (&buffer[offset]);
+  if (sector != FAT32_Cache_Sector) {
+    if (FAT32_ERROR == FAT32_Cache_Clean ()) {
+      return NULL;
+    }
+    FAT32_Stream_Stop ();
+    if (SD_START_TOKEN != SD_Read_Block (sector, FAT32_Cache)) {
+      FAT32_Cache_Sector = 0xFFFFFFFF;                                        // invalidate
+      return NULL;
+    }
+    FAT32_Cache_Sector = sector;
+  }
 
-  return next_cluster;
+  return FAT32_Cache;
 }
 
 /**
- * @brief   Get Address (Offset) Of 1st Sector Of Cluster Number
+ * @brief   Read Sector Through Sector Cache As Part Of Multiple Block Read
+ * @note    consecutive sectors continue one transfer, for sequential scans (FAT)
  *
- * @param   FAT32_t * FAT32
- * @param   uint32_t cluster number
+ * @param   uint32_t sector
  *
- * @return  uint32_t
- *  */
-uint32_t FAT32_Get_1st_Sector_Of_Clus (FAT32_t * FAT32, uint32_t cluster)
+ * @return  uint8_t * => cached sector, NULL if read failed
+ */
+uint8_t * FAT32_Read_Stream (uint32_t sector)
 {
-  return (FAT32->data_area_begin + ((cluster - FAT32->root_dir_clus_num) * FAT32->sectors_per_cluster));
+  if (sector == FAT32_Cache_Sector) {
+    return FAT32_Cache;
+  }
+  if (FAT32_ERROR == FAT32_Cache_Clean ()) {
+    return NULL;
+  }
+  if ((sector != FAT32_Stream) || !FAT32_Stream_Read) {
+    FAT32_Stream_Stop ();
+    if (SD_SUCCESS != SD_Read_Start (sector)) {
+      FAT32_Cache_Sector = 0xFFFFFFFF;
+      return NULL;
+    }
+    FAT32_Stream_Read = 1;
+  }
+  FAT32_Stream = sector + 1;
+  if (SD_START_TOKEN != SD_Read_Next (FAT32_Cache)) {
+    FAT32_Stream_Stop ();
+    FAT32_Cache_Sector = 0xFFFFFFFF;                                          // invalidate
+    return NULL;
+  }
+  FAT32_Cache_Sector = sector;
+
+  return FAT32_Cache;
 }
 
 /**
- * @brief   Get File Info from Root Directory
+ * @brief   Zero Run Of Sectors
+ * @note    one multiple block write, cache dropped
  *
- * @param   FAT32_t * FAT32
- * @param   uint8_t file number
+ * @param   uint32_t first sector
+ * @param   uint32_t number of sectors
  *
- * @return  DE_t * => directory entry
- *  */
-DE_t * FAT32_Get_File_Info (FAT32_t * FAT32, uint8_t filenum)
+ * @return  uint8_t
+ */
+uint8_t FAT32_Zero_Sectors (uint32_t sector, uint32_t count)
 {
-  DE_t * DE;
-  uint8_t sectors = FAT32->sectors_per_cluster;                               // number of sectors in cluster
-  uint8_t buffer[BYTES_PER_SECTOR];
+  uint8_t response = FAT32_SUCCESS;
 
-  uint32_t sector;
-  uint32_t files = 0;
-  uint32_t cluster = FAT32->root_dir_clus_num;                                // next cluster of root directory
+  if (FAT32_ERROR == FAT32_Cache_Clean ()) {
+    return FAT32_ERROR;
+  }
+  memset (FAT32_Cache, 0, BYTES_PER_SECTOR);
+  FAT32_Cache_Sector = 0xFFFFFFFF;
+  while (count--) {
+    if (FAT32_ERROR == FAT32_Stream_Write (sector++, FAT32_Cache)) {
+      response = FAT32_ERROR;
+      break;
+    }
+  }
+  if (FAT32_ERROR == FAT32_Stream_Stop ()) {
+    response = FAT32_ERROR;
+  }
 
-  do {
+  return response;
+}
 
-    sector = FAT32_Get_1st_Sector_Of_Clus (FAT32, cluster);                   // 1st sector of cluster
-
-    // Read Cluster
-    // ----------------------------------------------------------------    
-    while (sectors--) {
-      // Read Sector
-      // --------------------------------------------------------------
-      SD_Read_Block (sector++, buffer);
-      // Read Root Directory Entries
-      // --------------------------------------------------------------
-      for (uint16_t i=0; i<BYTES_PER_SECTOR; i=i+32) {
-        DE = (DE_t *) &buffer[i];
-        if (DE->Name[0] == FAT32_DE_END) {      
-          return DE;                                                          // end of files
-        } else if (DE->Name[0] != FAT32_DE_UNUSED) {                          // deleted files
-          if (((DE->Name[0] >> 4) != 0x04) &&                                 // end of long file name
-              (DE->Name[0] > 0x20)) {                                         // !!! except 0x05
-            if (++files == filenum) {
-              return DE;
-            }
-          }
-        }
-      }
+/**
+ * @brief   Drop Content Of Sector Cache
+ * @note    after card change, or when other driver shares the cache;
+ *          dirty FAT sector written first
+ *
+ * @param   void
+ *
+ * @return  void
+ */
+void FAT32_Cache_Invalidate (void)
+{
+  FAT32_Cache_Clean ();                                                       // failure left to replay
+  FAT32_Stream_Stop ();
+  FAT32_Cache_Sector = 0xFFFFFFFF;
+#ifdef FAT32_JOURNAL
+  FAT32_Data_Release ();
+#endif
+}
+
+/**
+ * @brief   Write Sector, Keep Sector Cache Coherent
+ *
+ * @param   uint32_t sector
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Write_Sector (uint32_t sector, uint8_t * buffer)
+{
+  FAT32_Stream_Stop ();
+  if (SD_SUCCESS != SD_Write_Block (sector, buffer)) {
+    if (sector == FAT32_Cache_Sector) {
+      FAT32_Cache_Sector = 0xFFFFFFFF;                                        // content unknown
     }
+#ifdef FAT32_JOURNAL
+    if (sector == FAT32_Data_Sector) {
+      FAT32_Data_Sector = 0xFFFFFFFF;
+    }
+#endif
+    return FAT32_ERROR;
+  }
+  if ((sector == FAT32_Cache_Sector) && (buffer != FAT32_Cache)) {
+    memcpy (FAT32_Cache, buffer, BYTES_PER_SECTOR);
+  }
+#ifdef FAT32_JOURNAL
+  if ((sector == FAT32_Data_Sector) && (buffer != FAT32_Data_Buffer)) {
+    memcpy (FAT32_Data_Buffer, buffer, BYTES_PER_SECTOR);
+  }
+#endif
+
+  return FAT32_SUCCESS;
+}
 
-    cluster = FAT32_FAT_Next_Cluster (FAT32, cluster);                        // get next cluster
-    cluster &= 0x0FFFFFFF;                                                    // mask first nibble
+/**
+ * @brief   Write Sector As Part Of Multiple Block Write
+ * @note    consecutive sectors continue one transfer (logs, copies),
+ *          transfer ends with next other card access
+ *
+ * @param   uint32_t sector
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Write_Stream (uint32_t sector, uint8_t * buffer)
+{
+  return FAT32_Stream_Write (sector, buffer);
+}
 
-  } while (cluster < 0x0FFFFFF8);                                             // 0x?ffffff8 - 0x?fffffff = Last cluster in file (EOC)
+/**
+ * @brief   Write Sector From Buffer Shorter Than Sector
+ * @note    rest of sector zeroed, no sector buffer needed (small headers)
+ *
+ * @param   uint32_t sector
+ * @param   uint8_t * buffer
+ * @param   uint16_t length
+ *
+ * @return  uint8_t
+ */
+uint8_t FAT32_Write_Part (uint32_t sector, uint8_t * buffer, uint16_t length)
+{
+  FAT32_Stream_Stop ();
+  if (sector == FAT32_Cache_Sector) {
+    FAT32_Cache_Sector = 0xFFFFFFFF;                                          // cached copy outdated
+  }
+  if (SD_SUCCESS != SD_Write_Part (sector, buffer, length)) {
+    return FAT32_ERROR;
+  }
 
   return FAT32_SUCCESS;
 }
 
 /**
- * --------------------------------------------------------------------------------------------+
- * PRIMITIVE / PRIVATE FUNCTIONS
- * --------------------------------------------------------------------------------------------+
+ * @brief   Put 2 Bytes Little Endian
+ *
+ * @param   uint8_t * destination
+ * @param   uint16_t number
+ *
+ * @return  void
+ */
+void FAT32_Put_2Bytes_LE (uint8_t * n, uint16_t number)
+{
+  n[0] = (uint8_t) (number >> 0);
+  n[1] = (uint8_t) (number >> 8);
+}
+
+/**
+ * @brief   Put 4 Bytes Little Endian
+ *
+ * @param   uint8_t * destination
+ * @param   uint32_t number
+ *
+ * @return  void
  */
+void FAT32_Put_4Bytes_LE (uint8_t * n, uint32_t number)
+{
+  n[0] = (uint8_t) (number >>  0);
+  n[1] = (uint8_t) (number >>  8);
+  n[2] = (uint8_t) (number >> 16);
+  n[3] = (uint8_t) (number >> 24);
+}
 
 /**
- * @brief   Get 2 Bytes Little Endian
+ * @brief   Hash Of Name
  *
- * @param   uint8_t * number
+ * @param   uint8_t * name
+ * @param   uint8_t length
  *
  * @return  uint16_t
  */
-uint16_t FAT32_Get_2Bytes_LE (uint8_t * n)
+uint16_t FAT32_Hash (uint8_t * name, uint8_t length)
 {
-  uint32_t number = (((uint16_t) n[1] << 8) & 0xFF00) | 
-                    (((uint16_t) n[0] << 0) & 0x00FF) ;
-  return number;
+  uint16_t hash = 5381;
+
+  while (length--) {
+    hash = ((hash << 5) + hash) ^ *name++;                                    // djb2 (xor), 16 bit
+  }
+
+  return hash;
 }
 
 /**
- * @brief   Get 4 Bytes Little Endian
+ * @brief   Hash Of Long Name (case insensitive, any character order)
+ * @note    character at position i adds character * K^(i + 1), so slots
+ *          of long name stored last part first can be hashed as they come
  *
- * @param   uint8_t * number
+ * @param   uint8_t * name
+ * @param   uint8_t length
  *
- * @return  uint32_t
+ * @return  uint16_t
  */
-uint32_t FAT32_Get_4Bytes_LE (uint8_t * n)
+uint16_t FAT32_Hash_Long (uint8_t * name, uint8_t length)
 {
-  uint32_t number = (((uint32_t) n[3] << 24) & 0xFF000000) |
-                    (((uint32_t) n[2] << 16) & 0x00FF0000) | 
-                    (((uint32_t) n[1] <<  8) & 0x0000FF00) | 
-                    (((uint32_t) n[0] <<  0) & 0x000000FF) ;
-  return number;
+  uint16_t hash = 0;
+  uint16_t power = FAT32_HASH_MULTIPLIER;
+
+  while (length--) {
+    hash += toupper (*name++) * power;
+    power *= FAT32_HASH_MULTIPLIER;
+  }
+
+  return hash;
 }
\ No newline at end of file
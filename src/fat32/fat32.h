@@ -22,17 +22,22 @@
 #ifndef __FAT32_H__
 #define __FAT32_H__
 
+  #include <string.h>
   #include "../sd/sd.h"
+  #include "../pool/pool.h"                             // sector buffers borrowed for rebuild and sort
 
   // RETURN
   // --------------------------------------------------------------------------------------
   #define FAT32_ERROR                   0xff
   #define FAT32_SUCCESS                 0x00
+  #define FAT32_PENDING                 0x01            // incremental job not finished yet
 
   // Master Boot Record 
   // --------------------------------------------------------------------------------------
   #define FAT32_SIGNATURE               0xAA55
   #define FAT32_NUM_OF_FATS             2
+  #define FAT32_BS_SERIAL               0x43            // offset of volume serial number in FAT32 boot sector
+  #define FAT16_BS_SERIAL               0x27            // offset of volume serial number in FAT12/16 boot sector
 
   // Partition Type used in the partition record
   //
@@ -62,14 +67,135 @@
   #define PE_TYPECODE_DBFS              0xE0
   #define PE_TYPECODE_BBT               0xFF
 
+  #define PE_EXTENDED_MAX               16              // logical partitions followed in extended partition
+
   #define BYTES_PER_SECTOR              0x0200          // 512 Bytes
+  #define BYTES_PER_SECTOR_SHIFT        9               // log2 BYTES_PER_SECTOR
   
   // DIRECTORY ENTRY
   // --------------------------------------------------------------------------------------
   #define FAT32_DE_UNUSED               0xE5            // the directory entry is free (no file or directory name in this entry)
   #define FAT32_DE_END                  0x00            // there are no allocated directory entries after this one
   #define FAT32_DE_LONG_NAME            0x0F
-  
+  #define FAT32_LFN_LAST                0x40            // order flag of last long name slot (stored first)
+  #define FAT32_LFN_CHARS               13              // UCS-2 characters per long name slot
+
+  // Directory Entry Attributes
+  // --------------------------------------------------------------------------------------
+  #define FAT32_ATTR_READ_ONLY          0x01
+  #define FAT32_ATTR_HIDDEN             0x02
+  #define FAT32_ATTR_SYSTEM             0x04
+  #define FAT32_ATTR_VOLUME_ID          0x08
+  #define FAT32_ATTR_DIRECTORY          0x10
+  #define FAT32_ATTR_ARCHIVE            0x20
+
+  // Cluster Chain
+  // --------------------------------------------------------------------------------------
+  #define FAT32_CLUSTER_MASK            0x0FFFFFFF      // upper nibble of FAT32 entry is reserved
+  #define FAT32_CLUSTER_EOC             0x0FFFFFF8      // 0x?ffffff8 - 0x?fffffff = last cluster in file (EOC)
+  #define FAT32_CLUSTER_BAD             0x0FFFFFF7      // FAT entry of bad cluster
+  #define FAT32_CLUSTER_FIRST           0x00000002      // first data cluster
+  #define FAT32_CLUSTER_FREE            0x00000000      // FAT entry of free cluster
+  #define FAT32_CLUSTER_ROOT            0x00000001      // fixed root directory region of FAT12/16
+
+  // FAT Type (determined by number of clusters only)
+  // --------------------------------------------------------------------------------------
+  #define FAT32_TYPE_12                 12              // read only
+  #define FAT32_TYPE_16                 16
+  #define FAT32_TYPE_32                 32
+  #define FAT12_CLUSTERS_MAX            4085            // FAT12 below
+  #define FAT16_CLUSTERS_MAX            65525           // FAT16 below, FAT32 from
+
+  // Free Cluster Map (bit per region of FAT sectors that are known to be full)
+  // --------------------------------------------------------------------------------------
+  #define FAT32_FREEMAP                                 // skip full FAT regions when allocating
+  #define FAT32_FREEMAP_BYTES           32              // max 32, one summary bit per byte
+
+  // FSInfo Sector
+  // --------------------------------------------------------------------------------------
+  #define FAT32_FSI_LEAD_SIGNATURE      0x41615252      // "RRaA"
+  #define FAT32_FSI_STRUC_SIGNATURE     0x61417272      // "rrAa"
+  #define FAT32_FSI_TRAIL_SIGNATURE     0xAA550000
+  #define FAT32_FSI_UNKNOWN             0xFFFFFFFF      // free count / next free not known
+
+  // Directory Index
+  // --------------------------------------------------------------------------------------
+  #define FAT32_INDEX_ENTRIES           32              // entries held in index (17 bytes each)
+//#define FAT32_INDEX_EEPROM                            // keep index in EEPROM instead of RAM
+
+  // Mount Cache (volume of last mount kept in EEPROM)
+  // --------------------------------------------------------------------------------------
+  #define FAT32_MOUNT_EEPROM                            // same card mounted without MBR and directory search
+
+  // File Handle
+  // --------------------------------------------------------------------------------------
+  #define FAT32_FILE_CHECKPOINTS        4               // clusters remembered along chain for backward seeks, even
+
+  // Path Resolution
+  // --------------------------------------------------------------------------------------
+  #define FAT32_PATH_SEPARATOR          '/'
+  #define FAT32_PATH_NAME_LENGTH        48              // longest long name matched in path component
+  #define FAT32_DIRCACHE_ENTRIES        4               // recently resolved directories
+  #define FAT32_FILTER_EXTENSIONS       "MP3"           // returned by filtered iterator, 3 characters each ("MP3WAV")
+  #define FAT32_FILTER_ATTRIBUTES       (FAT32_ATTR_DIRECTORY | FAT32_ATTR_HIDDEN | FAT32_ATTR_SYSTEM)
+
+  // Directory Index File (root directory, preallocated, rebuilt when stale)
+  // --------------------------------------------------------------------------------------
+  #define FAT32_SDINDEX_NAME            "SDINDEX    "   // 8.3 name of index file
+  #define FAT32_SDINDEX_SIGNATURE       "SDIX"
+  #define FAT32_SDINDEX_VERSION         6
+  #define FAT32_SDINDEX_HEAD_SECTORS    2               // checksummed sectors at start of root directory
+  #define FAT32_SDINDEX_RECORDS         (BYTES_PER_SECTOR / sizeof (FAT32_Record_t))
+  #define FAT32_SDINDEX_NAME_LENGTH     30              // bytes of long name kept in record
+  #define FAT32_SDINDEX_BUCKETS         (BYTES_PER_SECTOR / sizeof (FAT32_Bucket_t))
+
+  // Name Hash Table (stored in index file after records)
+  // --------------------------------------------------------------------------------------
+  #define FAT32_HASH_MULTIPLIER         0x0193          // long name hash, sum of char * K^(position + 1)
+//#define FAT32_HASH_LONG_NAMES                         // long names hashed besides short names
+
+  // Sorted Views (stored in index file after hash table)
+  // --------------------------------------------------------------------------------------
+  #define FAT32_SORT_NONE               0               // directory order
+  #define FAT32_SORT_NAME               1               // long name, case insensitive
+  #define FAT32_SORT_SIZE               2               // file size
+  #define FAT32_SORT_DATE               3               // last change date and time
+  #define FAT32_SORT_KEYS               3
+  #define FAT32_SORT_RUN                ((BYTES_PER_SECTOR >> 1) / sizeof (FAT32_Key_t))
+  #define FAT32_SORT_WAYS               8               // runs merged in one pass
+
+  // Intent Journal (root directory, preallocated contiguous file, replayed at mount)
+  // --------------------------------------------------------------------------------------
+  #define FAT32_JOURNAL                                 // journal FAT and directory entry updates
+  #define FAT32_JOURNAL_NAME            "SDJOURNL   "   // 8.3 name of journal file
+  #define FAT32_JOURNAL_SIGNATURE       "SDJL"
+  #define FAT32_JOURNAL_INTENTS         8               // intents collected in RAM per commit (16 bytes each)
+  #define FAT32_INTENT_FAT              'F'             // run of linked FAT entries
+  #define FAT32_INTENT_ENTRY            'E'             // first cluster and size of directory entry
+
+  // Journal Sector Header (sector 0 of journal file: Sequence = checkpoint)
+  // --------------------------------------------------------------------------------------
+  // 16 Bytes
+  typedef struct FAT32_Journal_t {
+    uint8_t Signature[4];                               // "SDJL"
+    uint8_t Sequence[4];                                // commit number
+    uint8_t Intents[2];                                 // intents following header
+    uint8_t Reserved[2];
+    uint8_t Checksum[4];                                // of header and intents, this field zeroed
+  } FAT32_Journal_t;
+
+  // Journal Intent
+  // --------------------------------------------------------------------------------------
+  // 16 Bytes
+  typedef struct FAT32_Intent_t {
+    uint8_t Type;                                       // FAT32_INTENT_FAT / FAT32_INTENT_ENTRY
+    uint8_t Slot;                                       // slot of directory entry
+    uint8_t Reserved[2];
+    uint8_t Target[4];                                  // first cluster of run / sector of directory entry
+    uint8_t Count[4];                                   // clusters of run, each linked to next / file size
+    uint8_t Value[4];                                   // FAT entry of last cluster of run / first cluster of file
+  } FAT32_Intent_t;
+
   // Partition Entry PE
   // --------------------------------------------------------------------------------------
   // 16 Bytes
@@ -128,6 +254,19 @@
     uint8_t Signature[2];                               // offset 0x1FE - signature => must be 0xAA55
   } __attribute__((packed)) BS_t;
 
+  // FSInfo Sector FSI
+  // --------------------------------------------------------------------------------------
+  // 512 Bytes
+  typedef struct FSI_t {
+    uint8_t LeadSignature[4];                           // 0x41615252
+    uint8_t Reserved1[480];
+    uint8_t StrucSignature[4];                          // 0x61417272
+    uint8_t FreeCount[4];                               // last known free cluster count, 0xFFFFFFFF = unknown
+    uint8_t NextFree[4];                                // hint where to look for free cluster, 0xFFFFFFFF = unknown
+    uint8_t Reserved2[12];
+    uint8_t TrailSignature[4];                          // 0xAA550000
+  } __attribute__((packed)) FSI_t;
+
   // Directory Entry DE
   // --------------------------------------------------------------------------------------
   typedef struct DE_t {
@@ -160,13 +299,176 @@
   } __attribute__((packed)) LFN_t;
   
   typedef struct FAT32_t {
+    uint8_t type;                                        // FAT32_TYPE_12 / 16 / 32
+    uint8_t fat_shift;                                   // log2 FAT entries per sector (FAT16, FAT32)
     uint8_t sectors_per_cluster;                         // sectors per cluster
-    uint32_t root_dir_clus_num;
+    uint8_t cluster_shift;                               // log2 sectors per cluster
+    uint32_t root_dir_clus_num;                          // FAT32_CLUSTER_ROOT for FAT12/16
+    uint32_t root_dir_sector;                            // first sector of root directory
+    uint16_t root_dir_sectors;                           // sectors of fixed root directory (FAT12/16)
     uint32_t lba_begin;
     uint32_t fat_area_begin;                             //
     uint32_t data_area_begin;                            //
+    uint32_t cluster_base;                               // data_area_begin - 2 clusters, sector = base + (cluster << shift)
+    uint32_t sectors_per_fat;                            // sectors of one FAT copy
+    uint32_t clusters;                                   // number of data clusters
+    uint32_t fsinfo_sector;                              // FSInfo sector, 0 = none
+    uint32_t next_free;                                  // cluster where free cluster search starts
+    uint32_t free_count;                                 // free clusters, 0xFFFFFFFF = unknown (recount)
+    uint32_t recount;                                    // next cluster examined by recount, 0 = idle
+    uint32_t recount_free;                               // free clusters found by recount so far
+    uint16_t files;                                      // number of entries in root directory
   } FAT32_t;
 
+  // Mount Cache Record (EEPROM)
+  // --------------------------------------------------------------------------------------
+  typedef struct FAT32_Mount_t {
+    uint32_t serial;                                     // volume serial number of boot sector
+    uint32_t checksum;                                   // checksum of boot sector
+    FAT32_t Volume;                                      // geometry, free cluster fields reloaded
+    uint32_t index_cluster;                              // first cluster of index file, 0 = not known
+    uint32_t index_size;                                 // size of index file
+    uint32_t index_first;                                // 1st sector of contiguous index file, 0 = fragmented
+    uint32_t check;                                      // checksum of record, this field excluded
+  } FAT32_Mount_t;
+
+  // Directory Index Entry
+  // --------------------------------------------------------------------------------------
+  // 17 Bytes
+  typedef struct FAT32_Index_t {
+    uint32_t sector;                                     // directory sector holding entry
+    uint32_t cluster;                                    // first cluster of file
+    uint32_t size;                                       // file size
+    uint16_t hash;                                       // short name hash
+    uint8_t slot;                                        // entry slot in sector (0 - 15)
+    uint8_t attribute;                                   // entry attribute
+    uint8_t lfn;                                         // long name slots preceding entry
+  } FAT32_Index_t;
+
+  // Decoded Directory Entry (copy in caller storage, stays valid)
+  // --------------------------------------------------------------------------------------
+  // 24 Bytes
+  typedef struct FAT32_Info_t {
+    uint8_t name[11];                                    // 8.3 name as stored, space padded
+    uint8_t attribute;                                   // entry attribute
+    uint32_t cluster;                                    // first cluster of file
+    uint32_t size;                                       // file size
+    uint16_t date;                                       // change date: 0-4 day, 5-8 month, 9-15 year from 1980
+    uint16_t time;                                       // change time: 0-4 seconds/2, 5-10 minutes, 11-15 hours
+  } FAT32_Info_t;
+
+  // Directory Index File Header (sector 0 of index file)
+  // --------------------------------------------------------------------------------------
+  typedef struct FAT32_SDIndex_t {
+    uint8_t Signature[4];                                // "SDIX"
+    uint8_t Version;                                     // format version
+    uint8_t RecordSize;                                  // bytes per record
+    uint8_t Reserved[2];
+    uint8_t Entries[4];                                  // number of records
+    // -------- fingerprint of root directory
+    uint8_t RootCluster[4];                              // first cluster of root directory
+    uint8_t ChainLength[4];                              // clusters in root directory chain
+    uint8_t HeadChecksum[4];                             // checksum of first directory sectors
+    uint8_t TailSector[4];                               // sector holding end of directory
+    uint8_t TailChecksum[4];                             // checksum of tail sector
+    // -------- name hash table
+    uint8_t HashSlots[4];                                // buckets in hash table, 0 = no table
+    uint8_t Capacity[4];                                 // records room in front of hash table
+    // -------- sorted views
+    uint8_t Sorted;                                      // bit (1 << FAT32_SORT_*) set = view built
+  } __attribute__((packed)) FAT32_SDIndex_t;
+
+  // Directory Index File Record (sectors 1.. of index file)
+  // --------------------------------------------------------------------------------------
+  // 64 Bytes
+  typedef struct FAT32_Record_t {
+    uint8_t Cluster[4];                                  // first cluster of file
+    uint8_t Size[4];                                     // file size
+    uint8_t Sector[4];                                   // directory sector holding entry
+    uint8_t Slot;                                        // entry slot in sector
+    uint8_t Attribute;                                   // entry attribute
+    uint8_t Hash[2];                                     // short name hash
+    uint8_t Name[11];                                    // short name 8.3
+    uint8_t Lfn;                                         // long name slots preceding entry
+    uint8_t Changed[4];                                  // change date << 16 | change time
+    uint8_t LongHash[2];                                 // long name hash, 0 = no long name
+    uint8_t LongName[FAT32_SDINDEX_NAME_LENGTH];         // long name prefix, zero terminated
+  } __attribute__((packed)) FAT32_Record_t;
+
+  // Name Hash Table Bucket (open addressing, linear probing inside sector)
+  // --------------------------------------------------------------------------------------
+  // 4 Bytes
+  typedef struct FAT32_Bucket_t {
+    uint8_t Hash[2];                                     // short or long name hash
+    uint8_t File[2];                                     // file number, 0 = empty bucket
+  } __attribute__((packed)) FAT32_Bucket_t;
+
+  // Sort Key Of Record (runs of sorted view being built)
+  // --------------------------------------------------------------------------------------
+  // 16 Bytes
+  typedef struct FAT32_Key_t {
+    uint8_t Key[14];                                     // upper case name prefix, or big endian size / date
+    uint8_t File[2];                                     // file number
+  } __attribute__((packed)) FAT32_Key_t;
+
+  // Resolved Directory Cache Entry
+  // --------------------------------------------------------------------------------------
+  typedef struct FAT32_Dircache_t {
+    uint16_t hash;                                       // hash of path up to directory
+    uint8_t length;                                      // length of that path
+    uint32_t cluster;                                    // first cluster of directory
+  } FAT32_Dircache_t;
+
+  // Directory Iterator (plain data, copy to save / resume position)
+  // --------------------------------------------------------------------------------------
+  typedef struct FAT32_Dir_t {
+    uint32_t first_cluster;                              // first cluster of directory, 0 = not open
+    uint32_t cluster;                                    // cluster of next slot, 0 = end reached
+    uint8_t sector;                                      // sector of next slot in cluster
+    uint8_t slot;                                        // next slot in sector
+    uint16_t index;                                      // entries returned so far
+    uint8_t hidden;                                      // 1 - index file returned too (consistency check)
+    uint8_t filter;                                      // 1 - only files of FAT32_FILTER_EXTENSIONS counted
+  } FAT32_Dir_t;
+
+  // Fragmentation Of File
+  // --------------------------------------------------------------------------------------
+  typedef struct FAT32_Fragments_t {
+    uint32_t clusters;                                   // clusters in chain
+    uint32_t extents;                                    // runs of consecutive clusters
+    uint32_t average;                                    // clusters per run
+    uint32_t worst_seek;                                 // longest jump between runs (clusters)
+  } FAT32_Fragments_t;
+
+  // Long File Name Assembly
+  // --------------------------------------------------------------------------------------
+  typedef struct FAT32_Name_t {
+    uint8_t * buffer;                                    // caller buffer, receives name prefix
+    uint8_t size;                                        // size of buffer including terminator
+    uint8_t order;                                       // order of last accepted slot, 0 = none
+    uint8_t checksum;                                    // checksum of short name from slots
+    uint16_t hash;                                       // hash of whole long name, 0 = short name
+  } FAT32_Name_t;
+
+  // File Handle
+  // --------------------------------------------------------------------------------------
+  typedef struct FAT32_File_t {
+    uint32_t first_cluster;                              // first cluster of file
+    uint32_t size;                                       // file size in bytes
+    uint32_t position;                                   // current byte offset in file
+    uint32_t cluster;                                    // cluster holding current byte offset
+    uint32_t cluster_index;                              // order of current cluster in chain (0 = first)
+    uint8_t open;                                        // 1 - handle in use, 0 - closed
+    uint8_t dirty;                                       // 1 - size or first cluster changed
+    uint8_t entry_slot;                                  // slot of directory entry in sector
+    uint32_t entry_sector;                               // sector of directory entry, 0 = none (read only)
+    uint32_t reserved_first;                             // first cluster of contiguous preallocated run
+    uint32_t reserved_last;                              // last cluster of run, 0 = none
+    uint32_t checkpoint[FAT32_FILE_CHECKPOINTS];         // cluster of chain order (k + 1) << checkpoint_shift
+    uint8_t checkpoints;                                 // checkpoints known, walked prefix of chain
+    uint8_t checkpoint_shift;                            // log2 clusters between checkpoints
+  } FAT32_File_t;
+
   /**
    * @brief   FAT32 Init
    *
@@ -177,7 +479,9 @@
   uint8_t FAT32_Init (FAT32_t *);
 
   /**
-   * @brief   Read Master Boot Record
+   * @brief   Find Volume - Boot Sector At LBA 0 Or Partition Of MBR
+   * @note    all four primary entries and logical partitions of extended
+   *          partition are searched, result is cached for next mount
    *
    * @param   FAT32_t * 
    *
@@ -195,26 +499,140 @@
   uint8_t FAT32_Read_Boot_Sector (FAT32_t *);
 
   /**
-   * @brief   Read Root Directory
+   * @brief   Read Root Directory & Build Directory Index
    *
    * @param   FAT32_t *
    *
-   * @return  DE_t *
+   * @return  uint32_t number of entries
    */
   uint32_t FAT32_Root_Dir_Files (FAT32_t *);
 
+  /**
+   * @brief   Get Directory Index Entry
+   *
+   * @param   FAT32_t * FAT32
+   * @param   uint16_t file number (1 - files)
+   * @param   FAT32_Index_t * entry
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Get_Index (FAT32_t *, uint16_t, FAT32_Index_t *);
+
+  /**
+   * @brief   Load Directory Index File Or Rebuild It When Stale
+   *
+   * @param   FAT32_t * FAT32
+   *
+   * @return  uint8_t FAT32_SUCCESS if index file is valid
+   */
+  uint8_t FAT32_Index_File (FAT32_t *);
+
+  /**
+   * @brief   Get Directory Index File Record
+   *
+   * @param   FAT32_t * FAT32
+   * @param   uint16_t file number (1 - files)
+   * @param   FAT32_Record_t * record
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Get_Record (FAT32_t *, uint16_t, FAT32_Record_t *);
+
+  /**
+   * @brief   Build Sorted View Of Root Directory In Index File
+   * @note    external merge sort, runs of FAT32_SORT_RUN keys merged FAT32_SORT_WAYS
+   *          at a time in sequential passes; view is kept until index is rebuilt
+   *
+   * @param   FAT32_t * FAT32
+   * @param   uint8_t FAT32_SORT_NAME / FAT32_SORT_SIZE / FAT32_SORT_DATE
+   *
+   * @return  uint8_t FAT32_ERROR if index file is missing or too small
+   */
+  uint8_t FAT32_Sort (FAT32_t *, uint8_t);
+
+  /**
+   * @brief   File Number At Position Of Sorted View
+   * @note    one read of the view, view must be built by FAT32_Sort
+   *
+   * @param   FAT32_t * FAT32
+   * @param   uint8_t FAT32_SORT_NAME / FAT32_SORT_SIZE / FAT32_SORT_DATE
+   * @param   uint16_t position (1 - files)
+   *
+   * @return  uint16_t file number, 0 = no view
+   */
+  uint16_t FAT32_Sorted_File (FAT32_t *, uint8_t, uint16_t);
+
+  /**
+   * @brief   Next File Of Sorted View Passing Filter
+   * @note    entries not passing filter of directory iterator (FAT32_FILTER_*)
+   *          skipped, so positions match filtered directory order count
+   *
+   * @param   FAT32_t * FAT32
+   * @param   uint8_t FAT32_SORT_NAME / FAT32_SORT_SIZE / FAT32_SORT_DATE
+   * @param   uint16_t * positions of view passed, moved behind returned file
+   *
+   * @return  uint16_t file number, 0 = end of view or no view
+   */
+  uint16_t FAT32_Sorted_Next (FAT32_t *, uint8_t, uint16_t *);
+
   /**
    * @brief   Get File Info from Root Directory
+   * @note    entry decoded into caller storage, sector cache free for reuse
    *
    * @param   FAT32_t * FAT32
-   * @param   uint8_t file number
+   * @param   uint16_t file number
+   * @param   FAT32_Info_t * info
    *
-   * @return  DE_t *
-   *  */
-  DE_t * FAT32_Get_File_Info (FAT32_t *, uint8_t);
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Get_File_Info (FAT32_t *, uint16_t, FAT32_Info_t *);
+
+  /**
+   * @brief   Get Name (Long Name Prefix or Short Name "NAME.EXT")
+   *
+   * @param   FAT32_t * FAT32
+   * @param   uint16_t file number (1 - files)
+   * @param   uint8_t * buffer
+   * @param   uint8_t size of buffer
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Get_Name (FAT32_t *, uint16_t, uint8_t *, uint8_t);
+
+  /**
+   * @brief   Start Long File Name Assembly
+   *
+   * @param   FAT32_Name_t * name
+   * @param   uint8_t * buffer
+   * @param   uint8_t size of buffer
+   *
+   * @return  void
+   */
+  void FAT32_Name_Init (FAT32_Name_t *, uint8_t *, uint8_t);
+
+  /**
+   * @brief   Feed Long File Name Slot
+   *
+   * @param   FAT32_Name_t * name
+   * @param   LFN_t * long name slot
+   *
+   * @return  void
+   */
+  void FAT32_Name_Slot (FAT32_Name_t *, LFN_t *);
+
+  /**
+   * @brief   Finish Name At Short Entry
+   *
+   * @param   FAT32_Name_t * name
+   * @param   DE_t * short entry
+   *
+   * @return  uint8_t 1 - long name, 0 - short name
+   */
+  uint8_t FAT32_Name_Entry (FAT32_Name_t *, DE_t *);
 
   /**
    * @brief   Read Next Cluster From FAT
+   * @note    FAT12/16 entries are widened, end of chain reads as FAT32 EOC
    *
    * @param   FAT32_t * FAT32
    * @param   uint32_t cluster number
@@ -225,13 +643,219 @@
 
   /**
    * @brief   Get Address (Offset) Of 1st Sector Of Cluster Number
+   * @note    shift and add only, geometry precomputed at mount
    *
    * @param   FAT32_t * FAT32
    * @param   uint32_t cluster number
    *
    * @return  uint32_t
    *  */
-  uint32_t FAT32_Get_1st_Sector_Of_Clus (FAT32_t *, uint32_t);
+  static inline uint32_t FAT32_Get_1st_Sector_Of_Clus (FAT32_t * FAT32, uint32_t cluster)
+  {
+    if (cluster < FAT32_CLUSTER_FIRST) {
+      return FAT32->root_dir_sector;                    // fixed root of FAT12/16
+    }
+    return FAT32->cluster_base + (cluster << FAT32->cluster_shift);
+  }
+
+  /**
+   * @brief   Open File from Root Directory
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_File_t * file handle
+   * @param   uint16_t file number
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Open (FAT32_t *, FAT32_File_t *, uint16_t);
+
+  /**
+   * @brief   Open Directory Iterator
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_Dir_t * iterator
+   * @param   uint32_t first cluster of directory, 0 = root directory
+   *
+   * @return  void
+   */
+  void FAT32_Dir_Open (FAT32_t *, FAT32_Dir_t *, uint32_t);
+
+  /**
+   * @brief   Next Entry Of Directory
+   * @note    skips deleted entries, volume label and index file (unless hidden set)
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_Dir_t * iterator
+   * @param   FAT32_Index_t * entry
+   * @param   FAT32_Name_t * long name assembly, NULL = not needed
+   *
+   * @return  uint8_t FAT32_ERROR at end of directory
+   */
+  uint8_t FAT32_Dir_Next (FAT32_t *, FAT32_Dir_t *, FAT32_Index_t *, FAT32_Name_t *);
+
+  /**
+   * @brief   Find File In Root Directory By Name
+   * @note    short name "NAME.EXT" or long name, case insensitive
+   *
+   * @param   FAT32_t * FAT32
+   * @param   char * name
+   *
+   * @return  uint16_t file number (1 - files), 0 = not found
+   */
+  uint16_t FAT32_Find (FAT32_t *, char *);
+
+  /**
+   * @brief   Resolve Path To Directory Entry
+   *
+   * @param   FAT32_t * FAT32
+   * @param   char * path, e.g. "/ALBUM/01.MP3" or "/Album/Long Name.mp3"
+   * @param   FAT32_Index_t * entry
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Get_Path (FAT32_t *, char *, FAT32_Index_t *);
+
+  /**
+   * @brief   Open File By Path
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_File_t * file handle
+   * @param   char * path
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Open_Path (FAT32_t *, FAT32_File_t *, char *);
+
+  /**
+   * @brief   Read Data From File
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_File_t * file handle
+   * @param   uint8_t * buffer
+   * @param   uint16_t number of bytes
+   *
+   * @return  uint16_t number of bytes read
+   */
+  uint16_t FAT32_Read (FAT32_t *, FAT32_File_t *, uint8_t *, uint16_t);
+
+  /**
+   * @brief   Set File Position
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_File_t * file handle
+   * @param   uint32_t byte offset from beginning of file
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Seek (FAT32_t *, FAT32_File_t *, uint32_t);
+
+  /**
+   * @brief   Free Clusters
+   *
+   * @param   FAT32_t * FAT32
+   *
+   * @return  uint32_t free clusters, 0xFFFFFFFF = unknown until recount finishes
+   */
+  uint32_t FAT32_Free_Clusters (FAT32_t *);
+
+  /**
+   * @brief   Recount Free Clusters In Steps
+   * @note    call repeatedly (e.g. from idle loop) while FSInfo free count is unknown
+   *
+   * @param   FAT32_t * FAT32
+   * @param   uint16_t FAT sectors examined in this step
+   *
+   * @return  uint8_t FAT32_PENDING / FAT32_SUCCESS when count is known / FAT32_ERROR
+   */
+  uint8_t FAT32_Recount (FAT32_t *, uint16_t);
+
+  /**
+   * @brief   Create Empty File In Root Directory
+   * @note    short name 8.3 only, fails if file exists
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_File_t * file handle
+   * @param   char * name "NAME.EXT"
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Create (FAT32_t *, FAT32_File_t *, char *);
+
+  /**
+   * @brief   Append Data To File
+   * @note    data always go to end of file
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_File_t * file handle
+   * @param   uint8_t * buffer
+   * @param   uint16_t number of bytes
+   *
+   * @return  uint16_t number of bytes written
+   */
+  uint16_t FAT32_Write (FAT32_t *, FAT32_File_t *, uint8_t *, uint16_t);
+
+  /**
+   * @brief   Write Size And First Cluster Into Directory Entry
+   * @note    with journal FAT and entry intents committed by one sector write first
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_File_t * file handle
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Flush (FAT32_t *, FAT32_File_t *);
+
+  /**
+   * @brief   Preallocate Contiguous Clusters Behind End Of File
+   * @note    writes into run need no FAT access, whole sectors go out as one
+   *          multiple block write until next other card access or close
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_File_t * file handle opened for writing
+   * @param   uint32_t number of clusters
+   * @param   uint8_t 1 - erase run on card, 0 - keep content
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Allocate (FAT32_t *, FAT32_File_t *, uint32_t, uint8_t);
+
+  /**
+   * @brief   Close File
+   * @note    flushes directory entry of written file, checkpoints journal
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_File_t * file handle
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Close (FAT32_t *, FAT32_File_t *);
+
+  /**
+   * @brief   Fragmentation Of File
+   * @note    cluster chain walked, no data read
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_Index_t * directory entry
+   * @param   FAT32_Fragments_t * report
+   *
+   * @return  uint8_t FAT32_ERROR if chain is broken
+   */
+  uint8_t FAT32_Fragments (FAT32_t *, FAT32_Index_t *, FAT32_Fragments_t *);
+
+  /**
+   * @brief   Move File Into Contiguous Run
+   * @note    data copied by multiple block reads and writes, then run chained,
+   *          directory entry pointed to run, old chain freed; interruption leaves
+   *          complete file and lost clusters only; offline, no file may be open
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FAT32_Index_t * directory entry, first cluster updated
+   * @param   uint8_t * buffer for copy
+   * @param   uint16_t sectors of buffer
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Defragment (FAT32_t *, FAT32_Index_t *, uint8_t *, uint16_t);
 
   /**
    * --------------------------------------------------------------------------------------------+
@@ -239,22 +863,156 @@
    * --------------------------------------------------------------------------------------------+
    */
 
+  /**
+   * @brief   Read Sector Through Sector Cache
+   *
+   * @param   uint32_t sector
+   *
+   * @return  uint8_t * => cached sector, NULL if read failed
+   */
+  uint8_t * FAT32_Read_Sector (uint32_t);
+
+  /**
+   * @brief   Read Sector Through Sector Cache As Part Of Multiple Block Read
+   * @note    consecutive sectors continue one transfer, for sequential scans (FAT)
+   *
+   * @param   uint32_t sector
+   *
+   * @return  uint8_t * => cached sector, NULL if read failed
+   */
+  uint8_t * FAT32_Read_Stream (uint32_t);
+
+  /**
+   * @brief   Zero Run Of Sectors
+   * @note    one multiple block write, cache dropped
+   *
+   * @param   uint32_t first sector
+   * @param   uint32_t number of sectors
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Zero_Sectors (uint32_t, uint32_t);
+
+  /**
+   * @brief   Drop Content Of Sector Cache
+   * @note    after card change, or when other driver shares the cache
+   *
+   * @param   void
+   *
+   * @return  void
+   */
+  void FAT32_Cache_Invalidate (void);
+
+  /**
+   * @brief   Write Sector, Keep Sector Cache Coherent
+   *
+   * @param   uint32_t sector
+   * @param   uint8_t * buffer
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Write_Sector (uint32_t, uint8_t *);
+
+  /**
+   * @brief   Write Sector As Part Of Multiple Block Write
+   * @note    consecutive sectors continue one transfer (logs, copies),
+   *          transfer ends with next other card access
+   *
+   * @param   uint32_t sector
+   * @param   uint8_t * buffer
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Write_Stream (uint32_t, uint8_t *);
+
+  /**
+   * @brief   Write Sector From Buffer Shorter Than Sector
+   * @note    rest of sector zeroed, no sector buffer needed (small headers)
+   *
+   * @param   uint32_t sector
+   * @param   uint8_t * buffer
+   * @param   uint16_t length
+   *
+   * @return  uint8_t
+   */
+  uint8_t FAT32_Write_Part (uint32_t, uint8_t *, uint16_t);
+
+  /**
+   * @brief   Hash Of Name
+   *
+   * @param   uint8_t * name
+   * @param   uint8_t length
+   *
+   * @return  uint16_t
+   */
+  uint16_t FAT32_Hash (uint8_t *, uint8_t);
+
+  /**
+   * @brief   Hash Of Long Name (case insensitive, any character order)
+   *
+   * @param   uint8_t * name
+   * @param   uint8_t length
+   *
+   * @return  uint16_t
+   */
+  uint16_t FAT32_Hash_Long (uint8_t *, uint8_t);
+
   /**
    * @brief   Get 2 Bytes Little Endian
+   * @note    unaligned load, AVR is little endian so no byte swapping
    *
    * @param   uint8_t * number
    *
    * @return  uint16_t
    */
-  uint16_t FAT32_Get_2Bytes_LE (uint8_t *);
+  static inline uint16_t FAT32_Get_2Bytes_LE (uint8_t * n)
+  {
+  #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint16_t number;
+    memcpy (&number, n, sizeof (number));
+    return number;
+  #else
+    return ((uint16_t) n[1] << 8) | n[0];
+  #endif
+  }
   
   /**
    * @brief   Get 4 Bytes Little Endian
+   * @note    unaligned load, AVR is little endian so no byte swapping
    *
    * @param   uint8_t * number
    *
    * @return  uint32_t
    */
-  uint32_t FAT32_Get_4Bytes_LE (uint8_t *);
+  static inline uint32_t FAT32_Get_4Bytes_LE (uint8_t * n)
+  {
+  #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t number;
+    memcpy (&number, n, sizeof (number));
+    return number;
+  #else
+    return ((uint32_t) n[3] << 24) | ((uint32_t) n[2] << 16) | ((uint16_t) n[1] << 8) | n[0];
+  #endif
+  }
+
+  /**
+   * @brief   Put 2 Bytes Little Endian
+   *
+   * @param   uint8_t * destination
+   * @param   uint16_t number
+   *
+   * @return  void
+   */
+  void FAT32_Put_2Bytes_LE (uint8_t *, uint16_t);
+
+  /**
+   * @brief   Put 4 Bytes Little Endian
+   *
+   * @param   uint8_t * destination
+   * @param   uint32_t number
+   *
+   * @return  void
+   */
+  void FAT32_Put_4Bytes_LE (uint8_t *, uint32_t);
 
 #endif
\ No newline at end of file
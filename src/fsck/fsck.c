@@ -0,0 +1,476 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       FSCK - FAT consistency check
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        fsck.c
+ * @version     1.0
+ * @test        AVR Atmega328p
+ *
+ * @depend      fat32.h, fsck.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   SPI 4-wire
+ * @pins        MOSI, MISO, CLK, SS, UCC, USS
+ *
+ * @sources
+ */
+
+// INCLUDE libraries
+// ------------------------------------------------------------------
+#include <string.h>
+#include "fsck.h"
+
+#define FSCK_UNREADABLE   0xFFFFFFFF                                          // FAT sector not read
+
+// Cluster Bitmap - bit set = cluster referenced (by FAT entry or directory entry)
+// ------------------------------------------------------------------
+static uint8_t FSCK_Window[FSCK_WINDOW_BYTES];                                // part of bitmap held in RAM
+static uint32_t FSCK_Window_Index;                                            // window number of bitmap part
+static uint8_t FSCK_Window_Dirty;                                             // window differs from spill file
+static uint32_t FSCK_Spill;                                                   // 1st sector of spill file, 0 = whole bitmap in RAM
+
+/**
+ * @brief   Swap Bitmap Window With Spill File
+ * @note    read / write through sector cache
+ *
+ * @param   uint32_t window number
+ *
+ * @return  uint8_t
+ */
+static uint8_t FSCK_Swap (uint32_t window)
+{
+  uint8_t * buffer;
+  uint32_t offset = FSCK_Window_Index * FSCK_WINDOW_BYTES;
+  uint32_t sector = FSCK_Spill + (offset >> BYTES_PER_SECTOR_SHIFT);
+
+  if (FSCK_Window_Dirty) {
+    if (NULL == (buffer = FAT32_Read_Sector (sector))) {
+      return FSCK_ERROR;
+    }
+    memcpy (&buffer[offset & (BYTES_PER_SECTOR - 1)], FSCK_Window, FSCK_WINDOW_BYTES);
+    if (FAT32_ERROR == FAT32_Write_Sector (sector, buffer)) {
+      return FSCK_ERROR;
+    }
+    FSCK_Window_Dirty = 0;
+  }
+  offset = window * FSCK_WINDOW_BYTES;
+  if (NULL == (buffer = FAT32_Read_Sector (FSCK_Spill + (offset >> BYTES_PER_SECTOR_SHIFT)))) {
+    return FSCK_ERROR;
+  }
+  memcpy (FSCK_Window, &buffer[offset & (BYTES_PER_SECTOR - 1)], FSCK_WINDOW_BYTES);
+  FSCK_Window_Index = window;
+
+  return FSCK_SUCCESS;
+}
+
+/**
+ * @brief   Test (And Set) Bit Of Cluster
+ *
+ * @param   uint32_t cluster
+ * @param   uint8_t 1 - set bit
+ *
+ * @return  uint8_t previous bit, FSCK_ERROR if spill file failed
+ */
+static uint8_t FSCK_Bit (uint32_t cluster, uint8_t set)
+{
+  uint32_t bit = cluster - FAT32_CLUSTER_FIRST;
+  uint16_t byte = (bit >> 3) % FSCK_WINDOW_BYTES;
+  uint8_t mask = 1 << (bit & 7);
+
+  if ((bit / (FSCK_WINDOW_BYTES << 3)) != FSCK_Window_Index) {
+    if (FSCK_ERROR == FSCK_Swap (bit / (FSCK_WINDOW_BYTES << 3))) {
+      return FSCK_ERROR;
+    }
+  }
+  if (FSCK_Window[byte] & mask) {
+    return 1;
+  }
+  if (set) {
+    FSCK_Window[byte] |= mask;
+    FSCK_Window_Dirty = 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief   Prepare Cluster Bitmap
+ * @note    spill file must be contiguous, it is zeroed in one multiple block write
+ *
+ * @param   FAT32_t * FAT32
+ *
+ * @return  uint8_t
+ */
+static uint8_t FSCK_Bitmap (FAT32_t * FAT32)
+{
+  uint32_t bytes = (FAT32->clusters + 7) >> 3;
+  uint32_t cluster;
+  uint32_t last;
+  FAT32_Index_t Entry;
+
+  memset (FSCK_Window, 0, FSCK_WINDOW_BYTES);
+  FSCK_Window_Index = 0;
+  FSCK_Window_Dirty = 0;
+  FSCK_Spill = 0;
+  if (bytes <= FSCK_WINDOW_BYTES) {
+    return FSCK_SUCCESS;                                                      // whole bitmap in RAM
+  }
+
+  if ((FAT32_ERROR == FAT32_Get_Path (FAT32, FSCK_SPILL_PATH, &Entry)) ||
+      (Entry.attribute & FAT32_ATTR_DIRECTORY) || (Entry.size < bytes) || (Entry.cluster < FAT32_CLUSTER_FIRST)) {
+    return FSCK_ERROR;
+  }
+  last = Entry.cluster + ((bytes - 1) >> (BYTES_PER_SECTOR_SHIFT + FAT32->cluster_shift));
+  for (cluster = Entry.cluster; cluster < last; cluster++) {
+    if ((FAT32_FAT_Next_Cluster (FAT32, cluster) & FAT32_CLUSTER_MASK) != (cluster + 1)) {
+      return FSCK_ERROR;                                                      // fragmented
+    }
+  }
+  FSCK_Spill = FAT32_Get_1st_Sector_Of_Clus (FAT32, Entry.cluster);
+
+  return (FAT32_SUCCESS == FAT32_Zero_Sectors (FSCK_Spill, (bytes + BYTES_PER_SECTOR - 1) >> BYTES_PER_SECTOR_SHIFT)) ?
+         FSCK_SUCCESS : FSCK_ERROR;
+}
+
+/**
+ * @brief   Next Cluster From Sequentially Streamed FAT
+ * @note    FAT12 entries straddle sectors, its few sectors are read through cache
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t cluster
+ *
+ * @return  uint32_t widened to FAT32 values, FSCK_UNREADABLE if read failed
+ */
+static uint32_t FSCK_Next (FAT32_t * FAT32, uint32_t cluster)
+{
+  uint8_t * buffer;
+  uint16_t offset = cluster & ((1U << FAT32->fat_shift) - 1);
+  uint32_t next;
+
+  if (FAT32->type == FAT32_TYPE_12) {
+    return FAT32_FAT_Next_Cluster (FAT32, cluster) & FAT32_CLUSTER_MASK;
+  }
+  if (NULL == (buffer = FAT32_Read_Stream (FAT32->fat_area_begin + (cluster >> FAT32->fat_shift)))) {
+    return FSCK_UNREADABLE;
+  }
+  if (FAT32->type == FAT32_TYPE_16) {
+    next = FAT32_Get_2Bytes_LE (&buffer[offset << 1]);
+    return (next >= 0xFFF7) ? (0x0FFF0000 | next) : next;
+  }
+
+  return FAT32_Get_4Bytes_LE (&buffer[offset << 2]) & FAT32_CLUSTER_MASK;
+}
+
+/**
+ * @brief   Cluster Number Within Volume
+ *
+ * @param   FAT32_t * FAT32
+ * @param   uint32_t cluster
+ *
+ * @return  uint8_t 1 - data cluster, 0 - free, end of chain, bad or invalid
+ */
+static inline uint8_t FSCK_Valid (FAT32_t * FAT32, uint32_t cluster)
+{
+  return (cluster >= FAT32_CLUSTER_FIRST) && (cluster < (FAT32->clusters + FAT32_CLUSTER_FIRST));
+}
+
+/**
+ * @brief   Checksum Of Sector
+ *
+ * @param   uint8_t * buffer
+ *
+ * @return  uint32_t
+ */
+static uint32_t FSCK_Checksum (uint8_t * buffer)
+{
+  uint32_t sum = 0;
+
+  for (uint16_t i = 0; i < BYTES_PER_SECTOR; i++) {
+    sum = ((sum << 1) | (sum >> 31)) + buffer[i];                             // rotate & add
+  }
+
+  return sum;
+}
+
+/**
+ * @brief   Compare FAT Copies
+ * @note    group of sectors streamed from each copy, compared by checksums
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FSCK_t * result
+ *
+ * @return  uint8_t
+ */
+static uint8_t FSCK_Compare (FAT32_t * FAT32, FSCK_t * Result)
+{
+  uint8_t i;
+  uint8_t copy;
+  uint8_t count;
+  uint8_t * buffer;
+  uint32_t sector;
+  uint32_t sum[FSCK_COMPARE_SECTORS];
+
+  for (sector = 0; sector < FAT32->sectors_per_fat; sector += count) {
+    count = FSCK_COMPARE_SECTORS;
+    if (count > (FAT32->sectors_per_fat - sector)) {
+      count = FAT32->sectors_per_fat - sector;
+    }
+    for (copy = 0; copy < FAT32_NUM_OF_FATS; copy++) {
+      for (i = 0; i < count; i++) {
+        if (NULL == (buffer = FAT32_Read_Stream (FAT32->fat_area_begin + copy * FAT32->sectors_per_fat + sector + i))) {
+          return FSCK_ERROR;
+        }
+        if (copy == 0) {
+          sum[i] = FSCK_Checksum (buffer);
+        } else if (sum[i] != FSCK_Checksum (buffer)) {
+          Result->fat_mismatch++;
+        }
+      }
+    }
+  }
+
+  return FSCK_SUCCESS;
+}
+
+/**
+ * @brief   Mark Links Of FAT
+ * @note    cluster linked from two entries is cross-linked
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FSCK_t * result
+ *
+ * @return  uint8_t
+ */
+static uint8_t FSCK_Links (FAT32_t * FAT32, FSCK_t * Result)
+{
+  uint8_t bit;
+  uint32_t next;
+  uint32_t cluster;
+
+  for (cluster = FAT32_CLUSTER_FIRST; cluster < (FAT32->clusters + FAT32_CLUSTER_FIRST); cluster++) {
+    if (FSCK_UNREADABLE == (next = FSCK_Next (FAT32, cluster))) {
+      return FSCK_ERROR;
+    }
+    if (next == FAT32_CLUSTER_FREE) {
+      Result->free++;
+    } else if (next == FAT32_CLUSTER_BAD) {
+      Result->bad++;
+    } else {
+      Result->used++;
+      if (next >= FAT32_CLUSTER_EOC) {
+        continue;                                                             // last cluster of chain
+      }
+      if (!FSCK_Valid (FAT32, next)) {
+        Result->invalid++;
+      } else if (FSCK_ERROR == (bit = FSCK_Bit (next, 1))) {
+        return FSCK_ERROR;
+      } else if (bit) {
+        Result->cross_linked++;
+      }
+    }
+  }
+
+  return FSCK_SUCCESS;
+}
+
+/**
+ * @brief   Follow Chain Of Directory Entry
+ * @note    file needs exactly clusters of its size, directory at most 2 MB (65536 entries)
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FAT32_Index_t * entry
+ *
+ * @return  uint8_t FSCK_DAMAGED if chain does not match
+ */
+static uint8_t FSCK_Chain (FAT32_t * FAT32, FAT32_Index_t * Entry)
+{
+  uint8_t shift = BYTES_PER_SECTOR_SHIFT + FAT32->cluster_shift;
+  uint32_t cluster = Entry->cluster;
+  uint32_t length = 0;
+  uint32_t limit;
+
+  if (Entry->attribute & FAT32_ATTR_DIRECTORY) {
+    limit = (0x200000UL >> shift) ? (0x200000UL >> shift) : 1;
+  } else {
+    limit = (Entry->size >> shift) + ((Entry->size & ((1UL << shift) - 1)) ? 1 : 0);
+  }
+  while (FSCK_Valid (FAT32, cluster)) {
+    if (++length > limit) {
+      return FSCK_DAMAGED;                                                    // too long or loop
+    }
+    cluster = FAT32_FAT_Next_Cluster (FAT32, cluster) & FAT32_CLUSTER_MASK;
+  }
+  if (Entry->attribute & FAT32_ATTR_DIRECTORY) {
+    return FSCK_SUCCESS;                                                      // broken end counted by links
+  }
+  if ((length != limit) || ((length == 0) ? (Entry->cluster != 0) : (cluster < FAT32_CLUSTER_EOC))) {
+    return FSCK_DAMAGED;
+  }
+
+  return FSCK_SUCCESS;
+}
+
+/**
+ * @brief   Walk Directory Tree
+ * @note    first clusters marked in bitmap, already marked first cluster is cross-linked
+ *          and such directory is not followed (no loops)
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FSCK_t * result
+ *
+ * @return  uint8_t
+ */
+static uint8_t FSCK_Tree (FAT32_t * FAT32, FSCK_t * Result)
+{
+  uint8_t bit;
+  uint8_t depth = 0;
+  uint8_t * buffer;
+  FAT32_Index_t Entry;
+  FAT32_Dir_t Stack[FSCK_DEPTH + 1];
+
+  // Root Directory - chain of FAT32, fixed region of FAT12/16
+  // ----------------------------------------------------------------
+  if (FAT32->root_dir_clus_num >= FAT32_CLUSTER_FIRST) {
+    if (FSCK_ERROR == (bit = FSCK_Bit (FAT32->root_dir_clus_num, 1))) {
+      return FSCK_ERROR;
+    }
+    Entry.cluster = FAT32->root_dir_clus_num;
+    Entry.attribute = FAT32_ATTR_DIRECTORY;
+    if (bit || (FSCK_DAMAGED == FSCK_Chain (FAT32, &Entry))) {
+      Result->cross_linked += bit;
+      Result->size_mismatch++;
+      return FSCK_SUCCESS;                                                    // root not walked
+    }
+  }
+  FAT32_Dir_Open (FAT32, &Stack[0], 0);
+  Stack[0].hidden = 1;
+  Result->dirs = 1;
+
+  while (1) {
+    if (FAT32_ERROR == FAT32_Dir_Next (FAT32, &Stack[depth], &Entry, NULL)) {
+      if (Stack[depth].cluster != 0) {
+        return FSCK_ERROR;                                                    // read failed
+      }
+      if (depth == 0) {
+        break;
+      }
+      depth--;
+      continue;
+    }
+    if (Entry.attribute & FAT32_ATTR_DIRECTORY) {
+      if (NULL == (buffer = FAT32_Read_Sector (Entry.sector))) {
+        return FSCK_ERROR;
+      }
+      if (buffer[Entry.slot << 5] == '.') {
+        continue;                                                             // "." and ".."
+      }
+      Result->dirs++;
+    } else {
+      Result->files++;
+    }
+
+    // First Cluster
+    // --------------------------------------------------------------
+    bit = 0;
+    if (FSCK_Valid (FAT32, Entry.cluster)) {
+      if (FSCK_ERROR == (bit = FSCK_Bit (Entry.cluster, 1))) {
+        return FSCK_ERROR;
+      }
+      Result->cross_linked += bit;
+    } else if ((Entry.cluster != 0) || (Entry.attribute & FAT32_ATTR_DIRECTORY)) {
+      Result->invalid++;
+      continue;
+    }
+
+    // Chain, Subdirectory
+    // --------------------------------------------------------------
+    if (FSCK_DAMAGED == FSCK_Chain (FAT32, &Entry)) {
+      Result->size_mismatch++;
+    } else if ((Entry.attribute & FAT32_ATTR_DIRECTORY) && !bit) {
+      if (depth == FSCK_DEPTH) {
+        Result->too_deep++;
+      } else {
+        FAT32_Dir_Open (FAT32, &Stack[++depth], Entry.cluster);
+      }
+    }
+  }
+
+  return FSCK_SUCCESS;
+}
+
+/**
+ * @brief   Find Lost Chains And Links To Free Clusters
+ * @note    allocated cluster not referenced starts lost chain
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FSCK_t * result
+ *
+ * @return  uint8_t
+ */
+static uint8_t FSCK_Lost (FAT32_t * FAT32, FSCK_t * Result)
+{
+  uint8_t bit;
+  uint32_t next;
+  uint32_t cluster;
+  uint32_t length;
+
+  for (cluster = FAT32_CLUSTER_FIRST; cluster < (FAT32->clusters + FAT32_CLUSTER_FIRST); cluster++) {
+    if (FSCK_UNREADABLE == (next = FSCK_Next (FAT32, cluster))) {
+      return FSCK_ERROR;
+    }
+    if (FSCK_ERROR == (bit = FSCK_Bit (cluster, 0))) {
+      return FSCK_ERROR;
+    }
+    if ((next == FAT32_CLUSTER_FREE) || (next == FAT32_CLUSTER_BAD)) {
+      Result->broken += bit;
+    } else if (!bit) {
+      Result->lost_chains++;
+      for (length = 0; FSCK_Valid (FAT32, next) && (length < FAT32->clusters); length++) {
+        next = FAT32_FAT_Next_Cluster (FAT32, next) & FAT32_CLUSTER_MASK;
+      }
+      Result->lost_clusters += length + 1;
+    }
+  }
+
+  return FSCK_SUCCESS;
+}
+
+/**
+ * --------------------------------------------------------------------------------------------+
+ * PUBLIC FUNCTIONS
+ * --------------------------------------------------------------------------------------------+
+ */
+
+/**
+ * @brief   Check Consistency Of Mounted Volume
+ * @note    FAT copies compared, whole tree followed, one bit per cluster,
+ *          bitmap above FSCK_WINDOW_BYTES spills into FSCK_SPILL_PATH
+ *
+ * @param   FAT32_t * FAT32
+ * @param   FSCK_t * result
+ *
+ * @return  uint8_t FSCK_SUCCESS / FSCK_DAMAGED / FSCK_ERROR
+ */
+uint8_t FSCK_Check (FAT32_t * FAT32, FSCK_t * Result)
+{
+  uint8_t response = FSCK_ERROR;
+
+  memset (Result, 0, sizeof (FSCK_t));
+  FAT32_Cache_Invalidate ();                                                  // FAT sector held back by journal written
+
+  if ((FSCK_SUCCESS == FSCK_Bitmap (FAT32)) &&
+      (FSCK_SUCCESS == FSCK_Compare (FAT32, Result)) &&
+      (FSCK_SUCCESS == FSCK_Links (FAT32, Result)) &&
+      (FSCK_SUCCESS == FSCK_Tree (FAT32, Result)) &&
+      (Result->too_deep || (FSCK_SUCCESS == FSCK_Lost (FAT32, Result)))) {    // unfollowed trees look lost
+    response = (Result->fat_mismatch || Result->invalid || Result->cross_linked || Result->broken ||
+                Result->lost_chains || Result->size_mismatch) ? FSCK_DAMAGED : FSCK_SUCCESS;
+  }
+  FAT32_Cache_Invalidate ();                                                  // ends FAT stream, releases card
+
+  return response;
+}
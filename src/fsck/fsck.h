@@ -0,0 +1,70 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       FSCK - FAT consistency check
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        fsck.h
+ * @version     1.0
+ * @test        AVR Atmega328p
+ *
+ * @depend      fat32.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   SPI 4-wire
+ * @pins
+ *
+ * @sources
+ */
+
+#ifndef __FSCK_H__
+#define __FSCK_H__
+
+  #include "../fat32/fat32.h"                           // sector cache, FAT access, directories
+
+  // RETURN
+  // --------------------------------------------------------------------------------------
+  #define FSCK_ERROR                    0xff            // check not finished (card error, no spill file)
+  #define FSCK_SUCCESS                  0x00            // volume consistent
+  #define FSCK_DAMAGED                  0x01            // inconsistencies found, see FSCK_t
+
+  // Settings
+  // --------------------------------------------------------------------------------------
+  #define FSCK_WINDOW_BYTES             64              // bitmap bytes held in RAM (512 clusters), divides 512
+  #define FSCK_COMPARE_SECTORS          32              // FAT sectors compared per pass of both copies
+  #define FSCK_DEPTH                    8               // directory levels followed below root
+  #define FSCK_SPILL_PATH               "/FSCK.BIT"     // contiguous file holding bitmap of large volumes
+
+  // Check Result
+  // --------------------------------------------------------------------------------------
+  typedef struct FSCK_t {
+    uint32_t used;                                       // allocated clusters
+    uint32_t free;                                       // free clusters
+    uint32_t bad;                                        // clusters marked bad
+    uint32_t fat_mismatch;                               // FAT sectors differing between copies
+    uint32_t invalid;                                    // links out of cluster range
+    uint32_t cross_linked;                               // clusters referenced more than once
+    uint32_t broken;                                     // links to free or bad clusters
+    uint32_t lost_chains;                                // allocated chains without directory entry
+    uint32_t lost_clusters;                              // clusters of lost chains
+    uint16_t size_mismatch;                              // files with chain length not matching size
+    uint16_t files;                                      // files checked
+    uint16_t dirs;                                       // directories checked (root included)
+    uint16_t too_deep;                                   // directories below FSCK_DEPTH, not followed
+  } FSCK_t;
+
+  /**
+   * @brief   Check Consistency Of Mounted Volume
+   * @note    FAT copies compared, whole tree followed, one bit per cluster,
+   *          bitmap above FSCK_WINDOW_BYTES spills into FSCK_SPILL_PATH
+   *
+   * @param   FAT32_t * FAT32
+   * @param   FSCK_t * result
+   *
+   * @return  uint8_t FSCK_SUCCESS / FSCK_DAMAGED / FSCK_ERROR
+   */
+  uint8_t FSCK_Check (FAT32_t *, FSCK_t *);
+
+#endif
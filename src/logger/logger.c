@@ -0,0 +1,409 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       LOGGER - append only data logger in preallocated ring file
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        logger.c
+ * @version     1.0
+ * @test        AVR Atmega328p
+ *
+ * @depend      fat32.h, logger.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   SPI 4-wire
+ * @pins        MOSI, MISO, CLK, SS, UCC, USS
+ *
+ * @sources
+ */
+
+// INCLUDE libraries
+// ------------------------------------------------------------------
+#include <string.h>
+#include <util/atomic.h>
+#include "logger.h"
+
+/**
+ * @brief   Ring Sector Of Sequence
+ *
+ * @param   LOGGER_t * logger
+ * @param   uint32_t sequence (from 1)
+ *
+ * @return  uint32_t
+ */
+static inline uint32_t LOGGER_Slot (LOGGER_t * Logger, uint32_t sequence)
+{
+  return Logger->first + 1 + ((sequence - 1) % Logger->sectors);
+}
+
+/**
+ * @brief   Checksum Of Ring Header
+ * @note    computed with checksum field zeroed
+ *
+ * @param   LOGGER_Header_t * header
+ *
+ * @return  uint32_t
+ */
+static uint32_t LOGGER_Checksum (LOGGER_Header_t * Header)
+{
+  uint32_t sum = 0;
+  uint8_t * byte = (uint8_t *) Header;
+
+  FAT32_Put_4Bytes_LE (Header->Checksum, 0);
+  for (uint8_t i = 0; i < sizeof (LOGGER_Header_t); i++) {
+    sum = ((sum << 1) | (sum >> 31)) + byte[i];                               // rotate & add
+  }
+
+  return sum;
+}
+
+/**
+ * @brief   Write Ring Header - checkpoint
+ * @note    16 bytes written, rest of sector zeroed
+ *
+ * @param   LOGGER_t * logger
+ * @param   uint32_t last sequence on card
+ *
+ * @return  uint8_t
+ */
+static uint8_t LOGGER_Header (LOGGER_t * Logger, uint32_t sequence)
+{
+  LOGGER_Header_t Header;
+
+  memcpy (Header.Signature, LOGGER_SIGNATURE, 4);
+  FAT32_Put_4Bytes_LE (Header.Sequence, sequence);
+  FAT32_Put_4Bytes_LE (Header.Sectors, Logger->sectors);
+  FAT32_Put_4Bytes_LE (Header.Checksum, LOGGER_Checksum (&Header));
+  if (FAT32_ERROR == FAT32_Write_Part (Logger->first, (uint8_t *) &Header, sizeof (Header))) {
+    return LOGGER_ERROR;
+  }
+  Logger->checkpoint = sequence;
+  Logger->written = 0;
+
+  return LOGGER_SUCCESS;
+}
+
+/**
+ * @brief   Start Sector In Buffer
+ * @note    records put into spare meanwhile moved behind sector header
+ *
+ * @param   LOGGER_t * logger
+ *
+ * @return  void
+ */
+static void LOGGER_Begin (LOGGER_t * Logger)
+{
+  LOGGER_Sector_t * Sector = (LOGGER_Sector_t *) Logger->buffer;
+
+  FAT32_Put_4Bytes_LE (Sector->Sequence, Logger->sequence);
+  FAT32_Put_2Bytes_LE (Sector->Length, 0);
+  FAT32_Put_2Bytes_LE (Sector->First, Logger->start);
+  memcpy (&Logger->buffer[sizeof (LOGGER_Sector_t)], Logger->spare, Logger->waiting);
+  Logger->position = sizeof (LOGGER_Sector_t) + Logger->waiting;
+  Logger->waiting = 0;
+  Logger->start = LOGGER_NONE;
+}
+
+/**
+ * --------------------------------------------------------------------------------------+
+ * PUBLIC FUNCTIONS
+ * --------------------------------------------------------------------------------------+
+ */
+
+/**
+ * @brief   Create Log File
+ * @note    contiguous run of clusters allocated and zeroed by multiple block
+ *          writes from pool buffer, file size covers whole ring
+ *
+ * @param   FAT32_t * FAT32
+ * @param   char * name in root directory
+ * @param   uint32_t clusters
+ *
+ * @return  uint8_t
+ */
+uint8_t LOGGER_Create (FAT32_t * FAT32, char * name, uint32_t clusters)
+{
+  uint8_t * buffer;
+  FAT32_File_t File;
+  uint32_t sectors = clusters << FAT32->cluster_shift;
+
+  if (FAT32_ERROR == FAT32_Create (FAT32, &File, name)) {
+    return LOGGER_ERROR;
+  }
+  if ((FAT32_ERROR == FAT32_Allocate (FAT32, &File, clusters, 0)) ||
+      (NULL == (buffer = POOL_Borrow (POOL_OWNER_USER)))) {
+    FAT32_Close (FAT32, &File);
+    return LOGGER_ERROR;
+  }
+  memset (buffer, 0, BYTES_PER_SECTOR);                                       // sequence 0 = never written
+  while (sectors && (BYTES_PER_SECTOR == FAT32_Write (FAT32, &File, buffer, BYTES_PER_SECTOR))) {
+    sectors--;
+  }
+  POOL_Return (buffer, POOL_OWNER_USER);
+  if ((FAT32_ERROR == FAT32_Close (FAT32, &File)) || sectors) {
+    return LOGGER_ERROR;
+  }
+
+  return LOGGER_SUCCESS;
+}
+
+/**
+ * @brief   Open Log File, Find Head
+ * @note    header gives sequence at last checkpoint, sectors written later
+ *          found by following sequence numbers; partial last sector continued;
+ *          sector buffer borrowed from pool until LOGGER_Close
+ *
+ * @param   FAT32_t * FAT32
+ * @param   LOGGER_t * logger
+ * @param   char * path
+ * @param   uint8_t * spare for records put while sector is written
+ * @param   uint16_t size of spare
+ *
+ * @return  uint8_t LOGGER_ERROR also if no pool buffer free
+ */
+uint8_t LOGGER_Open (FAT32_t * FAT32, LOGGER_t * Logger, char * path, uint8_t * spare, uint16_t size)
+{
+  uint8_t * cache;
+  uint32_t i;
+  uint32_t sequence = 0;
+  uint32_t next;
+  FAT32_Index_t Entry;
+  FAT32_Fragments_t Fragments;
+  LOGGER_Header_t Header;
+
+  // Contiguous File - ring addressed without FAT lookup
+  // ----------------------------------------------------------------
+  if ((FAT32_ERROR == FAT32_Get_Path (FAT32, path, &Entry)) ||
+      (Entry.attribute & FAT32_ATTR_DIRECTORY) ||
+      (FAT32_ERROR == FAT32_Fragments (FAT32, &Entry, &Fragments)) ||
+      (Fragments.extents != 1) ||
+      ((Entry.size >> BYTES_PER_SECTOR_SHIFT) < 3) ||
+      ((Fragments.clusters << FAT32->cluster_shift) < (Entry.size >> BYTES_PER_SECTOR_SHIFT))) {
+    return LOGGER_ERROR;
+  }
+  Logger->first = FAT32_Get_1st_Sector_Of_Clus (FAT32, Entry.cluster);
+  Logger->sectors = (Entry.size >> BYTES_PER_SECTOR_SHIFT) - 1;
+
+  // Checkpoint - unreadable header: latest sector found in ring
+  // ----------------------------------------------------------------
+  if (NULL == (cache = FAT32_Read_Sector (Logger->first))) {
+    return LOGGER_ERROR;
+  }
+  memcpy (&Header, cache, sizeof (Header));
+  next = FAT32_Get_4Bytes_LE (Header.Checksum);
+  if ((memcmp (Header.Signature, LOGGER_SIGNATURE, 4) == 0) &&
+      (FAT32_Get_4Bytes_LE (Header.Sectors) == Logger->sectors) &&
+      (next == LOGGER_Checksum (&Header))) {
+    sequence = FAT32_Get_4Bytes_LE (Header.Sequence);
+  } else {
+    for (i = 0; i < Logger->sectors; i++) {
+      if (NULL == (cache = FAT32_Read_Stream (Logger->first + 1 + i))) {
+        return LOGGER_ERROR;
+      }
+      next = FAT32_Get_4Bytes_LE (((LOGGER_Sector_t *) cache)->Sequence);
+      if ((next > sequence) && (((next - 1) % Logger->sectors) == i)) {
+        sequence = next;
+      }
+    }
+  }
+
+  // Head - sectors written behind checkpoint
+  // ----------------------------------------------------------------
+  for (i = 0; i < Logger->sectors; i++) {
+    if (NULL == (cache = FAT32_Read_Stream (LOGGER_Slot (Logger, sequence + 1)))) {
+      return LOGGER_ERROR;
+    }
+    if (FAT32_Get_4Bytes_LE (((LOGGER_Sector_t *) cache)->Sequence) != (sequence + 1)) {
+      break;
+    }
+    sequence++;
+  }
+
+  // Continue Partial Head Sector
+  // ----------------------------------------------------------------
+  Logger->spare = spare;
+  Logger->size = (size < LOGGER_DATA) ? size : (LOGGER_DATA - 1);             // sector never full after spare moved in
+  Logger->waiting = 0;
+  Logger->start = LOGGER_NONE;
+  Logger->pending = 0;
+  Logger->dropped = 0;
+  Logger->written = 0;
+  Logger->checkpoint = sequence;
+  Logger->sequence = sequence + 1;
+  if (sequence) {
+    if (NULL == (cache = FAT32_Read_Sector (LOGGER_Slot (Logger, sequence)))) {
+      return LOGGER_ERROR;
+    }
+    if (FAT32_Get_2Bytes_LE (((LOGGER_Sector_t *) cache)->Length) < LOGGER_DATA) {
+      Logger->sequence = sequence;
+    }
+  }
+
+  // Sector Buffer - borrowed from pool, e.g. storage of RAM index
+  // ----------------------------------------------------------------
+  if (NULL == (Logger->buffer = POOL_Borrow (POOL_OWNER_USER))) {
+    return LOGGER_ERROR;
+  }
+  if (Logger->sequence == sequence) {
+    memcpy (Logger->buffer, cache, BYTES_PER_SECTOR);
+    Logger->position = sizeof (LOGGER_Sector_t) + FAT32_Get_2Bytes_LE (((LOGGER_Sector_t *) cache)->Length);
+  } else {
+    LOGGER_Begin (Logger);
+  }
+
+  return LOGGER_SUCCESS;
+}
+
+/**
+ * @brief   Append Record
+ * @note    copies record into RAM buffer only, no card access, so it can be
+ *          called from interrupt; record is dropped when sector and spare
+ *          are full
+ *
+ * @param   LOGGER_t * logger
+ * @param   uint8_t * record
+ * @param   uint16_t length
+ *
+ * @return  uint8_t LOGGER_ERROR if dropped
+ */
+uint8_t LOGGER_Put (LOGGER_t * Logger, uint8_t * record, uint16_t length)
+{
+  uint16_t chunk = 0;
+  LOGGER_Sector_t * Sector = (LOGGER_Sector_t *) Logger->buffer;
+
+  // Room - rest of sector, spare while sector is written
+  // ----------------------------------------------------------------
+  if (length > ((Logger->pending ? 0 : (BYTES_PER_SECTOR - Logger->position)) + (Logger->size - Logger->waiting))) {
+    Logger->dropped += length;
+    return LOGGER_ERROR;
+  }
+  if (!Logger->pending) {
+    if (FAT32_Get_2Bytes_LE (Sector->First) == LOGGER_NONE) {
+      FAT32_Put_2Bytes_LE (Sector->First, Logger->position - sizeof (LOGGER_Sector_t));
+    }
+    chunk = BYTES_PER_SECTOR - Logger->position;
+    if (chunk > length) {
+      chunk = length;
+    }
+    memcpy (&Logger->buffer[Logger->position], record, chunk);
+    Logger->position += chunk;
+    // Sector Full - handed over to LOGGER_Task
+    if (Logger->position == BYTES_PER_SECTOR) {
+      FAT32_Put_2Bytes_LE (Sector->Length, LOGGER_DATA);
+      Logger->pending = 1;
+    }
+  }
+
+  // Spare - rest of record, moved into next sector by LOGGER_Task
+  // ----------------------------------------------------------------
+  if (length > chunk) {
+    if (!chunk && (Logger->start == LOGGER_NONE)) {
+      Logger->start = Logger->waiting;
+    }
+    memcpy (&Logger->spare[Logger->waiting], &record[chunk], length - chunk);
+    Logger->waiting += length - chunk;
+  }
+
+  return LOGGER_SUCCESS;
+}
+
+/**
+ * @brief   Write Full Buffer
+ * @note    called from main loop, at most one sector written per call (and
+ *          ring header every LOGGER_CHECKPOINT sectors), consecutive sectors
+ *          continue one multiple block write; next sector starts with spare
+ *
+ * @param   LOGGER_t * logger
+ *
+ * @return  uint8_t
+ */
+uint8_t LOGGER_Task (LOGGER_t * Logger)
+{
+  uint32_t sequence = Logger->sequence;
+
+  if (!Logger->pending) {
+    return LOGGER_SUCCESS;
+  }
+  if (FAT32_ERROR == FAT32_Write_Stream (LOGGER_Slot (Logger, sequence), Logger->buffer)) {
+    return LOGGER_ERROR;                                                      // buffer kept, retried next call
+  }
+  ATOMIC_BLOCK (ATOMIC_RESTORESTATE) {
+    Logger->sequence++;
+    LOGGER_Begin (Logger);                                                    // records put while written moved in
+    Logger->pending = 0;
+  }
+
+  // Checkpoint - header never more than half ring behind head
+  // ----------------------------------------------------------------
+  if ((++Logger->written >= LOGGER_CHECKPOINT) || (Logger->written >= (Logger->sectors >> 1))) {
+    return LOGGER_Header (Logger, sequence);
+  }
+
+  return LOGGER_SUCCESS;
+}
+
+/**
+ * @brief   Checkpoint - write partial sector and ring header
+ * @note    filled buffer and its length taken with interrupts off, records
+ *          appended later stay behind length until next write of sector
+ *
+ * @param   LOGGER_t * logger
+ *
+ * @return  uint8_t
+ */
+uint8_t LOGGER_Sync (LOGGER_t * Logger)
+{
+  uint8_t pending;
+  uint8_t * buffer = Logger->buffer;
+  uint16_t position;
+  uint32_t sequence;
+
+  // Snapshot - full sector written first, so header never skips one
+  // ----------------------------------------------------------------
+  do {
+    if (LOGGER_ERROR == LOGGER_Task (Logger)) {
+      return LOGGER_ERROR;
+    }
+    ATOMIC_BLOCK (ATOMIC_RESTORESTATE) {
+      pending = Logger->pending;
+      position = Logger->position;
+      sequence = Logger->sequence;
+      if (!pending && (position > sizeof (LOGGER_Sector_t))) {
+        FAT32_Put_2Bytes_LE (((LOGGER_Sector_t *) buffer)->Length, position - sizeof (LOGGER_Sector_t));
+      }
+    }
+  } while (pending);
+
+  if (position > sizeof (LOGGER_Sector_t)) {
+    if (FAT32_ERROR == FAT32_Write_Stream (LOGGER_Slot (Logger, sequence), buffer)) {
+      return LOGGER_ERROR;
+    }
+  } else {
+    sequence--;                                                               // nothing in buffer yet
+  }
+  if (sequence == Logger->checkpoint) {
+    return LOGGER_SUCCESS;
+  }
+
+  return LOGGER_Header (Logger, sequence);
+}
+
+/**
+ * @brief   Close Log File
+ * @note    checkpoint written, sector buffer returned to pool
+ *
+ * @param   LOGGER_t * logger
+ *
+ * @return  uint8_t
+ */
+uint8_t LOGGER_Close (LOGGER_t * Logger)
+{
+  uint8_t status = LOGGER_Sync (Logger);
+
+  POOL_Return (Logger->buffer, POOL_OWNER_USER);
+  Logger->buffer = NULL;
+
+  return status;
+}
@@ -0,0 +1,151 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       LOGGER - append only data logger in preallocated ring file
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        logger.h
+ * @version     1.0
+ * @test        AVR Atmega328p
+ *
+ * @depend      fat32.h
+ * --------------------------------------------------------------------------------------+
+ * @interface   SPI 4-wire
+ * @pins
+ *
+ * @sources
+ */
+
+#ifndef __LOGGER_H__
+#define __LOGGER_H__
+
+  #include "../fat32/fat32.h"                           // contiguous file, multiple block writes
+
+  // RETURN
+  // --------------------------------------------------------------------------------------
+  #define LOGGER_ERROR                  0xff            // card error, file not usable, record dropped
+  #define LOGGER_SUCCESS                0x00
+
+  // Settings
+  // --------------------------------------------------------------------------------------
+  #define LOGGER_SIGNATURE              "SDLG"
+  #define LOGGER_CHECKPOINT             64              // sectors written between header updates
+  #define LOGGER_NONE                   0xFFFF          // no record starts in sector
+
+  // Ring Header (sector 0 of log file)
+  // --------------------------------------------------------------------------------------
+  // 16 Bytes
+  typedef struct LOGGER_Header_t {
+    uint8_t Signature[4];                               // "SDLG"
+    uint8_t Sequence[4];                                // last sector on card at checkpoint, 0 = empty
+    uint8_t Sectors[4];                                 // sectors of ring behind header
+    uint8_t Checksum[4];                                // of header, this field zeroed
+  } LOGGER_Header_t;
+
+  // Sector Header (start of every ring sector)
+  // --------------------------------------------------------------------------------------
+  // 8 Bytes
+  typedef struct LOGGER_Sector_t {
+    uint8_t Sequence[4];                                // sectors written since file was created, from 1
+    uint8_t Length[2];                                  // data bytes behind sector header
+    uint8_t First[2];                                   // offset of first record starting in sector, LOGGER_NONE
+  } LOGGER_Sector_t;
+
+  #define LOGGER_DATA                   (BYTES_PER_SECTOR - sizeof (LOGGER_Sector_t))
+
+  // Logger
+  // --------------------------------------------------------------------------------------
+  typedef struct LOGGER_t {
+    uint8_t * buffer;                                    // sector borrowed from pool while open
+    uint8_t * spare;                                     // caller storage, records put while sector is written
+    uint32_t first;                                      // 1st sector of log file (ring header)
+    uint32_t sectors;                                    // sectors of ring
+    uint32_t sequence;                                   // sequence of sector in buffer
+    uint32_t checkpoint;                                 // sequence stored in ring header
+    uint32_t dropped;                                    // bytes dropped, sector and spare full
+    uint16_t size;                                       // bytes of spare used, below LOGGER_DATA
+    uint16_t written;                                    // sectors written since checkpoint
+    volatile uint16_t position;                          // bytes in buffer, sector header included
+    volatile uint16_t waiting;                           // bytes in spare
+    volatile uint16_t start;                             // offset of first record starting in spare, LOGGER_NONE
+    volatile uint8_t pending;                            // buffer full, written by LOGGER_Task
+  } LOGGER_t;
+
+  /**
+   * @brief   Create Log File
+   * @note    contiguous run of clusters allocated and zeroed by multiple block
+   *          writes from pool buffer, file size covers whole ring
+   *
+   * @param   FAT32_t * FAT32
+   * @param   char * name in root directory
+   * @param   uint32_t clusters
+   *
+   * @return  uint8_t
+   */
+  uint8_t LOGGER_Create (FAT32_t *, char *, uint32_t);
+
+  /**
+   * @brief   Open Log File, Find Head
+   * @note    header gives sequence at last checkpoint, sectors written later
+   *          found by following sequence numbers; partial last sector continued;
+   *          sector buffer borrowed from pool until LOGGER_Close
+   *
+   * @param   FAT32_t * FAT32
+   * @param   LOGGER_t * logger
+   * @param   char * path
+   * @param   uint8_t * spare for records put while sector is written
+   * @param   uint16_t size of spare
+   *
+   * @return  uint8_t LOGGER_ERROR also if no pool buffer free
+   */
+  uint8_t LOGGER_Open (FAT32_t *, LOGGER_t *, char *, uint8_t *, uint16_t);
+
+  /**
+   * @brief   Append Record
+   * @note    copies record into RAM buffer only, no card access, so it can be
+   *          called from interrupt; record is dropped when sector and spare
+   *          are full
+   *
+   * @param   LOGGER_t * logger
+   * @param   uint8_t * record
+   * @param   uint16_t length
+   *
+   * @return  uint8_t LOGGER_ERROR if dropped
+   */
+  uint8_t LOGGER_Put (LOGGER_t *, uint8_t *, uint16_t);
+
+  /**
+   * @brief   Write Full Buffer
+   * @note    called from main loop, at most one sector written per call (and
+   *          ring header every LOGGER_CHECKPOINT sectors), consecutive sectors
+   *          continue one multiple block write
+   *
+   * @param   LOGGER_t * logger
+   *
+   * @return  uint8_t
+   */
+  uint8_t LOGGER_Task (LOGGER_t *);
+
+  /**
+   * @brief   Checkpoint - write partial sector and ring header
+   *
+   * @param   LOGGER_t * logger
+   *
+   * @return  uint8_t
+   */
+  uint8_t LOGGER_Sync (LOGGER_t *);
+
+  /**
+   * @brief   Close Log File
+   * @note    checkpoint written, sector buffer returned to pool
+   *
+   * @param   LOGGER_t * logger
+   *
+   * @return  uint8_t
+   */
+  uint8_t LOGGER_Close (LOGGER_t *);
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       POOL - sector buffers lent by their owners
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        pool.c
+ * @version     1.0
+ * @test        AVR Atmega328p
+ *
+ * @depend      pool.h
+ * --------------------------------------------------------------------------------------+
+ * @interface
+ * @pins
+ *
+ * @sources
+ */
+
+// INCLUDE libraries
+// ------------------------------------------------------------------
+#include "pool.h"
+#ifdef POOL_DEBUG
+  #include <assert.h>
+#endif
+
+// Slots
+// ------------------------------------------------------------------
+static uint8_t * POOL_Buffer[POOL_BUFFERS];                                   // lent buffer or NULL
+static uint8_t POOL_Owner[POOL_BUFFERS];                                      // POOL_FREE or owner of buffer
+
+/**
+ * @brief   Lend Sector Buffer To Pool
+ * @note    storage of POOL_BUFFER_SIZE bytes at least, idle while lent
+ *
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t POOL_ERROR if all slots taken
+ */
+uint8_t POOL_Lend (uint8_t * buffer)
+{
+  uint8_t i;
+
+  for (i = 0; i < POOL_BUFFERS; i++) {
+    if (POOL_Buffer[i] == buffer) {
+      return POOL_SUCCESS;                                                    // lent already
+    }
+  }
+  for (i = 0; i < POOL_BUFFERS; i++) {
+    if (POOL_Buffer[i] == NULL) {
+      POOL_Buffer[i] = buffer;
+      POOL_Owner[i] = POOL_FREE;
+      return POOL_SUCCESS;
+    }
+  }
+
+  return POOL_ERROR;
+}
+
+/**
+ * @brief   Take Lent Sector Buffer Back
+ *
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t POOL_ERROR while borrowed
+ */
+uint8_t POOL_Reclaim (uint8_t * buffer)
+{
+  uint8_t i;
+
+  for (i = 0; i < POOL_BUFFERS; i++) {
+    if (POOL_Buffer[i] == buffer) {
+      if (POOL_Owner[i] != POOL_FREE) {
+        return POOL_ERROR;
+      }
+      POOL_Buffer[i] = NULL;
+    }
+  }
+
+  return POOL_SUCCESS;
+}
+
+/**
+ * @brief   Borrow Sector Buffer
+ *
+ * @param   uint8_t owner
+ *
+ * @return  uint8_t * NULL if all buffers borrowed
+ */
+uint8_t * POOL_Borrow (uint8_t owner)
+{
+  uint8_t i;
+
+#ifdef POOL_DEBUG
+  assert (owner != POOL_FREE);
+  for (i = 0; i < POOL_BUFFERS; i++) {
+    assert (POOL_Owner[i] != owner);                                          // one buffer per owner
+  }
+#endif
+  for (i = 0; i < POOL_BUFFERS; i++) {
+    if ((POOL_Buffer[i] != NULL) && (POOL_Owner[i] == POOL_FREE)) {
+      POOL_Owner[i] = owner;
+      return POOL_Buffer[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Return Sector Buffer
+ * @note    debug build checks buffer is lent to pool and belongs to owner
+ *
+ * @param   uint8_t * buffer
+ * @param   uint8_t owner
+ *
+ * @return  void
+ */
+void POOL_Return (uint8_t * buffer, uint8_t owner)
+{
+  uint8_t i;
+
+  for (i = 0; i < POOL_BUFFERS; i++) {
+    if ((buffer != NULL) && (buffer == POOL_Buffer[i])) {
+#ifdef POOL_DEBUG
+      assert (POOL_Owner[i] == owner);                                        // returned by borrower only once
+#endif
+      POOL_Owner[i] = POOL_FREE;
+      return;
+    }
+  }
+#ifdef POOL_DEBUG
+  assert (0);                                                                 // not a buffer of pool
+#endif
+}
+
+/**
+ * @brief   Number Of Free Buffers
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+uint8_t POOL_Free (void)
+{
+  uint8_t i;
+  uint8_t free = 0;
+
+  for (i = 0; i < POOL_BUFFERS; i++) {
+    if ((POOL_Buffer[i] != NULL) && (POOL_Owner[i] == POOL_FREE)) {
+      free++;
+    }
+  }
+
+  return free;
+}
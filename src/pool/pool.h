@@ -0,0 +1,95 @@
+/**
+ * --------------------------------------------------------------------------------------+
+ * @brief       POOL - sector buffers lent by their owners
+ * --------------------------------------------------------------------------------------+
+ *              Copyright (C) 2024 Marian Hrinko.
+ *              Written by Marian Hrinko (mato.hrinko@gmail.com)
+ *
+ * @author      Marian Hrinko
+ * @date        18.10.2026
+ * @file        pool.h
+ * @version     1.0
+ * @test        AVR Atmega328p
+ *
+ * @depend      stdint.h
+ * --------------------------------------------------------------------------------------+
+ * @interface
+ * @pins
+ *
+ * @sources
+ */
+
+#ifndef __POOL_H__
+#define __POOL_H__
+
+  #include <stdint.h>
+  #include <stddef.h>
+
+  // Settings
+  // --------------------------------------------------------------------------------------
+  #define POOL_BUFFERS                  2               // slots for lent sector buffers (3 bytes RAM each)
+  #define POOL_BUFFER_SIZE              512             // bytes per buffer (one sector)
+//#define POOL_DEBUG                                    // ownership checked by assert
+
+  // Return Codes
+  // --------------------------------------------------------------------------------------
+  #define POOL_SUCCESS                  0
+  #define POOL_ERROR                    0xff
+
+  // Owners
+  // --------------------------------------------------------------------------------------
+  #define POOL_FREE                     0               // buffer not borrowed
+  #define POOL_OWNER_INDEX              1               // rebuild of directory index file
+  #define POOL_OWNER_SORT               2               // sorted view of root directory
+  #define POOL_OWNER_USER               3               // application (defragment, logger, check)
+  #define POOL_OWNER_WRITE              4               // partial data sectors while FAT sector is held
+
+  /**
+   * @brief   Lend Sector Buffer To Pool
+   * @note    storage of POOL_BUFFER_SIZE bytes at least, idle while lent
+   *
+   * @param   uint8_t * buffer
+   *
+   * @return  uint8_t POOL_ERROR if all slots taken
+   */
+  uint8_t POOL_Lend (uint8_t *);
+
+  /**
+   * @brief   Take Lent Sector Buffer Back
+   *
+   * @param   uint8_t * buffer
+   *
+   * @return  uint8_t POOL_ERROR while borrowed
+   */
+  uint8_t POOL_Reclaim (uint8_t *);
+
+  /**
+   * @brief   Borrow Sector Buffer
+   *
+   * @param   uint8_t owner
+   *
+   * @return  uint8_t * NULL if all buffers borrowed
+   */
+  uint8_t * POOL_Borrow (uint8_t);
+
+  /**
+   * @brief   Return Sector Buffer
+   * @note    debug build checks buffer is lent to pool and belongs to owner
+   *
+   * @param   uint8_t * buffer
+   * @param   uint8_t owner
+   *
+   * @return  void
+   */
+  void POOL_Return (uint8_t *, uint8_t);
+
+  /**
+   * @brief   Number Of Free Buffers
+   *
+   * @param   void
+   *
+   * @return  uint8_t
+   */
+  uint8_t POOL_Free (void);
+
+#endif
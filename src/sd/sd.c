@@ -166,7 +166,7 @@ uint8_t SD_Read_Block (uint32_t address, uint8_t * buffer)
     }
     // fill buffer with 512 bytes
     // --------------------------------------------------------------
-    if (token == 0xfe) {                                // start token
+    if (token == SD_START_TOKEN) {                      // start token
       for (i=0; i<SD_SDHC_BLOCKLEN; i++) {
         buffer[i] = SPI_Transfer (0xff);
       }
@@ -184,6 +184,315 @@ uint8_t SD_Read_Block (uint32_t address, uint8_t * buffer)
   return token;
 }
 
+/**
+ * @brief   SD Card Start Multiple Block Read
+ * @note    card stays selected until SD_Read_Stop, no other command between
+ *
+ * @param   uint32_t address of first block
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Read_Start (uint32_t address)
+{
+  SPI_Transfer (0xff);                                  // dummy byte
+  SD_CS_Enable ();                                      // CS low
+  SPI_Transfer (0xff);                                  // dummy byte
+
+  // === R1 response ===
+  // ----------------------------------------------------------------
+  SD_Send_Command (SD_CMD18, address, 0x00);
+  if (SD_Get_Response_R1 () != SD_R1_CARD_READY) {
+    SPI_Transfer (0xff);                                // dummy byte
+    SD_CS_Disable ();                                   // CS high
+    SPI_Transfer (0xff);                                // dummy byte
+    return SD_ERROR;
+  }
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   SD Card Read Next Block Of Multiple Block Read
+ *
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t SD_START_TOKEN if block read
+ */
+uint8_t SD_Read_Next (uint8_t * buffer)
+{
+  uint8_t token = 0xff;
+  uint16_t i = 0;
+
+  // max 100ms
+  // ----------------------------------------------------------------
+  while (++i < SD_ATTEMPTS_CMD17) {
+    if ((token = SPI_Transfer (0xff)) != 0xff) {
+      break;
+    }
+  }
+  // fill buffer with 512 bytes
+  // ----------------------------------------------------------------
+  if (token == SD_START_TOKEN) {                        // start token
+    for (i=0; i<SD_SDHC_BLOCKLEN; i++) {
+      buffer[i] = SPI_Transfer (0xff);
+    }
+    // CRC 16bit
+    // --------------------------------------------------------------
+    SPI_Transfer (0xff);
+    SPI_Transfer (0xff);
+  }
+
+  return token;
+}
+
+/**
+ * @brief   SD Card Stop Multiple Block Read
+ * @note    card may already send next block, CMD12 aborts it
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Read_Stop (void)
+{
+  uint8_t response = SD_SUCCESS;
+  uint16_t i = 0;
+
+  SD_Send_Command (SD_CMD12, 0, 0x00);
+  SPI_Transfer (0xff);                                  // stuff byte
+  if (SD_Get_Response_R1 () != SD_R1_CARD_READY) {
+    response = SD_ERROR;
+  }
+  // busy - R1b
+  // ----------------------------------------------------------------
+  while (SPI_Transfer (0xff) == 0x00) {
+    if (++i == SD_ATTEMPTS_CMD24) {
+      response = SD_ERROR;
+      break;
+    }
+  }
+
+  SPI_Transfer (0xff);                                  // dummy byte
+  SD_CS_Disable ();                                     // CS high
+  SPI_Transfer (0xff);                                  // dummy byte
+
+  return response;
+}
+
+/**
+ * @brief   SD Card Write Data
+ *
+ * @param   uint32_t address
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Write_Block (uint32_t address, uint8_t * buffer)
+{
+  return SD_Write_Part (address, buffer, SD_SDHC_BLOCKLEN);
+}
+
+/**
+ * @brief   SD Card Write Data Shorter Than Block
+ * @note    bytes behind length sent as zeros, no block buffer needed
+ *
+ * @param   uint32_t address
+ * @param   uint8_t * buffer
+ * @param   uint16_t length
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Write_Part (uint32_t address, uint8_t * buffer, uint16_t length)
+{
+  uint8_t r1;
+  uint8_t response = SD_ERROR;
+  uint16_t i = 0;
+
+  SPI_Transfer (0xff);                                  // dummy byte
+  SD_CS_Enable ();                                      // CS low
+  SPI_Transfer (0xff);                                  // dummy byte
+
+  // === R1 response ===
+  // ----------------------------------------------------------------
+  SD_Send_Command (SD_CMD24, address, 0x00);
+  r1 = SD_Get_Response_R1 ();                           // get R1
+
+  if (r1 == SD_R1_CARD_READY) {                         // card ready
+    // start token & 512 bytes
+    // --------------------------------------------------------------
+    SPI_Transfer (SD_START_TOKEN);
+    for (i=0; i<SD_SDHC_BLOCKLEN; i++) {
+      SPI_Transfer ((i < length) ? buffer[i] : 0x00);
+    }
+    // CRC 16bit (ignored)
+    // --------------------------------------------------------------
+    SPI_Transfer (0xff);
+    SPI_Transfer (0xff);
+    // data response
+    // --------------------------------------------------------------
+    if ((SPI_Transfer (0xff) & SD_DATA_RESPONSE_MASK) == SD_DATA_ACCEPTED) {
+      // busy - card holds DAT0 low while programming
+      // ------------------------------------------------------------
+      i = 0;
+      while (SPI_Transfer (0xff) == 0x00) {
+        if (++i == SD_ATTEMPTS_CMD24) {
+          break;
+        }
+      }
+      if (i != SD_ATTEMPTS_CMD24) {
+        response = SD_SUCCESS;
+      }
+    }
+  }
+
+  SPI_Transfer (0xff);                                  // dummy byte
+  SD_CS_Disable ();                                     // CS high
+  SPI_Transfer (0xff);                                  // dummy byte
+
+  return response;
+}
+
+/**
+ * @brief   SD Card Start Multiple Block Write
+ * @note    card stays selected until SD_Write_Stop, no other command between
+ *
+ * @param   uint32_t address of first block
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Write_Start (uint32_t address)
+{
+  SPI_Transfer (0xff);                                  // dummy byte
+  SD_CS_Enable ();                                      // CS low
+  SPI_Transfer (0xff);                                  // dummy byte
+
+  // === R1 response ===
+  // ----------------------------------------------------------------
+  SD_Send_Command (SD_CMD25, address, 0x00);
+  if (SD_Get_Response_R1 () != SD_R1_CARD_READY) {
+    SPI_Transfer (0xff);                                // dummy byte
+    SD_CS_Disable ();                                   // CS high
+    SPI_Transfer (0xff);                                // dummy byte
+    return SD_ERROR;
+  }
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   SD Card Write Next Block Of Multiple Block Write
+ *
+ * @param   uint8_t * buffer
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Write_Next (uint8_t * buffer)
+{
+  uint16_t i = 0;
+
+  // start token & 512 bytes
+  // ----------------------------------------------------------------
+  SPI_Transfer (0xff);                                  // gap before token
+  SPI_Transfer (SD_START_TOKEN_CMD25);
+  for (i=0; i<SD_SDHC_BLOCKLEN; i++) {
+    SPI_Transfer (buffer[i]);
+  }
+  // CRC 16bit (ignored)
+  // ----------------------------------------------------------------
+  SPI_Transfer (0xff);
+  SPI_Transfer (0xff);
+  // data response
+  // ----------------------------------------------------------------
+  if ((SPI_Transfer (0xff) & SD_DATA_RESPONSE_MASK) != SD_DATA_ACCEPTED) {
+    return SD_ERROR;
+  }
+  // busy - card holds DAT0 low while programming
+  // ----------------------------------------------------------------
+  i = 0;
+  while (SPI_Transfer (0xff) == 0x00) {
+    if (++i == SD_ATTEMPTS_CMD24) {
+      return SD_ERROR;
+    }
+  }
+
+  return SD_SUCCESS;
+}
+
+/**
+ * @brief   SD Card Stop Multiple Block Write
+ *
+ * @param   void
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Write_Stop (void)
+{
+  uint8_t response = SD_SUCCESS;
+  uint16_t i = 0;
+
+  SPI_Transfer (SD_STOP_TOKEN_CMD25);
+  SPI_Transfer (0xff);                                  // busy starts one byte later
+  while (SPI_Transfer (0xff) == 0x00) {
+    if (++i == SD_ATTEMPTS_CMD24) {
+      response = SD_ERROR;
+      break;
+    }
+  }
+
+  SPI_Transfer (0xff);                                  // dummy byte
+  SD_CS_Disable ();                                     // CS high
+  SPI_Transfer (0xff);                                  // dummy byte
+
+  return response;
+}
+
+/**
+ * @brief   SD Card Erase Blocks
+ * @note    erased blocks read as 0x00 or 0xff, depends on card
+ *
+ * @param   uint32_t address of first block
+ * @param   uint32_t address of last block
+ *
+ * @return  uint8_t
+ */
+uint8_t SD_Erase (uint32_t start, uint32_t end)
+{
+  uint8_t r[1];
+  uint8_t response = SD_ERROR;
+  uint32_t i = 0;
+
+  if (SD_Send_CMDx (SD_CMD32, start, 0x00, r, SD_R1) != SD_R1_CARD_READY) {
+    return SD_ERROR;
+  }
+  if (SD_Send_CMDx (SD_CMD33, end, 0x00, r, SD_R1) != SD_R1_CARD_READY) {
+    return SD_ERROR;
+  }
+
+  SPI_Transfer (0xff);                                  // dummy byte
+  SD_CS_Enable ();                                      // CS low
+  SPI_Transfer (0xff);                                  // dummy byte
+
+  // === R1b response ===
+  // ----------------------------------------------------------------
+  SD_Send_Command (SD_CMD38, 0, 0x00);
+  if (SD_Get_Response_R1 () == SD_R1_CARD_READY) {
+    while (SPI_Transfer (0xff) == 0x00) {               // busy while erasing
+      if (++i == SD_ATTEMPTS_CMD38) {
+        break;
+      }
+    }
+    if (i != SD_ATTEMPTS_CMD38) {
+      response = SD_SUCCESS;
+    }
+  }
+
+  SPI_Transfer (0xff);                                  // dummy byte
+  SD_CS_Disable ();                                     // CS high
+  SPI_Transfer (0xff);                                  // dummy byte
+
+  return response;
+}
+
 /**
  * @brief   SD Card Power Up Sequence
  *
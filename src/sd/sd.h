@@ -86,6 +86,9 @@
   #define SD_ACMD23               (0x40+23)   // SET_WR_BLK_ERASE_COUNT (SDC)
   #define SD_CMD24                (0x40+24)   // WRITE_BLOCK
   #define SD_CMD25                (0x40+25)   // WRITE_MULTIPLE_BLOCK
+  #define SD_CMD32                (0x40+32)   // ERASE_WR_BLK_START_ADDR
+  #define SD_CMD33                (0x40+33)   // ERASE_WR_BLK_END_ADDR
+  #define SD_CMD38                (0x40+38)   // ERASE
   #define SD_CMD59                (0x40+59)   // CRC_ON_OFF
 
   #define SD_R1                   1
@@ -98,6 +101,8 @@
   #define SD_ATTEMPTS_CMD8        0xff
   #define SD_ATTEMPTS_CMD55       0xff
   #define SD_ATTEMPTS_CMD17       1563
+  #define SD_ATTEMPTS_CMD24       0xffff      // busy wait after write, max 250ms
+  #define SD_ATTEMPTS_CMD38       0xffffffff  // busy wait after erase, card dependent
 
   #define SD_R1_CARD_READY        0x00
   #define SD_R1_IDLE_STATE        0x01
@@ -113,6 +118,11 @@
   #define SD_CMD58_CCS            0x40
 
   #define SD_SDHC_BLOCKLEN        512
+  #define SD_START_TOKEN          0xfe        // start block token for single / multiple block read
+  #define SD_START_TOKEN_CMD25    0xfc        // start block token for multiple block write
+  #define SD_STOP_TOKEN_CMD25     0xfd        // stop transmission token for multiple block write
+  #define SD_DATA_RESPONSE_MASK   0x1f        // data response token xxx0sss1
+  #define SD_DATA_ACCEPTED        0x05        // data accepted
   
   typedef struct SD {
     uint8_t voltage;                          // 0 - rejected, 1 - accepted / CMD8
@@ -139,6 +149,95 @@
    */
   uint8_t SD_Read_Block (uint32_t, uint8_t *);
 
+  /**
+   * @brief   SD Card Start Multiple Block Read
+   * @note    card stays selected until SD_Read_Stop, no other command between
+   *
+   * @param   uint32_t address of first block
+   *
+   * @return  uint8_t
+   */
+  uint8_t SD_Read_Start (uint32_t);
+
+  /**
+   * @brief   SD Card Read Next Block Of Multiple Block Read
+   *
+   * @param   uint8_t * buffer
+   *
+   * @return  uint8_t SD_START_TOKEN if block read
+   */
+  uint8_t SD_Read_Next (uint8_t *);
+
+  /**
+   * @brief   SD Card Stop Multiple Block Read
+   *
+   * @param   void
+   *
+   * @return  uint8_t
+   */
+  uint8_t SD_Read_Stop (void);
+
+  /**
+   * @brief   SD Card Write Data
+   *
+   * @param   uint32_t
+   * @param   uint8_t *
+   *
+   * @return  uint8_t
+   */
+  uint8_t SD_Write_Block (uint32_t, uint8_t *);
+
+  /**
+   * @brief   SD Card Write Data Shorter Than Block
+   * @note    bytes behind length sent as zeros
+   *
+   * @param   uint32_t
+   * @param   uint8_t *
+   * @param   uint16_t
+   *
+   * @return  uint8_t
+   */
+  uint8_t SD_Write_Part (uint32_t, uint8_t *, uint16_t);
+
+  /**
+   * @brief   SD Card Start Multiple Block Write
+   * @note    card stays selected until SD_Write_Stop, no other command between
+   *
+   * @param   uint32_t address of first block
+   *
+   * @return  uint8_t
+   */
+  uint8_t SD_Write_Start (uint32_t);
+
+  /**
+   * @brief   SD Card Write Next Block Of Multiple Block Write
+   *
+   * @param   uint8_t * buffer
+   *
+   * @return  uint8_t
+   */
+  uint8_t SD_Write_Next (uint8_t *);
+
+  /**
+   * @brief   SD Card Stop Multiple Block Write
+   *
+   * @param   void
+   *
+   * @return  uint8_t
+   */
+  uint8_t SD_Write_Stop (void);
+
+  /**
+   * @brief   SD Card Erase Blocks
+   * @note    erased blocks read as 0x00 or 0xff, depends on card
+   *
+   * @param   uint32_t address of first block
+   * @param   uint32_t address of last block
+   *
+   * @return  uint8_t
+   */
+  uint8_t SD_Erase (uint32_t, uint32_t);
+
   /**
    * @brief   SD Card Power Up Sequence
    *
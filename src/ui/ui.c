@@ -20,6 +20,7 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "ui.h"
 #include "../fat32/fat32.h"
 #include "../lcd/ssd1306.h"
@@ -87,16 +88,50 @@ uint8_t UI_Init(FAT32_t *FAT32)
  */
 void UI_Show_Song(FAT32_t *FAT32, uint8_t songid, UI_Files_t *UI_Files)
 {
-  DE_t * File = FAT32_Get_File_Info(FAT32, (uint32_t) songid);
+  char name[UI_NAME_LENGTH + 1];
+  uint8_t i;
+  uint16_t filenum;
+  uint16_t position;
+  FAT32_Index_t Entry;
+  FAT32_Name_t Name;
+  FAT32_Dir_t Dir;
 
   uint8_t x = 36;
   uint8_t y = 6;
 
-  uint8_t to = 8;
-
-  while (to--){
-    if (' ' != File->Name[to]){
-      break;
+  name[0] = 0;
+  if (UI_Files->Sort != FAT32_SORT_NONE) {
+    // Song of sorted view - from first song on page if before it
+    // --------------------------------------------------------------
+    filenum = 0;
+    position = 0;
+    i = 0;
+    if (UI_Files->View_song < songid) {
+      position = UI_Files->View_position;
+      i = UI_Files->View_song;
+    }
+    for (; i < songid; i++) {
+      if (0 == (filenum = FAT32_Sorted_Next(FAT32, UI_Files->Sort, &position))) {
+        break;
+      }
+    }
+    if ((filenum == 0) || (FAT32_ERROR == FAT32_Get_Name(FAT32, filenum, (uint8_t *) name, sizeof(name)))) {
+      name[0] = 0;
+    }
+  } else {
+    // Song of directory order - from first song on page if before it
+    // --------------------------------------------------------------
+    if ((UI_Files->Dir.first_cluster != 0) && (UI_Files->Dir.index < songid)) {
+      Dir = UI_Files->Dir;
+    } else {
+      FAT32_Dir_Open(FAT32, &Dir, 0);
+      Dir.filter = 1;
+    }
+    FAT32_Name_Init(&Name, (uint8_t *) name, sizeof(name));
+    while ((Dir.index < songid) &&
+           (FAT32_SUCCESS == FAT32_Dir_Next(FAT32, &Dir, &Entry, ((Dir.index + 1) == songid) ? &Name : NULL)));
+    if (Dir.index != songid) {
+      name[0] = 0;
     }
   }
   // Print title
@@ -106,8 +141,8 @@ void UI_Show_Song(FAT32_t *FAT32, uint8_t songid, UI_Files_t *UI_Files)
   // Print time
   // ----------------------------------------------------------------
   UI_Clear_Pages(3, 6, UI_FRAME_MARGIN);
-  UI_Set_Position(((128-(to+1)*6) >> 1)-12, 4);
-  UI_Print_File_Name((char *) File->Name, (char *) File->Extension, NORMAL);
+  UI_Set_Position((128-strlen(name)*6) >> 1, 4);
+  UI_Print_String(name, NORMAL);
   UI_Print_to_XY(x, y, "00:00", BOLD);
 }
 
@@ -205,8 +240,11 @@ void UI_Print_Title(char *title)
  */
 void UI_Print_Songs(FAT32_t *FAT32, uint8_t current, UI_Files_t *UI_files)
 {
-  DE_t * file;
   char str[4];
+  char name[UI_NAME_LENGTH + 1];
+  uint16_t position;
+  FAT32_Index_t Entry;
+  FAT32_Name_t Name;
 
   uint8_t row = 3;
   uint8_t page = (current - 1) / UI_files->Group;
@@ -228,15 +266,54 @@ void UI_Print_Songs(FAT32_t *FAT32, uint8_t current, UI_Files_t *UI_files)
   UI_Print_String(str, NORMAL);
   UI_Print_Char(']', NORMAL);
 
+  // Sorted view - one read per position, built once per index
+  // ----------------------------------------------------------------
+  if ((UI_files->Sort != FAT32_SORT_NONE) && (FAT32_ERROR == FAT32_Sort(FAT32, UI_files->Sort))) {
+    UI_files->Sort = FAT32_SORT_NONE;                     // no index file, directory order
+  }
+
+  // View or directory position of page
+  // ----------------------------------------------------------------
+  if (UI_files->Sort != FAT32_SORT_NONE) {
+    if (UI_files->View_song > (start - 1)) {
+      UI_files->View_song = 0;                            // page before current one, count from start
+      UI_files->View_position = 0;
+    }
+    while ((UI_files->View_song < (start - 1)) &&         // playable files only, same as UI_Get_Mp3Files
+           (0 != FAT32_Sorted_Next(FAT32, UI_files->Sort, &UI_files->View_position))) {
+      UI_files->View_song++;
+    }
+    position = UI_files->View_position;
+  } else {
+    if ((UI_files->Next.first_cluster != 0) && (UI_files->Next.index == (start - 1))) {
+      UI_files->Dir = UI_files->Next;                     // next page continues where last ended
+    } else if ((UI_files->Dir.first_cluster == 0) || (UI_files->Dir.index != (start - 1))) {
+      FAT32_Dir_Open(FAT32, &UI_files->Dir, 0);
+      UI_files->Dir.filter = 1;                           // playable files only, same as UI_Get_Mp3Files
+      while ((UI_files->Dir.index < (start - 1)) &&
+             (FAT32_SUCCESS == FAT32_Dir_Next(FAT32, &UI_files->Dir, &Entry, NULL)));
+    }
+    UI_files->Next = UI_files->Dir;
+  }
+
   for (uint8_t i = start; i < end; i++) {
+    if (UI_files->Sort != FAT32_SORT_NONE) {
+      if (FAT32_ERROR == FAT32_Get_Name(FAT32, FAT32_Sorted_Next(FAT32, UI_files->Sort, &position), (uint8_t *) name, sizeof(name))) {
+        break;
+      }
+    } else {
+      FAT32_Name_Init(&Name, (uint8_t *) name, sizeof(name));
+      if (FAT32_ERROR == FAT32_Dir_Next(FAT32, &UI_files->Next, &Entry, &Name)) {
+        break;
+      }
+    }
     UI_Set_Position(UI_FRAME_MARGIN, row++);    
     if (i == current) {
       UI_Print_Char('>', NORMAL);
     } else {
       UI_Print_Char(' ', NORMAL);
     }
-    file = FAT32_Get_File_Info(FAT32, i);
-    UI_Print_File_Name((char *) file->Name, (char *) file->Extension, NORMAL);
+    UI_Print_String(name, NORMAL);
   }
 }
 
@@ -303,4 +380,38 @@ void UI_Print_Error(uint8_t errorcode)
 void UI_Draw_Line_Horizontal(uint8_t x, uint8_t y, uint8_t width, enum E_Line line)
 {
   SSD1306_DrawLineHorizontal(x, y, width, line);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief   Mp3 LCD Get Number Of MP3 Files
+ * @note    one pass over root directory or sorted view, same filter as listing
+ *          (FAT32_FILTER_EXTENSIONS, no folders, hidden or system files)
+ *
+ * @param   FAT32_t * FAT32
+ * @param   UI_Files_t * UI_files struct, Sort dropped if view unavailable
+ *
+ * @return  uint8_t number of files, at most 255
+ */
+uint8_t UI_Get_Mp3Files(FAT32_t *FAT32, UI_Files_t *UI_files)
+{
+  uint8_t count = 0;
+  uint16_t position = 0;
+  FAT32_Index_t Entry;
+  FAT32_Dir_t Dir;
+
+  if ((UI_files->Sort != FAT32_SORT_NONE) && (FAT32_ERROR == FAT32_Sort(FAT32, UI_files->Sort))) {
+    UI_files->Sort = FAT32_SORT_NONE;                     // no index file, directory order
+  }
+  if (UI_files->Sort != FAT32_SORT_NONE) {
+    while ((count < 0xFF) && (0 != FAT32_Sorted_Next(FAT32, UI_files->Sort, &position))) {
+      count++;
+    }
+    return count;
+  }
+
+  FAT32_Dir_Open(FAT32, &Dir, 0);
+  Dir.filter = 1;
+  while ((Dir.index < 0xFF) && (FAT32_SUCCESS == FAT32_Dir_Next(FAT32, &Dir, &Entry, NULL)));
+
+  return Dir.index;
+}
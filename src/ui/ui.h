@@ -33,6 +33,7 @@
   #define UI_SUCCESS             0x00
 
   #define UI_FRAME_MARGIN    3
+  #define UI_NAME_LENGTH     19                           // characters of file name fitting one row
 
   // Files
   // --------------------------------------------------------------------------------------
@@ -43,6 +44,11 @@
     uint8_t Count;
     uint8_t Group;
     uint8_t Pages;
+    uint8_t Sort;                                         // FAT32_SORT_*, positions of sorted view if index file allows
+    uint8_t View_song;                                    // songs before first song on page, sorted view
+    uint16_t View_position;                               // view position of first song on page
+    FAT32_Dir_t Dir;                                      // directory position of first song on page
+    FAT32_Dir_t Next;                                     // directory position after last song on page
   } UI_Files_t;
 
 
@@ -204,11 +210,14 @@
 
   /**
    * @brief   Mp3 LCD Get Number Of MP3 Files
+   * @note    one pass over root directory or sorted view, same filter
+   *          as listing
    *
    * @param   FAT32_t * FAT32
+   * @param   UI_Files_t * UI_files struct, Sort dropped if view unavailable
    *
-   * @return  uint8_t
+   * @return  uint8_t number of files, at most 255
    */
-  uint8_t UI_Get_Mp3Files(FAT32_t * FAT32);
+  uint8_t UI_Get_Mp3Files(FAT32_t * FAT32, UI_Files_t *);
 
 #endif